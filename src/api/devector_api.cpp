@@ -0,0 +1,141 @@
+#include <new>
+#include <memory>
+#include <exception>
+
+#include "api/devector_api.h"
+#include "core/hardware.h"
+#include "core/loader.h"
+#include "utils/utils.h"
+#include "utils/str_utils.h"
+
+struct devector_t
+{
+	dev::Hardware hardware;
+
+	// no ramdisk file, the instances must not share it
+	devector_t(const std::string& _bootPath)
+		: hardware(_bootPath, "", true, false)
+	{}
+};
+
+static_assert(DEVECTOR_FRAME_W == dev::Display::FRAME_W && DEVECTOR_FRAME_H == dev::Display::FRAME_H);
+static_assert(DEVECTOR_KEY_ROWS == dev::Keyboard::ROWS);
+
+devector_t* devector_create(const char* _bootPath)
+{
+	if (!_bootPath) return nullptr;
+
+	// the Memory silently keeps an empty rom when the boot data is missing
+	auto bootData = dev::LoadFile(dev::GetExecutableDir() + _bootPath);
+	if (!bootData || bootData->empty()) {
+		dev::Log("Failed to load the boot rom: {}", _bootPath);
+		return nullptr;
+	}
+
+	// no exception may cross the C boundary
+	try {
+		return new devector_t(_bootPath);
+	}
+	catch (const std::exception& _e) {
+		dev::Log("Failed to create an instance: {}", _e.what());
+	}
+	catch (...) {}
+
+	return nullptr;
+}
+
+void devector_destroy(devector_t* _devP)
+{
+	delete _devP;
+}
+
+int devector_load(devector_t* _devP, const char* _path)
+{
+	if (!_devP || !_path) return -1;
+
+	// the recordings require the debugger
+	auto ext = dev::StrToUpper(dev::GetExt(_path));
+	if (ext != ".ROM" && ext != ".FDD") {
+		dev::Log("Unsupported file type: {}", _path);
+		return -1;
+	}
+
+	return dev::LoadRomFddRec(_devP->hardware, _path) ? 0 : -1;
+}
+
+void devector_set_keys(devector_t* _devP, const uint8_t _matrix[DEVECTOR_KEY_ROWS], const uint8_t _modifiers)
+{
+	_devP->hardware.SetKeys(_matrix,
+		_modifiers & DEVECTOR_KEY_SS, _modifiers & DEVECTOR_KEY_US, _modifiers & DEVECTOR_KEY_RUS);
+}
+
+uint64_t devector_step_frames(devector_t* _devP, const uint32_t _frames)
+{
+	_devP->hardware.ExecuteFrames(_frames);
+	return _devP->hardware.GetFrameNum();
+}
+
+size_t devector_get_frame(devector_t* _devP, void* _dstP, const size_t _dstLen,
+	const int _downscale, const int _indexed)
+{
+	int downscale = dev::Max(_downscale, 1);
+	int w = DEVECTOR_FRAME_W / downscale;
+	int h = DEVECTOR_FRAME_H / downscale;
+	size_t len = size_t(w) * h * (_indexed ? 1 : sizeof(dev::ColorI));
+	if (!_dstP || _dstLen < len) return len;
+
+	auto& frame = *_devP->hardware.GetBackBuffer();
+
+	if (_indexed)
+	{
+		auto dstP = static_cast<uint8_t*>(_dstP);
+		for (int y = 0; y < h; y++)
+		{
+			auto lineP = frame.data() + y * downscale * DEVECTOR_FRAME_W;
+			for (int x = 0; x < w; x++)
+			{
+				// the inverse of Display::VectorColorToArgb
+				dev::ColorI color = lineP[x * downscale];
+				*dstP++ = static_cast<uint8_t>(
+					(color >> 5 & 0x07) | (color >> 13 & 0x07) << 3 | (color >> 22 & 0x03) << 6);
+			}
+		}
+	}
+	else
+	{
+		auto dstP = static_cast<dev::ColorI*>(_dstP);
+		for (int y = 0; y < h; y++)
+		{
+			auto lineP = frame.data() + y * downscale * DEVECTOR_FRAME_W;
+			for (int x = 0; x < w; x++)
+			{
+				*dstP++ = lineP[x * downscale];
+			}
+		}
+	}
+
+	return len;
+}
+
+const uint8_t* devector_get_ram(devector_t* _devP, size_t* _lenP)
+{
+	auto ramP = _devP->hardware.GetRam();
+	if (_lenP) *_lenP = ramP->size();
+	return ramP->data();
+}
+
+size_t devector_state_size(void)
+{
+	return sizeof(dev::Hardware::MachineState);
+}
+
+void devector_clone_state(devector_t* _devP, void* _dstP)
+{
+	auto stateP = new (_dstP) dev::Hardware::MachineState;
+	_devP->hardware.StoreState(*stateP);
+}
+
+void devector_restore_state(devector_t* _devP, const void* _srcP)
+{
+	_devP->hardware.RestoreState(*static_cast<const dev::Hardware::MachineState*>(_srcP));
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+// The embeddable C API of the emulator.
+// Every call is synchronous and runs on the caller thread. There is no execution thread,
+// no request queue, and no locking inside, so an instance must be used by one thread at a time.
+// Different instances can run in parallel.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+	#if defined(DEVECTOR_API_EXPORTS)
+		#define DEVECTOR_API __declspec(dllexport)
+	#else
+		#define DEVECTOR_API __declspec(dllimport)
+	#endif
+#else
+	#define DEVECTOR_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct devector_t devector_t;
+
+#define DEVECTOR_FRAME_W 768
+#define DEVECTOR_FRAME_H 312
+#define DEVECTOR_KEY_ROWS 8
+
+// the modifier keys of devector_set_keys
+#define DEVECTOR_KEY_SS 1	// shift
+#define DEVECTOR_KEY_US 2	// ctrl
+#define DEVECTOR_KEY_RUS 4	// rus/lat
+
+// _bootPath is relative to the executable dir. Returns NULL if the boot rom can not be loaded
+// or the instance can not be created
+DEVECTOR_API devector_t* devector_create(const char* _bootPath);
+DEVECTOR_API void devector_destroy(devector_t* _devP);
+
+// resets the machine and loads a .rom or an .fdd. Returns 0 on success
+DEVECTOR_API int devector_load(devector_t* _devP, const char* _path);
+
+// sets the pressed keys. A set bit in _matrix[row] is a pressed key,
+// the matrix layout is described in Keyboard::InitMapping. _modifiers is a DEVECTOR_KEY_* mask
+DEVECTOR_API void devector_set_keys(devector_t* _devP, const uint8_t _matrix[DEVECTOR_KEY_ROWS], const uint8_t _modifiers);
+
+// executes _frames frames. Returns the frame counter
+DEVECTOR_API uint64_t devector_step_frames(devector_t* _devP, const uint32_t _frames);
+
+// copies the last completed frame into _dstP. It takes every _downscale pixel in both directions.
+// _indexed = 0: a 32-bit ABGR pixel. _indexed != 0: a byte per pixel in the Vector06c color format BBGGGRRR.
+// Returns the amount of bytes required, nothing is copied if _dstP is NULL or _dstLen is too small
+DEVECTOR_API size_t devector_get_frame(devector_t* _devP, void* _dstP, const size_t _dstLen,
+	const int _downscale, const int _indexed);
+
+// the global memory: the main ram followed by the ram-disks
+DEVECTOR_API const uint8_t* devector_get_ram(devector_t* _devP, size_t* _lenP);
+
+// the machine state is a flat blob of devector_state_size() bytes aligned to 8 bytes (malloc does it).
+// A blob can be copied with memcpy and restored into any instance. The fdd images are not a part of it
+DEVECTOR_API size_t devector_state_size(void);
+DEVECTOR_API void devector_clone_state(devector_t* _devP, void* _dstP);
+DEVECTOR_API void devector_restore_state(devector_t* _devP, const void* _srcP);
+
+#ifdef __cplusplus
+}
+#endif
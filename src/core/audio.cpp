@@ -4,25 +4,11 @@
 
 dev::Audio::Audio(TimerI8253& _timer, AYWrapper& _aywrapper) :
 	m_timer(_timer), m_aywrapper(_aywrapper)
-{
-	Init();
-}
-
-dev::Audio::~Audio()
-{
-	Pause(true);
-	SDL_DestroyAudioStream(m_stream);
-}
+{}
 
 void dev::Audio::Pause(bool _pause)
 {
-	if (_pause)
-	{
-		SDL_PauseAudioDevice(m_audioDevice);
-	}
-	else {
-		SDL_ResumeAudioDevice(m_audioDevice);
-	}
+	m_sinkP->Pause(_pause);
 }
 
 void dev::Audio::Mute(const bool _mute) { m_muteMul = _mute ? 0.0f : 1.0f; }
@@ -31,41 +17,33 @@ void dev::Audio::Reset()
 {
 	m_aywrapper.Reset();
 	m_timer.Reset();
-	m_buffer.fill(0);
-	m_lastSample = m_readBuffIdx = m_writeBuffIdx = 0;
+	m_sinkP->Reset();
 	m_muteMul = 1.0f;
+	m_sampleCounter = 0;
+	m_accumulator = 0;
 }
 
-void dev::Audio::Init()
+// Hardware thread
+// nullptr detaches the sink, the audio isn't mixed then
+void dev::Audio::SetSink(AudioSink* _sinkP)
 {
-	const SDL_AudioSpec spec = { SDL_AUDIO_F32, 1, 50000 };
-
-	SDL_Init(SDL_INIT_AUDIO);
-
-	if (!(SDL_WasInit(SDL_INIT_AUDIO) & SDL_INIT_AUDIO)) {
-		dev::Log("SDL audio error: SDL_INIT_AUDIO not initialized\n");
-		return;
-	}
-
-	m_stream = SDL_OpenAudioDeviceStream(SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK, &spec, Callback, this);
-	if (m_stream == NULL) {
-		dev::Log("SDL_OpenAudioDeviceStream: the stream failed to create: {}\n", SDL_GetError());
-	}
-
-	m_audioDevice = SDL_GetAudioStreamDevice(m_stream);
-	if (!m_audioDevice) {
-		dev::Log("SDL_GetAudioStreamDevice: the device failed to create: {}\n", SDL_GetError());
-	}
-	SDL_ResumeAudioDevice(m_audioDevice);
-
-	m_inited = true;
+	m_sinkP = _sinkP ? _sinkP : &m_nullSink;
 }
 
 // _cycles are ticks of the 1.5 Mhz timer.
 // Hardware thread
 void dev::Audio::Clock(int _cycles, const float _beeper)
 {
-	if (!m_inited) return;
+	// the timer counters are visible to the cpu, and the ay envelope and noise are in the machine state,
+	// so they are clocked anyway. Only the mixing and the resampling are skipped
+	if (!m_captureP && !m_sinkP->IsConsuming())
+	{
+		for (int tick = 0; tick < _cycles; ++tick) {
+			m_timer.Clock(1);
+			m_aywrapper.Clock(2);
+		}
+		return;
+	}
 
 	//covox = covox - 255;
 
@@ -75,81 +53,39 @@ void dev::Audio::Clock(int _cycles, const float _beeper)
 
 		if (Downsample(sample))
 		{
-			m_buffer[(m_writeBuffIdx++) % BUFFER_SIZE] = sample;
-			m_lastSample = sample;
+			if (m_captureP) {
+				m_captureP->push_back(sample);
+				continue;
+			}
+			m_sinkP->Push(sample);
 		}
 	}
 }
 
 
+// Hardware thread
+// redirects the samples to the _captureP bypassing the sink.
+// nullptr restores the sink
+void dev::Audio::Capture(std::vector<float>* _captureP)
+{
+	m_captureP = _captureP;
+}
+
 // resamples to a lower rate using a linear interpolation.
 // returns true if the output sample is ready, false otherwise
 bool dev::Audio::Downsample(float& _sample)
 {
-	static int sampleCounter = 0;
-	static float accumulator = 0;
-	accumulator += _sample;
+	m_accumulator += _sample;
 
-	if (++sampleCounter > m_downsampleRate)
+	if (++m_sampleCounter >= m_downsampleRate)
 	{
-		_sample = accumulator / m_downsampleRate;
-		sampleCounter = 0;
-		accumulator = 0;
+		_sample = m_accumulator / m_downsampleRate;
+		m_sampleCounter = 0;
+		m_accumulator = 0;
+		// the sink adjusts the rate to its consumption, the capture has to be exact
+		m_downsampleRate = DOWNSAMPLE_RATE + (m_captureP ? 0 : m_sinkP->GetRateAdjustment());
 		return true;
 	}
 
 	return false;
 }
-
-// feeds the SDL3 playback buffer.
-void dev::Audio::Callback(void* _userdata, SDL_AudioStream* _stream, int _additionalAmount, int _totalAmount)
-{
-	if (_additionalAmount <= 0) return;
-
-	Audio* audioP = (Audio*)_userdata;
-	if (!audioP->m_inited) return;
-
-	// malloc the SDL buff
-	Uint8* data = SDL_stack_alloc(Uint8, _additionalAmount);
-	if (!data) return;
-
-	// convert the plain data to SDL_AUDIO_F32 buff;
-	float* fstream = (float*)data;
-	int fstreamLen = _additionalAmount / sizeof(float);
-
-	
-	int buffering = audioP->m_writeBuffIdx - audioP->m_readBuffIdx;
-	bool underBuferring = buffering < LOW_BUFFERING;
-	bool overBuferring = buffering > HIGH_BUFFERING;
-
-	if (underBuferring)
-	{
-		// fill in with the lastSample when it's low buffering
-		auto lastSample = audioP->m_lastSample.load();
-		std::fill(fstream, fstream + fstreamLen, lastSample);
-
-		// adjust the resample rate
-		int downsampleRate = --audioP->m_downsampleRate;
-		dev::Log("SDL buffering is too low: {}. Sample rate is adjusted: {}", buffering, downsampleRate);
-	}
-	else
-	{
-		// copy the samples
-		for (int i = 0; i < fstreamLen; i++)
-		{
-			fstream[i] = audioP->m_buffer[(audioP->m_readBuffIdx++) % BUFFER_SIZE];
-		}
-
-		if (overBuferring)
-		{
-			audioP->m_readBuffIdx += fstreamLen;
-			// adjust the resample rate			
-			int downsampleRate = ++audioP->m_downsampleRate;
-			dev::Log("SDL buffering is too big: {}. Sample rate is adjusted: {}", buffering, downsampleRate);
-		}
-	}
-
-	// memcopy the SDL buff
-	SDL_PutAudioStreamData(_stream, data, _additionalAmount);
-	SDL_stack_free(data);
-}
@@ -0,0 +1,118 @@
+#include "core/audio_sdl.h"
+#include <algorithm>
+#include "utils/utils.h"
+
+dev::SdlAudioSink::SdlAudioSink()
+{
+	m_buffer.fill(0);
+
+	const SDL_AudioSpec spec = { SDL_AUDIO_F32, 1, Audio::OUTPUT_RATE };
+
+	SDL_Init(SDL_INIT_AUDIO);
+
+	if (!(SDL_WasInit(SDL_INIT_AUDIO) & SDL_INIT_AUDIO)) {
+		dev::Log("SDL audio error: SDL_INIT_AUDIO not initialized\n");
+		return;
+	}
+
+	m_stream = SDL_OpenAudioDeviceStream(SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK, &spec, Callback, this);
+	if (m_stream == NULL) {
+		dev::Log("SDL_OpenAudioDeviceStream: the stream failed to create: {}\n", SDL_GetError());
+		return;
+	}
+
+	m_audioDevice = SDL_GetAudioStreamDevice(m_stream);
+	if (!m_audioDevice) {
+		dev::Log("SDL_GetAudioStreamDevice: the device failed to create: {}\n", SDL_GetError());
+		return;
+	}
+	SDL_ResumeAudioDevice(m_audioDevice);
+
+	m_inited = true;
+}
+
+dev::SdlAudioSink::~SdlAudioSink()
+{
+	Pause(true);
+	m_inited = false;
+	SDL_DestroyAudioStream(m_stream);
+}
+
+// Hardware thread
+void dev::SdlAudioSink::Push(const float _sample)
+{
+	m_buffer[(m_writeBuffIdx++) % BUFFER_SIZE] = _sample;
+	m_lastSample = _sample;
+}
+
+void dev::SdlAudioSink::Pause(const bool _pause)
+{
+	if (!m_audioDevice) return;
+
+	if (_pause)
+	{
+		SDL_PauseAudioDevice(m_audioDevice);
+	}
+	else {
+		SDL_ResumeAudioDevice(m_audioDevice);
+	}
+}
+
+void dev::SdlAudioSink::Reset()
+{
+	m_buffer.fill(0);
+	m_lastSample = m_readBuffIdx = m_writeBuffIdx = 0;
+}
+
+// feeds the SDL3 playback buffer.
+void dev::SdlAudioSink::Callback(void* _userdata, SDL_AudioStream* _stream, int _additionalAmount, int _totalAmount)
+{
+	if (_additionalAmount <= 0) return;
+
+	SdlAudioSink* sinkP = (SdlAudioSink*)_userdata;
+	if (!sinkP->m_inited) return;
+
+	// malloc the SDL buff
+	Uint8* data = SDL_stack_alloc(Uint8, _additionalAmount);
+	if (!data) return;
+
+	// convert the plain data to SDL_AUDIO_F32 buff;
+	float* fstream = (float*)data;
+	int fstreamLen = _additionalAmount / sizeof(float);
+
+	
+	int buffering = sinkP->m_writeBuffIdx - sinkP->m_readBuffIdx;
+	bool underBuferring = buffering < LOW_BUFFERING;
+	bool overBuferring = buffering > HIGH_BUFFERING;
+
+	if (underBuferring)
+	{
+		// fill in with the lastSample when it's low buffering
+		auto lastSample = sinkP->m_lastSample.load();
+		std::fill(fstream, fstream + fstreamLen, lastSample);
+
+		// adjust the resample rate
+		int rateAdjustment = --sinkP->m_rateAdjustment;
+		dev::Log("SDL buffering is too low: {}. Sample rate is adjusted: {}", buffering, rateAdjustment);
+	}
+	else
+	{
+		// copy the samples
+		for (int i = 0; i < fstreamLen; i++)
+		{
+			fstream[i] = sinkP->m_buffer[(sinkP->m_readBuffIdx++) % BUFFER_SIZE];
+		}
+
+		if (overBuferring)
+		{
+			sinkP->m_readBuffIdx += fstreamLen;
+			// adjust the resample rate			
+			int rateAdjustment = ++sinkP->m_rateAdjustment;
+			dev::Log("SDL buffering is too big: {}. Sample rate is adjusted: {}", buffering, rateAdjustment);
+		}
+	}
+
+	// memcopy the SDL buff
+	SDL_PutAudioStreamData(_stream, data, _additionalAmount);
+	SDL_stack_free(data);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <atomic>
+#include <array>
+
+#include "core/audio.h"
+#include "core/audio_sink.h"
+#include "SDL3/SDL.h"
+
+namespace dev
+{
+	// plays the samples back via SDL3. It isn't a part of the devector_core library
+	class SdlAudioSink : public AudioSink
+	{
+		static constexpr int CALLBACKS_PER_SEC = 100; // arbitrary number found while examining the SDL3 callback calls
+		static constexpr int SDL_BUFFER = Audio::OUTPUT_RATE / CALLBACKS_PER_SEC; // the estimated SDL stream buff len
+		static constexpr int SDL_BUFFERS = 8; // to make sure there is enough available data for audio streaming
+		static constexpr int BUFFER_SIZE = SDL_BUFFER * SDL_BUFFERS;
+		static constexpr int TARGET_BUFFERING = SDL_BUFFER * 4;
+		static constexpr int LOW_BUFFERING = TARGET_BUFFERING - SDL_BUFFER * 2;
+		static constexpr int HIGH_BUFFERING = TARGET_BUFFERING + SDL_BUFFER * 2;
+
+		SDL_AudioDeviceID m_audioDevice = 0;
+		SDL_AudioStream* m_stream = nullptr;
+
+		std::array<float, BUFFER_SIZE> m_buffer; // Audio system writes to it, SDL reads from it
+		std::atomic_uint64_t m_readBuffIdx = 0; // the last sample played by SDL
+		std::atomic_uint64_t m_writeBuffIdx = 0; // the last sample stored by the Audio system
+		std::atomic<float> m_lastSample = 0.0f;
+		std::atomic_int m_rateAdjustment = 0;
+
+		std::atomic_bool m_inited = false;
+
+		static void Callback(void* _userdata, SDL_AudioStream* _stream, int _additionalAmount, int _totalAmount);
+
+	public:
+		SdlAudioSink();
+		~SdlAudioSink();
+		bool IsInited() const { return m_inited; }
+
+		bool IsConsuming() const override { return m_inited; }
+		void Push(const float _sample) override;
+		void Pause(const bool _pause) override;
+		void Reset() override;
+		int GetRateAdjustment() const override { return m_rateAdjustment; }
+	};
+}
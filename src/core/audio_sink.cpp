@@ -0,0 +1,49 @@
+#include "core/audio_sink.h"
+#include "utils/utils.h"
+
+void dev::RingAudioSink::Reset()
+{
+	std::fill(m_buffer.begin(), m_buffer.end(), 0.0f);
+	m_writeIdx = 0;
+}
+
+// the samples are ordered from the oldest to the newest
+auto dev::RingAudioSink::GetLast(const size_t _len) const
+-> std::vector<float>
+{
+	size_t len = dev::Min(_len, dev::Min(m_buffer.size(), m_writeIdx));
+	std::vector<float> out(len);
+	uint64_t readIdx = m_writeIdx - len;
+	for (size_t i = 0; i < len; i++)
+	{
+		out[i] = m_buffer[(readIdx + i) % m_buffer.size()];
+	}
+	return out;
+}
+
+dev::WavAudioSink::WavAudioSink(const std::string& _path, const int _rate)
+	: m_rate(_rate)
+{
+	m_file.open(_path, std::ios::binary | std::ios::trunc);
+	if (!m_file) {
+		dev::Log("WavAudioSink: failed to create the file: {}", _path);
+		return;
+	}
+	dev::WriteWavHeader(m_file, 0, m_rate); // reserves the space, the sizes are updated in the destructor
+}
+
+dev::WavAudioSink::~WavAudioSink()
+{
+	if (!m_file.is_open()) return;
+
+	dev::WriteWavHeader(m_file, m_samples, m_rate);
+	m_file.close();
+}
+
+void dev::WavAudioSink::Push(const float _sample)
+{
+	if (!m_file.is_open()) return;
+
+	m_file.write(reinterpret_cast<const char*>(&_sample), sizeof(_sample));
+	m_samples++;
+}
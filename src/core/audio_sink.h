@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <ostream>
+
+namespace dev
+{
+	// receives the downsampled audio from the Hardware thread
+	class AudioSink
+	{
+	public:
+		virtual ~AudioSink() = default;
+
+		// false means nobody listens, so the Audio skips the mixing and the resampling
+		virtual bool IsConsuming() const { return true; }
+		// Hardware thread
+		virtual void Push(const float _sample) = 0;
+		virtual void Pause(const bool) {}
+		virtual void Reset() {}
+		// the correction of the downsample rate the sink requests to keep up with its consumer
+		virtual int GetRateAdjustment() const { return 0; }
+	};
+
+	// discards the samples. The audio isn't mixed at all
+	class NullAudioSink : public AudioSink
+	{
+	public:
+		bool IsConsuming() const override { return false; }
+		void Push(const float) override {}
+	};
+
+	// keeps the last samples. Used to inspect the output
+	class RingAudioSink : public AudioSink
+	{
+		std::vector<float> m_buffer;
+		uint64_t m_writeIdx = 0; // the total amount of the pushed samples
+
+	public:
+		RingAudioSink(const size_t _len) : m_buffer(_len, 0.0f) {}
+		void Push(const float _sample) override { m_buffer[m_writeIdx++ % m_buffer.size()] = _sample; }
+		void Reset() override;
+
+		auto GetPushed() const -> uint64_t { return m_writeIdx; }
+		auto GetLast(const size_t _len) const -> std::vector<float>;
+	};
+
+	// writes a 32-bit float mono WAV file
+	class WavAudioSink : public AudioSink
+	{
+		std::ofstream m_file;
+		uint64_t m_samples = 0;
+		int m_rate;
+
+	public:
+		WavAudioSink(const std::string& _path, const int _rate);
+		~WavAudioSink();
+		void Push(const float _sample) override;
+		bool IsInited() const { return m_file.is_open(); }
+	};
+}
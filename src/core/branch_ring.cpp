@@ -0,0 +1,52 @@
+#include <format>
+
+#include "core/branch_ring.h"
+#include "core/disasm.h"
+
+// Hardware thread
+void dev::BranchRing::Add(const Addr _pc, const bool _inte, const CpuI8080::State& _cpuState)
+{
+	uint8_t opcode = _cpuState.regs.ir;
+	// HLT loops at its addr
+	if (opcode == CpuI8080::OPCODE_HLT) return;
+
+	Addr pc = _cpuState.regs.pc.word;
+	// the interrupt executes RST7 and disables the interrupts
+	bool irq = opcode == CpuI8080::OPCODE_RST7 && _inte && !_cpuState.ints.inte;
+
+	if (m_idx)
+	{
+		auto& last = m_branches[(m_idx - 1) & MASK];
+		if (last.from == _pc && last.to == pc && last.opcode == opcode && last.irq == irq)
+		{
+			last.cc = _cpuState.cc;
+			last.repeats++;
+			return;
+		}
+	}
+	m_branches[m_idx++ & MASK] = { _cpuState.cc, _pc, pc, opcode, irq };
+}
+
+auto dev::BranchRing::Get() const
+-> std::vector<Branch>
+{
+	size_t len = m_idx < LEN ? m_idx : LEN;
+	std::vector<Branch> out;
+	out.reserve(len);
+	for (size_t i = m_idx - len; i < m_idx; i++) out.push_back(m_branches[i & MASK]);
+	return out;
+}
+
+auto dev::BranchRing::ToString() const
+-> std::string
+{
+	std::string out;
+	for (const auto& branch : Get())
+	{
+		const char* mnemonic = branch.irq ? "interrupt" : GetMnemonic(branch.opcode)[0];
+		out += std::format("{} 0x{:04X} -> 0x{:04X} {}", branch.cc, branch.from, branch.to, mnemonic);
+		if (branch.repeats > 1) out += std::format(" x{}", branch.repeats);
+		out += "\n";
+	}
+	return out;
+}
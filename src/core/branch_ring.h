@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <array>
+#include <string>
+#include <vector>
+
+#include "utils/types.h"
+#include "core/cpu_i8080.h"
+
+namespace dev
+{
+	// The last taken branches: the jumps, calls, returns, rsts, pchl, and the interrupt entries.
+	// An instruction that doesn't continue to the next one is a branch, so the not taken conditional
+	// branches aren't stored. The repeats of the same branch in a loop take one entry.
+	// It's checked for every instruction with the debugger detached too,
+	// so it is there after a crash that took hours of play to reach
+	class BranchRing
+	{
+	public:
+		static constexpr size_t LEN = 256; // has to be a power of two
+
+		struct Branch
+		{
+			uint64_t cc = 0; // after the last repeat
+			Addr from = 0; // the branch instruction, or the interrupted one
+			Addr to = 0;
+			uint8_t opcode = 0;
+			bool irq = false;
+			uint32_t repeats = 1;
+		};
+
+		// Hardware thread. Called after every instruction with the pc and the interrupt enable before it,
+		// and the fetched instruction len
+		inline void Update(const Addr _pc, const bool _inte, const uint8_t _instrLen, const CpuI8080::State& _cpuState)
+		{
+			if (_cpuState.regs.pc.word != Addr(_pc + _instrLen)) Add(_pc, _inte, _cpuState);
+		}
+		// the oldest first
+		auto Get() const -> std::vector<Branch>;
+		// a line per branch: "cc from -> to mnemonic"
+		auto ToString() const -> std::string;
+
+	private:
+		static constexpr size_t MASK = LEN - 1;
+
+		void Add(const Addr _pc, const bool _inte, const CpuI8080::State& _cpuState);
+
+		std::array<Branch, LEN> m_branches;
+		size_t m_idx = 0; // the next branch to write, it never wraps
+	};
+}
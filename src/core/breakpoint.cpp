@@ -3,23 +3,28 @@
 #include <sstream>
 #include <cstring>
 #include <vector>
+#include <array>
+#include <utility>
 
 #include "core/breakpoint.h"
 #include "utils/str_utils.h"
 #include "utils/utils.h"
 
-dev::Breakpoint::Breakpoint(Data&& _data, const std::string& _comment)
+dev::Breakpoint::Breakpoint(Data&& _data, const std::string& _comment, Trigger&& _trigger)
 	:
-	data(std::move(_data)), comment(_comment)
+	data(std::move(_data)), comment(_comment), trigger(std::move(_trigger))
 {
 	UpdateAddrMappingS();
+	Compile();
 }
 
 void dev::Breakpoint::Update(Breakpoint&& _bp)
 {
 	data = std::move(_bp.data);
 	comment = std::move(_bp.comment);
+	trigger = std::move(_bp.trigger);
 	UpdateAddrMappingS();
+	Compile();
 }
 
 auto dev::Breakpoint::GetOperandS() const ->const char* { return bpOperandsS[static_cast<uint8_t>(data.structured.operand)]; }
@@ -34,84 +39,90 @@ auto dev::Breakpoint::GetConditionS() const
 		condValS,
 		data.structured.autoDel ? ":A" : ""
 	);
+	auto triggerS = trigger.GetS();
+	if (!triggerS.empty()) out += " " + triggerS;
 	return out;
 }
 auto dev::Breakpoint::IsActiveS() const -> const char* { return data.structured.status == Status::ACTIVE ? "X" : "-"; }
 
+template <dev::Breakpoint::Operand _operand>
+static inline auto GetOperand(const dev::CpuI8080::State& _cpuState)
+-> uint64_t
+{
+	using Operand = dev::Breakpoint::Operand;
+
+	if constexpr (_operand == Operand::A) return _cpuState.regs.psw.a;
+	else if constexpr (_operand == Operand::F) return _cpuState.regs.psw.af.l;
+	else if constexpr (_operand == Operand::B) return _cpuState.regs.bc.h;
+	else if constexpr (_operand == Operand::C) return _cpuState.regs.bc.l;
+	else if constexpr (_operand == Operand::D) return _cpuState.regs.de.h;
+	else if constexpr (_operand == Operand::E) return _cpuState.regs.de.l;
+	else if constexpr (_operand == Operand::H) return _cpuState.regs.hl.h;
+	else if constexpr (_operand == Operand::L) return _cpuState.regs.hl.l;
+	else if constexpr (_operand == Operand::PSW) return _cpuState.regs.psw.af.word;
+	else if constexpr (_operand == Operand::BC) return _cpuState.regs.bc.word;
+	else if constexpr (_operand == Operand::DE) return _cpuState.regs.de.word;
+	else if constexpr (_operand == Operand::HL) return _cpuState.regs.hl.word;
+	else if constexpr (_operand == Operand::CC) return _cpuState.cc;
+	else if constexpr (_operand == Operand::SP) return _cpuState.regs.sp.word;
+	else return 0;
+}
+
+template <dev::Breakpoint::Operand _operand, dev::Condition _cond>
+static bool CheckOperand(const dev::CpuI8080::State& _cpuState, const uint64_t _value)
+{
+	using Condition = dev::Condition;
+
+	if constexpr (_cond == Condition::ANY) return true;
+	else if constexpr (_cond == Condition::EQU) return GetOperand<_operand>(_cpuState) == _value;
+	else if constexpr (_cond == Condition::LESS) return GetOperand<_operand>(_cpuState) < _value;
+	else if constexpr (_cond == Condition::GREATER) return GetOperand<_operand>(_cpuState) > _value;
+	else if constexpr (_cond == Condition::LESS_EQU) return GetOperand<_operand>(_cpuState) <= _value;
+	else if constexpr (_cond == Condition::GREATER_EQU) return GetOperand<_operand>(_cpuState) >= _value;
+	else if constexpr (_cond == Condition::NOT_EQU) return GetOperand<_operand>(_cpuState) != _value;
+	else return false;
+}
+
+static constexpr size_t OPERANDS_LEN = static_cast<size_t>(dev::Breakpoint::Operand::COUNT);
+static constexpr size_t CONDITIONS_LEN = static_cast<size_t>(dev::Condition::COUNT);
+
+// the predicates of all the operand and condition pairs. The idx is operand * CONDITIONS_LEN + cond
+template <size_t... _idxs>
+static constexpr auto MakePredicates(std::index_sequence<_idxs...>)
+-> std::array<dev::Breakpoint::Predicate, sizeof...(_idxs)>
+{
+	return { &CheckOperand<
+		static_cast<dev::Breakpoint::Operand>(_idxs / CONDITIONS_LEN),
+		static_cast<dev::Condition>(_idxs % CONDITIONS_LEN)>... };
+}
+static constexpr auto predicates = MakePredicates(std::make_index_sequence<OPERANDS_LEN * CONDITIONS_LEN>{});
+
+void dev::Breakpoint::Compile()
+{
+	size_t operand = static_cast<size_t>(data.structured.operand);
+	size_t cond = static_cast<size_t>(data.structured.cond);
+
+	predicate = operand < OPERANDS_LEN && cond < CONDITIONS_LEN ?
+		predicates[operand * CONDITIONS_LEN + cond] : predicates[static_cast<size_t>(Condition::INVALID)];
+}
+
 bool dev::Breakpoint::CheckStatus(const CpuI8080::State& _cpuState, const Memory::State& _memState) const
 {
-	auto mapping = _memState.update.mapping.data & Memory::MAPPING_RAM_MODE_MASK ? 1 << (_memState.update.mapping.pageRam + 1 + 4 * _memState.update.ramdiskIdx) : 1;
+	uint64_t mapping = _memState.update.mapping.data & Memory::MAPPING_RAM_MODE_MASK ? 
+		uint64_t(1) << (_memState.update.mapping.pageRam + 1 + 4 * _memState.update.ramdiskIdx) : 1;
 
 	bool active = data.structured.status == Status::ACTIVE && mapping & data.structured.memPages.data;
 	if (!active) return false;
-	if (data.structured.cond == dev::Condition::ANY) return true;
-	
-	uint64_t op;
-	switch (data.structured.operand)
-	{
-	case dev::Breakpoint::Operand::A:
-		op = _cpuState.regs.psw.a;
-		break;
-	case dev::Breakpoint::Operand::F:
-		op = _cpuState.regs.psw.af.l;
-		break;
-	case dev::Breakpoint::Operand::B:
-		op = _cpuState.regs.bc.h;
-		break;
-	case dev::Breakpoint::Operand::C:
-		op = _cpuState.regs.bc.l;
-		break;
-	case dev::Breakpoint::Operand::D:
-		op = _cpuState.regs.de.h;
-		break;
-	case dev::Breakpoint::Operand::E:
-		op = _cpuState.regs.de.l;
-		break;
-	case dev::Breakpoint::Operand::H:
-		op = _cpuState.regs.hl.h;
-		break;
-	case dev::Breakpoint::Operand::L:
-		op = _cpuState.regs.hl.l;
-		break;
-	case dev::Breakpoint::Operand::PSW:
-		op = _cpuState.regs.psw.af.word;
-		break;
-	case dev::Breakpoint::Operand::BC:
-		op = _cpuState.regs.bc.word;
-		break;
-	case dev::Breakpoint::Operand::DE:
-		op = _cpuState.regs.de.word;
-		break;
-	case dev::Breakpoint::Operand::HL:
-		op = _cpuState.regs.hl.word;
-		break;
-	case dev::Breakpoint::Operand::CC:
-		op = _cpuState.cc;
-		break;
-	case dev::Breakpoint::Operand::SP:
-		op = _cpuState.regs.sp.word;
-		break;
-	default:
-		op = 0;
-		break;
-	}
-
-	switch (data.structured.cond)
-	{
-	case dev::Condition::EQU:
-		return op == data.structured.value;
-	case dev::Condition::LESS:
-		return op < data.structured.value;
-	case dev::Condition::GREATER:
-		return op > data.structured.value;
-	case dev::Condition::LESS_EQU:
-		return op <= data.structured.value;
-	case dev::Condition::GREATER_EQU:
-		return op >= data.structured.value;
-	case dev::Condition::NOT_EQU:
-		return op != data.structured.value;
-	}
-	return false;
+
+	return predicate(_cpuState, data.structured.value);
+}
+
+// Hardware thread
+bool dev::Breakpoint::Hit(const ConditionExpr::Context& _ctx)
+{
+	if (!CheckStatus(_ctx.cpuState, _ctx.memState)) return false;
+
+	return trigger.Hit(_ctx, "Breakpoint", data.structured.addr);
 }
 
 void dev::Breakpoint::Print() const
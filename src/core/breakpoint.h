@@ -11,6 +11,7 @@
 #include "utils/types.h"
 #include "core/cpu_i8080.h"
 #include "core/memory.h"
+#include "core/condition_expr.h"
 #include "utils/json_utils.h"
 
 namespace dev
@@ -136,18 +137,25 @@ namespace dev
 		};
 #pragma pack(pop)
 
-		Breakpoint(Data&& _data, const std::string& _comment = "");
+		// the operand and the condition of a breakpoint compiled into one call
+		using Predicate = bool (*)(const CpuI8080::State& _cpuState, const uint64_t _value);
+
+		Breakpoint(Data&& _data, const std::string& _comment = "", Trigger&& _trigger = {});
 
 		void Update(Breakpoint&& _bp);
 
 		auto GetAddrMappingS() const -> const char*;
 		bool IsActive() const { return data.structured.status == Status::ACTIVE; };
 		bool CheckStatus(const CpuI8080::State& _cpuState, const Memory::State& _memState) const;
+		// the pc reached the breakpoint. Checks the status, the condition, and the trigger. Returns true to break
+		bool Hit(const ConditionExpr::Context& _ctx);
 		auto GetOperandS() const -> const char*;
 		auto GetConditionS() const -> const std::string;
 		void Print() const;
 		auto IsActiveS() const -> const char*;
 		void UpdateAddrMappingS();
+		// picks the predicate for the operand and the condition. Called after the data changes
+		void Compile();
 		auto ToJson() const -> nlohmann::json
 		{
 			return {
@@ -158,12 +166,17 @@ namespace dev
 				{"operand", static_cast<uint32_t>(data.structured.operand)},
 				{"cond", static_cast<uint32_t>(data.structured.cond)},
 				{"value", data.structured.value},
-				{"comment", comment}
+				{"comment", comment},
+				{"expr", trigger.expr.GetExpr()},
+				{"ignore", trigger.ignoreCount},
+				{"action", static_cast<uint32_t>(trigger.action)}
 			};
 		};
 
 		Data data;
 		std::string comment;
+		Trigger trigger;
+		Predicate predicate = nullptr; // set by Compile()
 
 		std::string addrMappingS;
 	};
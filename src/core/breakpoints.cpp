@@ -7,15 +7,23 @@
 void dev::Breakpoints::Clear()
 {
 	m_bps.clear();
+	m_activeAddrs.reset();
 	m_updates++;
 }
 
+void dev::Breakpoints::UpdateActiveAddr(const Addr _addr)
+{
+	auto bpI = m_bps.find(_addr);
+	m_activeAddrs[_addr] = bpI != m_bps.end() && bpI->second.IsActive();
+}
+
 void dev::Breakpoints::SetStatus(const Addr _addr, const Breakpoint::Status _status)
 {
 	m_updates++;
 	auto bpI = m_bps.find(_addr);
 	if (bpI != m_bps.end()) {
 		bpI->second.data.structured.status = _status;
+		UpdateActiveAddr(_addr);
 		return;
 	}
 	Add(Breakpoint{ _addr });
@@ -24,14 +32,15 @@ void dev::Breakpoints::SetStatus(const Addr _addr, const Breakpoint::Status _sta
 void dev::Breakpoints::Add(Breakpoint&& _bp )
 {
 	m_updates++;
-	auto bpI = m_bps.find(_bp.data.structured.addr);
-	if (bpI != m_bps.end())
-	{
+	Addr addr = _bp.data.structured.addr;
+	auto bpI = m_bps.find(addr);
+	if (bpI != m_bps.end()) {
 		bpI->second.Update(std::move(_bp));
-		return;
 	}
-
-	m_bps.emplace(static_cast<Addr>(_bp.data.structured.addr), std::move(_bp));
+	else {
+		m_bps.emplace(addr, std::move(_bp));
+	}
+	UpdateActiveAddr(addr);
 }
 
 void dev::Breakpoints::Add(const nlohmann::json& _bpJ)
@@ -39,16 +48,17 @@ void dev::Breakpoints::Add(const nlohmann::json& _bpJ)
 	m_updates++;
 
 	Breakpoint::Data bpData {_bpJ};
-	Breakpoint bp{ std::move(bpData), _bpJ["comment"] };
+	Breakpoint bp{ std::move(bpData), _bpJ["comment"], Trigger{ _bpJ } };
 
-	auto bpI = m_bps.find(bp.data.structured.addr);
-	if (bpI != m_bps.end())
-	{
+	Addr addr = bp.data.structured.addr;
+	auto bpI = m_bps.find(addr);
+	if (bpI != m_bps.end()) {
 		bpI->second.Update(std::move(bp));
-		return;
 	}
-
-	m_bps.emplace(static_cast<Addr>(bp.data.structured.addr), std::move(bp));
+	else {
+		m_bps.emplace(addr, std::move(bp));
+	}
+	UpdateActiveAddr(addr);
 }
 
 void dev::Breakpoints::Del(const Addr _addr)
@@ -59,6 +69,7 @@ void dev::Breakpoints::Del(const Addr _addr)
 	{
 		m_bps.erase(bpI);
 	}
+	m_activeAddrs[_addr] = false;
 }
 
 auto dev::Breakpoints::GetStatus(const Addr _addr)
@@ -68,18 +79,26 @@ auto dev::Breakpoints::GetStatus(const Addr _addr)
 	return bpI == m_bps.end() ? Breakpoint::Status::DELETED : bpI->second.data.structured.status;
 }
 
-bool dev::Breakpoints::Check(const CpuI8080::State& _cpuState, const Memory::State& _memState)
+// the pc has an active breakpoint
+bool dev::Breakpoints::CheckActive(const ConditionExpr::Context& _ctx)
 {
-	auto bpI = m_bps.find(_cpuState.regs.pc.word);
+	Addr pc = _ctx.cpuState.regs.pc.word;
+	auto bpI = m_bps.find(pc);
 	if (bpI == m_bps.end()) return false;
 
-	auto status = bpI->second.CheckStatus(_cpuState, _memState);
-	if (bpI->second.data.structured.autoDel)
+	auto& bp = bpI->second;
+	auto hits = bp.trigger.hits;
+	auto break_ = bp.Hit(_ctx);
+	// the hit counts are shown in the UI
+	if (bp.trigger.hits != hits) m_updates++;
+
+	// the ignored and the logged hits don't delete it
+	if (break_ && bp.data.structured.autoDel)
 	{
 		m_bps.erase(bpI);
-		m_updates++;
+		m_activeAddrs[pc] = false;
 	}
-	return status;
+	return break_;
 }
 
 auto dev::Breakpoints::GetAll()
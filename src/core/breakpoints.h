@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <bitset>
 
 #include "utils/types.h"
 #include "utils/json_utils.h"
@@ -17,15 +18,23 @@ public:
 		void Add(Breakpoint&& _bp);
 		void Add(const nlohmann::json& _bpJ);
 		void Del(const Addr _addr);
-		bool Check(const CpuI8080::State& _cpuState, const Memory::State& _memState);
+		// called after every instruction. The addrs without an active breakpoint cost one bit test
+		inline bool Check(const ConditionExpr::Context& _ctx)
+		{
+			if (!m_activeAddrs[_ctx.cpuState.regs.pc.word]) return false;
+			return CheckActive(_ctx);
+		}
 		auto GetAll() -> const BpMap&;
 		auto GetUpdates() -> const uint32_t;
 		auto GetStatus(const Addr _addr) -> const Breakpoint::Status;
 		void Clear();
 
 private:
+		bool CheckActive(const ConditionExpr::Context& _ctx);
+		void UpdateActiveAddr(const Addr _addr);
 
 		BpMap m_bps;
+		std::bitset<Memory::MEM_64K> m_activeAddrs; // set if the addr has an active breakpoint
 		uint32_t m_updates; // counts number of updates
 
 		std::string addrMappingS;
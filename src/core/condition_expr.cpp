@@ -0,0 +1,398 @@
+#include <cctype>
+#include <cstring>
+#include <format>
+#include <array>
+
+#include "core/condition_expr.h"
+#include "utils/utils.h"
+
+namespace
+{
+	enum class Var : uint8_t {
+		A = 0, F, B, C, D, E, H, L, PSW, BC, DE, HL, SP, PC, CC,
+		FRAME, RASTER_LINE, RASTER_PIXEL, COUNT
+	};
+	static const char* varsS[] = {
+		"a", "f", "b", "c", "d", "e", "h", "l", "psw", "bc", "de", "hl", "sp", "pc", "cc",
+		"frame", "raster_line", "raster_pixel" };
+
+	auto GetVar(const Var _var, const dev::ConditionExpr::Context& _ctx)
+		-> uint64_t
+	{
+		const auto& regs = _ctx.cpuState.regs;
+		switch (_var)
+		{
+		case Var::A: return regs.psw.a;
+		case Var::F: return regs.psw.af.l;
+		case Var::B: return regs.bc.h;
+		case Var::C: return regs.bc.l;
+		case Var::D: return regs.de.h;
+		case Var::E: return regs.de.l;
+		case Var::H: return regs.hl.h;
+		case Var::L: return regs.hl.l;
+		case Var::PSW: return regs.psw.af.word;
+		case Var::BC: return regs.bc.word;
+		case Var::DE: return regs.de.word;
+		case Var::HL: return regs.hl.word;
+		case Var::SP: return regs.sp.word;
+		case Var::PC: return regs.pc.word;
+		case Var::CC: return _ctx.cpuState.cc;
+		case Var::FRAME: return _ctx.displayState.update.frameNum;
+		case Var::RASTER_LINE: return _ctx.displayState.update.framebufferIdx / dev::Display::FRAME_W;
+		case Var::RASTER_PIXEL: return _ctx.displayState.update.framebufferIdx % dev::Display::FRAME_W;
+		case Var::COUNT: break;
+		}
+		return 0;
+	}
+
+	auto ReadByte(const uint64_t _addr, const dev::Memory::AddrSpace _addrSpace, const dev::Memory::State& _memState)
+		-> uint64_t
+	{
+		auto globalAddr = dev::Memory::GetGlobalAddr(
+			static_cast<dev::Addr>(_addr), _addrSpace, _memState.update);
+		return _memState.ramP->at(globalAddr);
+	}
+}
+
+// a recursive descent parser emitting the postfix program
+class dev::ConditionExprParser
+{
+public:
+	using Op = ConditionExpr::Op;
+
+	ConditionExprParser(const std::string& _expr) : m_expr(_expr) {}
+
+	bool Parse(std::vector<ConditionExpr::Instr>& _program, std::string& _error)
+	{
+		Skip();
+		if (m_pos < m_expr.size()) ParseBinary(0);
+		if (m_error.empty() && m_pos < m_expr.size()) Fail("unexpected");
+
+		_error = m_error;
+		if (!m_error.empty()) return false;
+		_program = std::move(m_program);
+		return true;
+	}
+
+private:
+	struct BinOp
+	{
+		const char* s;
+		Op op;
+	};
+	// the binary operators by the precedence levels, the lowest first.
+	// A longer operator precedes its prefix within a level
+	static constexpr int LEVELS = 10;
+	// the unary operators, the parentheses, and the [] nesting limit. It bounds the recursion
+	static constexpr size_t NESTING_MAX = 64;
+	static constexpr std::array<std::array<BinOp, 4>, LEVELS> BIN_OPS = {{
+		{{ {"||", Op::OR} }},
+		{{ {"&&", Op::AND} }},
+		{{ {"|", Op::BIT_OR} }},
+		{{ {"^", Op::BIT_XOR} }},
+		{{ {"&", Op::BIT_AND} }},
+		{{ {"==", Op::EQU}, {"!=", Op::NOT_EQU}, {"=", Op::EQU} }},
+		{{ {"<=", Op::LESS_EQU}, {">=", Op::GREATER_EQU}, {"<", Op::LESS}, {">", Op::GREATER} }},
+		{{ {"<<", Op::SHL}, {">>", Op::SHR} }},
+		{{ {"+", Op::ADD}, {"-", Op::SUB} }},
+		{{ {"*", Op::MUL}, {"/", Op::DIV}, {"%", Op::MOD} }},
+	}};
+
+	void ParseBinary(const int _level)
+	{
+		if (_level == LEVELS) {
+			ParseUnary();
+			return;
+		}
+
+		ParseBinary(_level + 1);
+		while (m_error.empty())
+		{
+			const BinOp* binOpP = nullptr;
+			for (const auto& binOp : BIN_OPS[_level])
+			{
+				if (binOp.s && Match(binOp.s)) {
+					binOpP = &binOp;
+					break;
+				}
+			}
+			if (!binOpP) return;
+
+			ParseBinary(_level + 1);
+			Emit(binOpP->op);
+		}
+	}
+
+	void ParseUnary()
+	{
+		if (++m_nesting > NESTING_MAX) Fail("too complex");
+
+		if (Match("!")) { ParseUnary(); Emit(Op::NOT); }
+		else if (Match("~")) { ParseUnary(); Emit(Op::BIT_NOT); }
+		else if (Match("-")) { ParseUnary(); Emit(Op::NEG); }
+		else ParsePrimary();
+
+		m_nesting--;
+	}
+
+	void ParsePrimary()
+	{
+		if (!m_error.empty()) return;
+		if (m_pos >= m_expr.size()) {
+			Fail("an operand expected");
+			return;
+		}
+
+		if (Match("("))
+		{
+			ParseBinary(0);
+			if (!Match(")")) Fail("')' expected");
+		}
+		else if (Match("["))
+		{
+			ParseMem(Op::MEM_BYTE);
+		}
+		else if (std::isdigit(static_cast<unsigned char>(m_expr[m_pos])))
+		{
+			ParseNumber();
+		}
+		else if (std::isalpha(static_cast<unsigned char>(m_expr[m_pos])) || m_expr[m_pos] == '_')
+		{
+			ParseName();
+		}
+		else {
+			Fail("an operand expected");
+		}
+	}
+
+	// the addr referencing SP reads the stack mapping, the nested [] don't count
+	void ParseMem(const Op _op)
+	{
+		bool spOperand = m_spOperand;
+		m_spOperand = false;
+		ParseBinary(0);
+		if (!Match("]")) Fail("']' expected");
+		auto addrSpace = m_spOperand ? Memory::AddrSpace::STACK : Memory::AddrSpace::RAM;
+		Emit(_op, static_cast<uint64_t>(addrSpace));
+		m_spOperand = spOperand;
+	}
+
+	void ParseNumber()
+	{
+		size_t start = m_pos;
+		int base = 10;
+		if (m_expr.compare(m_pos, 2, "0x") == 0 || m_expr.compare(m_pos, 2, "0X") == 0)
+		{
+			base = 16;
+			m_pos += 2;
+		}
+
+		uint64_t val = 0;
+		size_t digitsStart = m_pos;
+		for (; m_pos < m_expr.size(); m_pos++)
+		{
+			char c = static_cast<char>(std::tolower(static_cast<unsigned char>(m_expr[m_pos])));
+			int digit = c >= '0' && c <= '9' ? c - '0' : base == 16 && c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+			if (digit < 0) break;
+			if (val > (UINT64_MAX - digit) / base) {
+				m_pos = start;
+				Fail("a too big number");
+				return;
+			}
+			val = val * base + digit;
+		}
+		if (m_pos == digitsStart ||
+			(m_pos < m_expr.size() && (std::isalnum(static_cast<unsigned char>(m_expr[m_pos])) || m_expr[m_pos] == '_')))
+		{
+			m_pos = start;
+			Fail("a bad number");
+			return;
+		}
+		Skip();
+		Emit(Op::CONST, val);
+	}
+
+	void ParseName()
+	{
+		size_t start = m_pos;
+		std::string name;
+		for (; m_pos < m_expr.size() &&
+			(std::isalnum(static_cast<unsigned char>(m_expr[m_pos])) || m_expr[m_pos] == '_'); m_pos++)
+		{
+			name += static_cast<char>(std::tolower(static_cast<unsigned char>(m_expr[m_pos])));
+		}
+		Skip();
+
+		if (name == "w" && Match("[")) {
+			ParseMem(Op::MEM_WORD);
+			return;
+		}
+
+		for (size_t i = 0; i < std::size(varsS); i++)
+		{
+			if (name == varsS[i]) {
+				if (static_cast<Var>(i) == Var::SP) m_spOperand = true;
+				Emit(Op::VAR, i);
+				return;
+			}
+		}
+		m_pos = start;
+		Fail("unknown '" + name + "'");
+	}
+
+	bool Match(const char* _s)
+	{
+		if (!m_error.empty()) return false;
+		size_t len = std::strlen(_s);
+		if (m_expr.compare(m_pos, len, _s) != 0) return false;
+		// "|" isn't the start of "||", the same for "&"
+		if (len == 1 && (_s[0] == '|' || _s[0] == '&') && m_pos + 1 < m_expr.size() && m_expr[m_pos + 1] == _s[0]) return false;
+		m_pos += len;
+		Skip();
+		return true;
+	}
+
+	void Skip()
+	{
+		while (m_pos < m_expr.size() && std::isspace(static_cast<unsigned char>(m_expr[m_pos]))) m_pos++;
+	}
+
+	void Emit(const Op _op, const uint64_t _val = 0)
+	{
+		if (!m_error.empty()) return;
+		m_program.push_back({ _op, _val });
+
+		// tracks the stack depth the program needs
+		if (_op == Op::CONST || _op == Op::VAR) m_depth++;
+		else if (_op >= Op::MUL) m_depth--;
+
+		if (m_depth > ConditionExpr::STACK_MAX) Fail("too complex");
+	}
+
+	void Fail(const std::string& _error)
+	{
+		if (m_error.empty()) m_error = _error + " at " + std::to_string(m_pos + 1);
+	}
+
+	const std::string& m_expr;
+	size_t m_pos = 0;
+	size_t m_depth = 0;
+	size_t m_nesting = 0;
+	bool m_spOperand = false; // the addr being parsed references SP
+	std::string m_error;
+	std::vector<ConditionExpr::Instr> m_program;
+};
+
+bool dev::ConditionExpr::Compile(const std::string& _expr)
+{
+	ConditionExprParser parser(_expr);
+	std::vector<Instr> program;
+	if (!parser.Parse(program, m_error)) return false;
+
+	m_expr = _expr;
+	m_program = std::move(program);
+	return true;
+}
+
+// Hardware thread
+bool dev::ConditionExpr::Eval(const Context& _ctx) const
+{
+	if (m_program.empty()) return true;
+
+	std::array<uint64_t, STACK_MAX> stack;
+	size_t top = 0; // the next free slot
+
+	for (const auto& instr : m_program)
+	{
+		switch (instr.op)
+		{
+		case Op::CONST: stack[top++] = instr.val; continue;
+		case Op::VAR: stack[top++] = GetVar(static_cast<Var>(instr.val), _ctx); continue;
+		case Op::MEM_BYTE:
+		{
+			auto addrSpace = static_cast<Memory::AddrSpace>(instr.val);
+			stack[top - 1] = ReadByte(stack[top - 1], addrSpace, _ctx.memState);
+			continue;
+		}
+		case Op::MEM_WORD:
+		{
+			auto addrSpace = static_cast<Memory::AddrSpace>(instr.val);
+			stack[top - 1] = ReadByte(stack[top - 1], addrSpace, _ctx.memState) |
+				ReadByte(uint16_t(stack[top - 1] + 1), addrSpace, _ctx.memState) << 8;
+			continue;
+		}
+		case Op::NEG: stack[top - 1] = 0 - stack[top - 1]; continue;
+		case Op::NOT: stack[top - 1] = !stack[top - 1]; continue;
+		case Op::BIT_NOT: stack[top - 1] = ~stack[top - 1]; continue;
+		default:
+			break;
+		}
+
+		// the binary ops
+		uint64_t r = stack[--top];
+		uint64_t& l = stack[top - 1];
+		switch (instr.op)
+		{
+		case Op::MUL: l *= r; break;
+		case Op::DIV: l = r ? l / r : 0; break;
+		case Op::MOD: l = r ? l % r : 0; break;
+		case Op::ADD: l += r; break;
+		case Op::SUB: l -= r; break;
+		case Op::SHL: l = r < 64 ? l << r : 0; break;
+		case Op::SHR: l = r < 64 ? l >> r : 0; break;
+		case Op::LESS: l = l < r; break;
+		case Op::LESS_EQU: l = l <= r; break;
+		case Op::GREATER: l = l > r; break;
+		case Op::GREATER_EQU: l = l >= r; break;
+		case Op::EQU: l = l == r; break;
+		case Op::NOT_EQU: l = l != r; break;
+		case Op::BIT_AND: l &= r; break;
+		case Op::BIT_XOR: l ^= r; break;
+		case Op::BIT_OR: l |= r; break;
+		case Op::AND: l = l && r; break;
+		case Op::OR: l = l || r; break;
+		default: break;
+		}
+	}
+	return stack[0] != 0;
+}
+
+dev::Trigger::Trigger(const nlohmann::json& _j)
+	:
+	ignoreCount(_j.value("ignore", 0u)),
+	action(static_cast<Action>(_j.value("action", 0u))),
+	hits(_j.value("hits", uint64_t(0)))
+{
+	if (action >= Action::COUNT) action = Action::BREAK;
+
+	std::string exprS = _j.value("expr", std::string());
+	if (!expr.Compile(exprS)) {
+		dev::Log("Condition \"{}\" is ignored: {}", exprS, expr.GetError());
+	}
+}
+
+// Hardware thread
+bool dev::Trigger::Hit(const ConditionExpr::Context& _ctx, const char* _kind, const GlobalAddr _addr)
+{
+	if (!expr.Eval(_ctx)) return false;
+
+	hits++;
+	if (hits <= ignoreCount) return false;
+	if (action == Action::BREAK) return true;
+
+	const auto& regs = _ctx.cpuState.regs;
+	dev::Log("{} 0x{:04X} hit {}: PC:{:04X} A:{:02X} F:{:02X} BC:{:04X} DE:{:04X} HL:{:04X} SP:{:04X} CC:{} frame:{} line:{}",
+		_kind, _addr, hits, regs.pc.word, regs.psw.a, regs.psw.af.l, regs.bc.word, regs.de.word, regs.hl.word,
+		regs.sp.word, _ctx.cpuState.cc, _ctx.displayState.update.frameNum,
+		_ctx.displayState.update.framebufferIdx / Display::FRAME_W);
+	return false;
+}
+
+auto dev::Trigger::GetS() const
+-> std::string
+{
+	std::string out = expr.GetExpr();
+	if (ignoreCount) out += std::format("{}ignore:{}", out.empty() ? "" : " ", ignoreCount);
+	if (action == Action::LOG) out += out.empty() ? "log" : " log";
+	return out;
+}
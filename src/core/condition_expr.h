@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "utils/types.h"
+#include "utils/json_utils.h"
+#include "core/cpu_i8080.h"
+#include "core/memory.h"
+#include "core/display.h"
+
+namespace dev
+{
+	class ConditionExprParser;
+
+	// A condition of a breakpoint or a watchpoint written as an expression, i.e.
+	// "HL==0x8000 && [SP+2]>5 && frame%2==0 && raster_line<40".
+	// It's compiled once into a postfix program, and evaluated on a stack only when its breakpoint hits.
+	// The operands: the numbers (decimal or 0x hex), the registers A F B C D E H L PSW BC DE HL SP PC,
+	// CC - the cpu cycles, frame, raster_line, raster_pixel,
+	// [addr] - the byte, w[addr] - the word at the addr in the ram the cpu sees,
+	// the addr referencing SP, i.e. [SP+2], reads the stack mapping like PUSH and POP do.
+	// The operators and their precedence follow C: ! ~ - (unary), * / %, + -, << >>, < <= > >=,
+	// == != (= is ==), &, ^, |, &&, ||
+	class ConditionExpr
+	{
+	public:
+		struct Context
+		{
+			const CpuI8080::State& cpuState;
+			const Memory::State& memState;
+			const Display::State& displayState;
+		};
+
+		// returns false and keeps the previous program if the expression is invalid.
+		// The empty expression is always true
+		bool Compile(const std::string& _expr);
+		bool Eval(const Context& _ctx) const;
+		bool IsEmpty() const { return m_program.empty(); }
+		auto GetExpr() const -> const std::string& { return m_expr; }
+		auto GetError() const -> const std::string& { return m_error; }
+
+	private:
+		static constexpr size_t STACK_MAX = 16;
+
+		enum class Op : uint8_t {
+			CONST = 0, VAR, MEM_BYTE, MEM_WORD,
+			NEG, NOT, BIT_NOT,
+			MUL, DIV, MOD, ADD, SUB, SHL, SHR,
+			LESS, LESS_EQU, GREATER, GREATER_EQU, EQU, NOT_EQU,
+			BIT_AND, BIT_XOR, BIT_OR, AND, OR
+		};
+
+		struct Instr
+		{
+			Op op;
+			uint64_t val = 0; // the const, the var idx, or the addr space of the memory read
+		};
+
+		friend class ConditionExprParser;
+
+		std::string m_expr;
+		std::string m_error;
+		std::vector<Instr> m_program;
+	};
+
+	// the expression, the ignore count, and the action the breakpoints and the watchpoints share
+	struct Trigger
+	{
+		enum class Action : uint8_t { BREAK = 0, LOG, COUNT };
+
+		ConditionExpr expr;
+		uint32_t ignoreCount = 0; // the hits to skip before the action
+		Action action = Action::BREAK;
+		uint64_t hits = 0; // the times the conditions were met
+
+		Trigger() = default;
+		// reads the optional "expr", "ignore", "action", and "hits"
+		Trigger(const nlohmann::json& _j);
+
+		// called when the own condition of the breakpoint or the watchpoint is met.
+		// Counts the hit if the expression is true. Returns true to break, the log action prints the hit
+		bool Hit(const ConditionExpr::Context& _ctx, const char* _kind, const GlobalAddr _addr);
+		auto GetS() const -> std::string;
+	};
+
+	static const char* triggerActionsS[] = { "Break", "Log" };
+}
@@ -370,7 +370,7 @@ void dev::DebugData::LoadDebugData(const std::string& _romPath)
 		{
 			Breakpoint::Data bpData{ breakpointJ };
 
-			Breakpoint bp{ std::move(bpData), breakpointJ["comment"] };
+			Breakpoint bp{ std::move(bpData), breakpointJ["comment"], Trigger{ breakpointJ } };
 			auto addr = bp.data.structured.addr;
 			m_breakpoints.Add(std::move(bp));
 		}
@@ -381,7 +381,7 @@ void dev::DebugData::LoadDebugData(const std::string& _romPath)
 		{
 			Watchpoint::Data wpData{ watchpointJ };
 
-			Watchpoint wp{ std::move(wpData), watchpointJ["comment"] };
+			Watchpoint wp{ std::move(wpData), watchpointJ["comment"], Trigger{ watchpointJ } };
 			m_watchpoints.Add(std::move(wp));
 		}
 	}
@@ -3,6 +3,7 @@
 #include <sstream>
 #include <cstring>
 #include <vector>
+#include <utility>
 
 #include "core/debugger.h"
 #include "utils/str_utils.h"
@@ -11,20 +12,19 @@
 dev::Debugger::Debugger(Hardware& _hardware)
 	:
 	m_hardware(_hardware),
-	m_lastReadsAddrs(), m_lastWritesAddrs(),
 	m_memLastRW(),
-	m_lastReadsAddrsOld(), m_lastWritesAddrsOld(), 
 	m_debugData(_hardware), m_disasm(_hardware, m_debugData),
-	m_traceLog(m_debugData),
-	m_lastRWAddrsOut()
+	m_traceLog(m_debugData)
 {
-
-	Hardware::DebugFunc debugFunc = std::bind(&Debugger::Debug, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4);
+	m_lastRW.reads.fill(LAST_RW_NO_DATA);
+	m_lastRW.writes.fill(LAST_RW_NO_DATA);
+	m_lastRWOld = m_lastRW;
+	m_lastRWPublished.store(m_lastRW);
 
 	Hardware::DebugReqHandlingFunc debugReqHandlingFunc = std::bind(&Debugger::DebugReqHandling, this,
 		std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4, std::placeholders::_5, std::placeholders::_6);
 
-	m_hardware.AttachDebugFuncs(debugFunc, debugReqHandlingFunc);
+	m_hardware.AttachDebugFuncs(&Debugger::DebugHook<FEATURES_ALL>, this, debugReqHandlingFunc);
 }
 
 // UI thread
@@ -42,13 +42,15 @@ void dev::Debugger::Reset(bool _resetRecorder,
 {
 	m_disasm.Reset();
 
-	m_lastWritesAddrs.fill(uint32_t(LAST_RW_NO_DATA));
-	m_lastReadsAddrs.fill(uint32_t(LAST_RW_NO_DATA));
-	m_lastWritesIdx = 0;
-	m_lastReadsIdx = 0;
-	m_memLastRW.fill(0);
+	// the UI clears m_memLastRW when it gets the empty buffers
+	m_lastRW.reads.fill(LAST_RW_NO_DATA);
+	m_lastRW.writes.fill(LAST_RW_NO_DATA);
+	m_lastRW.readsIdx = 0;
+	m_lastRW.writesIdx = 0;
+	PublishLastRW(_displayStateP->update.frameNum);
 
 	m_traceLog.Reset();
+	m_profiler.Reset(*_cpuStateP);
 	if (_resetRecorder) m_recorder.Reset(_cpuStateP, _memStateP, _ioStateP, _displayStateP);
 }
 
@@ -59,72 +61,127 @@ void dev::Debugger::Reset(bool _resetRecorder,
 //////////////////////////////////////////////////////////////
 
 // Hardware thread
+template <uint32_t _features>
 bool dev::Debugger::Debug(CpuI8080::State* _cpuStateP, Memory::State* _memStateP,
 	IO::State* _ioStateP, Display::State* _displayStateP)
 {
+	constexpr bool counters = _features & FEATURE_COUNTERS;
+	constexpr bool lastRW = _features & FEATURE_LAST_RW;
+	constexpr bool watchpoints = _features & FEATURE_WATCHPOINTS;
+	constexpr bool memEdits = _features & FEATURE_MEM_EDITS;
+
 	// instruction check
-	m_disasm.MemRunsUpdate(_memStateP->debug.instrGlobalAddr);
+	if constexpr (counters) m_disasm.MemRunsUpdate(_memStateP->debug.instrGlobalAddr);
 
-	// reads check
+	if constexpr (counters || lastRW || watchpoints || memEdits)
 	{
-		std::lock_guard<std::mutex> mlock(m_lastRWMutex);
-
+		// reads check
 		for (int i = 0; i < _memStateP->debug.readLen; i++)
 		{
 			GlobalAddr globalAddr = _memStateP->debug.readGlobalAddr[i];
 			uint8_t val = _memStateP->debug.read[i];
 
-			m_disasm.MemReadsUpdate(globalAddr);
+			if constexpr (counters) m_disasm.MemReadsUpdate(globalAddr);
 
-			m_debugData.GetWatchpoints()->Check(Watchpoint::Access::R, globalAddr, val);
+			if constexpr (watchpoints) m_debugData.GetWatchpoints()->Check(Watchpoint::Access::R, globalAddr, val);
 
-			m_lastReadsAddrs[m_lastReadsIdx++] = globalAddr;
-			m_lastReadsIdx %= LAST_RW_MAX;
+			if constexpr (lastRW)
+			{
+				m_lastRW.reads[m_lastRW.readsIdx++] = globalAddr;
+				m_lastRW.readsIdx %= LAST_RW_MAX;
+			}
 		}
-	}
-
-	// writes check
-	{
-		std::lock_guard<std::mutex> mlock(m_lastRWMutex);
 
+		// writes check
 		for (int i = 0; i < _memStateP->debug.writeLen; i++)
 		{
 			GlobalAddr globalAddr = _memStateP->debug.writeGlobalAddr[i];
 			uint8_t val = _memStateP->debug.write[i];
 
 			// check if the memory is read-only
-			auto memEdit = m_debugData.GetMemoryEdit(globalAddr);
-			if (memEdit && memEdit->active && memEdit->readonly) {
-				_memStateP->debug.write[i] = _memStateP->debug.beforeWrite[i];
-				_memStateP->ramP->at(globalAddr) = _memStateP->debug.beforeWrite[i];
-				continue;
-			};
-
-			m_disasm.MemWritesUpdate(globalAddr);
-
-			m_debugData.GetWatchpoints()->Check(Watchpoint::Access::W, globalAddr, val);
-
-			m_lastWritesAddrs[m_lastWritesIdx++] = globalAddr;
-			m_lastWritesIdx %= LAST_RW_MAX;
+			if constexpr (memEdits)
+			{
+				auto memEdit = m_debugData.GetMemoryEdit(globalAddr);
+				if (memEdit && memEdit->active && memEdit->readonly) {
+					_memStateP->debug.write[i] = _memStateP->debug.beforeWrite[i];
+					_memStateP->ramP->at(globalAddr) = _memStateP->debug.beforeWrite[i];
+					continue;
+				};
+			}
+
+			if constexpr (counters) m_disasm.MemWritesUpdate(globalAddr);
+
+			if constexpr (watchpoints) m_debugData.GetWatchpoints()->Check(Watchpoint::Access::W, globalAddr, val);
+
+			if constexpr (lastRW)
+			{
+				m_lastRW.writes[m_lastRW.writesIdx++] = globalAddr;
+				m_lastRW.writesIdx %= LAST_RW_MAX;
+			}
 		}
 	}
 
 	auto break_ = false;
+	ConditionExpr::Context ctx{ *_cpuStateP, *_memStateP, *_displayStateP };
 	// check watchpoint status
-	break_ |= m_debugData.GetWatchpoints()->CheckBreak();
+	if constexpr (watchpoints) break_ |= m_debugData.GetWatchpoints()->CheckBreak(ctx);
 
 	// check breakpoints
-	break_ |= m_debugData.GetBreakpoints()->Check(*_cpuStateP, *_memStateP);
+	break_ |= m_debugData.GetBreakpoints()->Check(ctx);
+
+	// the last reads and writes are sent to the UI once a frame, and when the execution breaks.
+	// The steps while stopped publish them with DEBUG_PUBLISH_LAST_RW
+	if constexpr (lastRW)
+	{
+		auto frameNum = _displayStateP->update.frameNum;
+		if (frameNum != m_lastRWFrameNum || break_) PublishLastRW(frameNum);
+	}
 
 	// tracelog
-	m_traceLog.Update(*_cpuStateP, *_memStateP);	
+	if constexpr ((_features & FEATURE_TRACE) != 0)
+	{
+		m_traceLog.Update(*_cpuStateP, *_memStateP);
+		if (m_traceCapture.IsCapturing()) m_traceCapture.Add(*_cpuStateP, *_memStateP, _displayStateP->update.frameNum);
+	}
 
 	// recorder
-	m_recorder.Update(_cpuStateP, _memStateP, _ioStateP, _displayStateP);
+	if constexpr ((_features & FEATURE_RECORDER) != 0) m_recorder.Update(_cpuStateP, _memStateP, _ioStateP, _displayStateP);
+
+	// profiler
+	if constexpr ((_features & FEATURE_PROFILER) != 0) m_profiler.Update(*_cpuStateP, *_memStateP, *_displayStateP);
 
 	return break_;
 }
 
+template <uint32_t _features>
+bool dev::Debugger::DebugHook(void* _debuggerP, CpuI8080::State* _cpuStateP, Memory::State* _memStateP,
+	IO::State* _ioStateP, Display::State* _displayStateP)
+{
+	return static_cast<Debugger*>(_debuggerP)->Debug<_features>(_cpuStateP, _memStateP, _ioStateP, _displayStateP);
+}
+
+// Hardware thread
+void dev::Debugger::SetFeatures(const uint32_t _features,
+	CpuI8080::State* _cpuStateP, Memory::State* _memStateP,
+	IO::State* _ioStateP, Display::State* _displayStateP)
+{
+	// the DebugHook of every features combination, the idx is the features
+	static constexpr auto debugFuncs = []<size_t... _idxs>(std::index_sequence<_idxs...>) {
+		return std::array<Hardware::DebugFunc, sizeof...(_idxs)>{ &Debugger::DebugHook<_idxs>... };
+	}(std::make_index_sequence<FEATURES_ALL + 1>{});
+
+	uint32_t features = _features & FEATURES_ALL;
+	uint32_t enabled = features & ~m_features;
+	m_features = features;
+
+	// the history has a gap while they were disabled
+	if (enabled & FEATURE_TRACE) m_traceLog.Reset();
+	if (enabled & FEATURE_RECORDER) m_recorder.Reset(_cpuStateP, _memStateP, _ioStateP, _displayStateP);
+	if (enabled & FEATURE_PROFILER) m_profiler.Reset(*_cpuStateP);
+
+	m_hardware.AttachDebugFunc(debugFuncs[features]);
+}
+
 // Hardware thread
 auto dev::Debugger::DebugReqHandling(Hardware::Req _req, nlohmann::json _reqDataJ,
 	CpuI8080::State* _cpuStateP, Memory::State* _memStateP,
@@ -144,6 +201,18 @@ auto dev::Debugger::DebugReqHandling(Hardware::Req _req, nlohmann::json _reqData
 	//
 	/////////////////
 	
+	case Hardware::Req::DEBUG_SET_FEATURES:
+		SetFeatures(_reqDataJ["features"], _cpuStateP, _memStateP, _ioStateP, _displayStateP);
+		break;
+
+	case Hardware::Req::DEBUG_GET_FEATURES:
+		out = nlohmann::json{ {"features", m_features} };
+		break;
+
+	case Hardware::Req::DEBUG_PUBLISH_LAST_RW:
+		PublishLastRW(_displayStateP->update.frameNum);
+		break;
+
 	case Hardware::Req::DEBUG_RECORDER_RESET:
 		m_recorder.Reset(_cpuStateP, _memStateP, _ioStateP, _displayStateP);
 		break;
@@ -156,6 +225,10 @@ auto dev::Debugger::DebugReqHandling(Hardware::Req _req, nlohmann::json _reqData
 		m_recorder.PlayReverse(_reqDataJ["frames"], _cpuStateP, _memStateP, _ioStateP, _displayStateP);
 		break;
 
+	case Hardware::Req::DEBUG_RECORDER_SEEK_TO_FRAME:
+		m_recorder.SeekToFrame(_reqDataJ["frame"], _cpuStateP, _memStateP, _ioStateP, _displayStateP);
+		break;
+
 	case Hardware::Req::DEBUG_RECORDER_GET_STATE_RECORDED:
 		out = nlohmann::json{ {"states", m_recorder.GetStateRecorded() } };
 		break;
@@ -164,17 +237,135 @@ auto dev::Debugger::DebugReqHandling(Hardware::Req _req, nlohmann::json _reqData
 		out = nlohmann::json{ {"states", m_recorder.GetStateCurrent() } };
 		break;
 
-	case Hardware::Req::DEBUG_RECORDER_SERIALIZE: {
+	case Hardware::Req::DEBUG_RECORDER_SAVE:
+		out = nlohmann::json{ {"result", m_recorder.Save(_reqDataJ["path"], *_memStateP) } };
+		break;
 
-		out = nlohmann::json{ {"data", nlohmann::json::binary(m_recorder.Serialize()) } };
+	case Hardware::Req::DEBUG_RECORDER_LOAD:
+		out = nlohmann::json{ {"result", m_recorder.Load(_reqDataJ["path"], 
+			_cpuStateP, _memStateP, _ioStateP, _displayStateP) } };
 		break;
-	}
+
 	case Hardware::Req::DEBUG_RECORDER_DESERIALIZE: {
 
 		nlohmann::json::binary_t binaryData = _reqDataJ["data"].get<nlohmann::json::binary_t>();
 		std::vector<uint8_t> data(binaryData.begin(), binaryData.end());
 
-		m_recorder.Deserialize(data, _cpuStateP, _memStateP, _ioStateP, _displayStateP);
+		out = nlohmann::json{ {"result", m_recorder.Deserialize(data,
+			_cpuStateP, _memStateP, _ioStateP, _displayStateP) } };
+		break;
+	}
+	case Hardware::Req::DEBUG_RECORDER_SET_SPILL:
+		m_recorder.SetSpill(_reqDataJ["enabled"], _cpuStateP, _memStateP, _ioStateP, _displayStateP);
+		break;
+
+	case Hardware::Req::DEBUG_RECORDER_GET_MEM_STATS:
+		out = nlohmann::json{ 
+			{"memUsed", m_recorder.GetMemUsed() },
+			{"memBudget", m_recorder.GetMemBudget() },
+			{"bytesPerFrame", m_recorder.GetBytesPerFrame() },
+			{"spillSize", m_recorder.GetSpillSize() },
+			{"spillEnabled", m_recorder.GetSpillEnabled() } };
+		break;
+	//////////////////
+	// 
+	// Profiler
+	//
+	/////////////////
+
+	case Hardware::Req::DEBUG_PROFILER_RESET:
+		m_profiler.Reset(*_cpuStateP);
+		break;
+
+	case Hardware::Req::DEBUG_PROFILER_GET: {
+		nlohmann::json funcsJ = nlohmann::json::array();
+		for (const auto& func : m_profiler.GetFuncs())
+		{
+			funcsJ.push_back({
+				{"func", func.func},
+				{"calls", func.calls},
+				{"inclusiveCC", func.inclusiveCC},
+				{"exclusiveCC", func.exclusiveCC} });
+		}
+		nlohmann::json hotSpotsJ = nlohmann::json::array();
+		for (const auto& hotSpot : m_profiler.GetHotSpots(_reqDataJ["hotSpots"]))
+		{
+			hotSpotsJ.push_back({ {"globalAddr", hotSpot.globalAddr}, {"cc", hotSpot.cc} });
+		}
+		out = nlohmann::json{ {"totalCC", m_profiler.GetTotalCC()}, {"funcs", funcsJ}, {"hotSpots", hotSpotsJ} };
+		break;
+	}
+	case Hardware::Req::DEBUG_PROFILER_ADD_REGION: {
+		Profiler::Region region{ _reqDataJ["type"], _reqDataJ["addr"], _reqDataJ["addrEnd"],
+			_reqDataJ["color"], _reqDataJ["name"] };
+		out = nlohmann::json{ {"result", m_profiler.AddRegion(region)} };
+		break;
+	}
+	case Hardware::Req::DEBUG_PROFILER_DEL_REGION:
+		m_profiler.DelRegion(_reqDataJ["idx"]);
+		break;
+
+	case Hardware::Req::DEBUG_PROFILER_GET_RASTER: {
+		nlohmann::json regionsJ = nlohmann::json::array();
+		for (const auto& region : m_profiler.GetRegions())
+		{
+			regionsJ.push_back({
+				{"type", region.type},
+				{"addr", region.addr},
+				{"addrEnd", region.addrEnd},
+				{"color", region.color},
+				{"name", region.name} });
+		}
+		nlohmann::json framesJ = nlohmann::json::array();
+		for (const auto& frame : m_profiler.GetRasterFrames(_reqDataJ["frames"]))
+		{
+			nlohmann::json spansJ = nlohmann::json::array();
+			for (size_t i = 0; i < frame.spansLen; i++)
+			{
+				const auto& span = frame.spans[i];
+				spansJ.push_back({ span.region, span.start, span.end, span.cc });
+			}
+			framesJ.push_back({ {"frameNum", frame.frameNum}, {"overrun", frame.overrun}, {"spans", spansJ} });
+		}
+		out = nlohmann::json{ {"regions", regionsJ}, {"frames", framesJ} };
+		break;
+	}
+	case Hardware::Req::DEBUG_PROFILER_GET_STACKS: {
+		nlohmann::json stacksJ = nlohmann::json::array();
+		for (const auto& stack : m_profiler.GetStacks())
+		{
+			stacksJ.push_back({ {"funcs", stack.funcs}, {"cc", stack.cc} });
+		}
+		out = nlohmann::json{ {"stacks", stacksJ} };
+		break;
+	}
+	//////////////////
+	// 
+	// Trace Capture
+	//
+	/////////////////
+
+	case Hardware::Req::DEBUG_TRACE_CAPTURE_START:
+		out = nlohmann::json{ {"result", m_traceCapture.Start(_reqDataJ["path"])} };
+		break;
+
+	case Hardware::Req::DEBUG_TRACE_CAPTURE_STOP:
+		m_traceCapture.Stop();
+		break;
+
+	case Hardware::Req::DEBUG_TRACE_CAPTURE_OPEN:
+		out = nlohmann::json{ {"result", m_traceCapture.Open(_reqDataJ["path"])} };
+		break;
+
+	case Hardware::Req::DEBUG_TRACE_CAPTURE_GET_STATS: {
+		auto stats = m_traceCapture.GetStats();
+		out = nlohmann::json{
+			{"capturing", stats.capturing},
+			{"path", m_traceCapture.GetPath()},
+			{"records", stats.records},
+			{"blocks", stats.blocks},
+			{"bytes", stats.bytes},
+			{"rawBytes", stats.rawBytes} };
 		break;
 	}
 	//////////////////
@@ -193,7 +384,7 @@ auto dev::Debugger::DebugReqHandling(Hardware::Req _req, nlohmann::json _reqData
 		
 	case Hardware::Req::DEBUG_BREAKPOINT_ADD: {
 		Breakpoint::Data bpData{ _reqDataJ["data0"], _reqDataJ["data1"], _reqDataJ["data2"] };
-		m_debugData.GetBreakpoints()->Add({ std::move(bpData), _reqDataJ["comment"] });
+		m_debugData.GetBreakpoints()->Add({ std::move(bpData), _reqDataJ["comment"], Trigger{ _reqDataJ } });
 		break;
 	}
 	case Hardware::Req::DEBUG_BREAKPOINT_SET_STATUS:
@@ -223,7 +414,11 @@ auto dev::Debugger::DebugReqHandling(Hardware::Req _req, nlohmann::json _reqData
 					{"data0", bp.data.data0}, 
 					{"data1", bp.data.data1}, 
 					{"data2", bp.data.data2}, 
-					{"comment", bp.comment}
+					{"comment", bp.comment},
+					{"expr", bp.trigger.expr.GetExpr()},
+					{"ignore", bp.trigger.ignoreCount},
+					{"action", static_cast<uint32_t>(bp.trigger.action)},
+					{"hits", bp.trigger.hits}
 			});
 		}
 		break;
@@ -244,7 +439,7 @@ auto dev::Debugger::DebugReqHandling(Hardware::Req _req, nlohmann::json _reqData
 
 	case Hardware::Req::DEBUG_WATCHPOINT_ADD: {
 		Watchpoint::Data wpData{ _reqDataJ["data0"], _reqDataJ["data1"] };
-		m_debugData.GetWatchpoints()->Add({ std::move(wpData), _reqDataJ["comment"] });
+		m_debugData.GetWatchpoints()->Add({ std::move(wpData), _reqDataJ["comment"], Trigger{ _reqDataJ } });
 		break;
 	}
 	case Hardware::Req::DEBUG_WATCHPOINT_GET_UPDATES:
@@ -257,7 +452,11 @@ auto dev::Debugger::DebugReqHandling(Hardware::Req _req, nlohmann::json _reqData
 			out.push_back({
 					{"data0", wp.data.data0},
 					{"data1", wp.data.data1},
-					{"comment", wp.comment}
+					{"comment", wp.comment},
+					{"expr", wp.trigger.expr.GetExpr()},
+					{"ignore", wp.trigger.ignoreCount},
+					{"action", static_cast<uint32_t>(wp.trigger.action)},
+					{"hits", wp.trigger.hits}
 				});
 		}
 		break;
@@ -293,6 +492,10 @@ auto dev::Debugger::DebugReqHandling(Hardware::Req _req, nlohmann::json _reqData
 	case Hardware::Req::DEBUG_MEMORY_EDIT_EXISTS:
 		out = { {"data", m_debugData.GetMemoryEdit(_reqDataJ["addr"]) != nullptr } };
 		break;
+
+	// the Hardware handles the rest
+	default:
+		break;
 	}
 	
 	return out;
@@ -313,6 +516,7 @@ void dev::Debugger::UpdateDisasm(const Addr _addr, const size_t _linesNum, const
 	if (_linesNum <= 0) return;
 	size_t lines = dev::Max(_linesNum, Disasm::DISASM_LINES_MAX);
 	m_disasm.Init(_linesNum);
+	m_disasm.UpdateMem(_addr, _instructionOffset);
 
 	// calculate a new address that precedes the specified 'addr' by the instructionOffset
 	Addr addr = m_disasm.GetAddr(_addr, _instructionOffset);
@@ -330,7 +534,7 @@ void dev::Debugger::UpdateDisasm(const Addr _addr, const size_t _linesNum, const
 			m_disasm.AddComment(addr);
 			m_disasm.AddLabes(addr);
 
-			uint8_t db = m_hardware.Request(Hardware::Req::GET_BYTE_RAM, { { "addr", addr } })->at("data");
+			uint8_t db = m_disasm.GetByte(addr);
 			uint32_t cmd = 0x1000 | db; // opcode 0x10 is used as a placeholder
 			auto breakpointStatus = m_debugData.GetBreakpoints()->GetStatus(addr);
 			addr += m_disasm.AddCode(addr, cmd, breakpointStatus);
@@ -342,8 +546,8 @@ void dev::Debugger::UpdateDisasm(const Addr _addr, const size_t _linesNum, const
 		m_disasm.AddComment(addr);
 		m_disasm.AddLabes(addr);
 
-		uint32_t cmd = m_hardware.Request(Hardware::Req::GET_THREE_BYTES_RAM, { { "addr", addr } })->at("data");
-		GlobalAddr globalAddr = m_hardware.Request(Hardware::Req::GET_GLOBAL_ADDR_RAM, { { "addr", addr } })->at("data");
+		uint32_t cmd = m_disasm.Get3Bytes(addr);
+		GlobalAddr globalAddr = m_disasm.GetGlobalAddr(addr);
 
 		auto breakpointStatus = m_debugData.GetBreakpoints()->GetStatus(globalAddr);
 
@@ -353,45 +557,60 @@ void dev::Debugger::UpdateDisasm(const Addr _addr, const size_t _linesNum, const
 	m_disasm.SetUpdated();
 }
 
+// Hardware thread
+void dev::Debugger::PublishLastRW(const uint64_t _frameNum)
+{
+	m_lastRWFrameNum = _frameNum;
+	m_lastRWPublished.store(m_lastRW);
+}
+
 // UI thread
 void dev::Debugger::UpdateLastRW()
 {
+	auto ver = m_lastRWPublished.version();
+	if (ver == m_lastRWVer) return;
+	m_lastRWVer = ver;
+
+	auto lastRW = m_lastRWPublished.load();
+
 	// remove old stats
-	for (int i = 0; i < m_lastReadsAddrsOld.size(); i++)
+	for (int i = 0; i < LAST_RW_MAX; i++)
 	{
-		auto globalAddrLastRead = m_lastReadsAddrsOld[i];
+		auto globalAddrLastRead = m_lastRWOld.reads[i];
 		if (globalAddrLastRead != LAST_RW_NO_DATA) {
 			m_memLastRW[globalAddrLastRead] = 0;
+			m_lastRWRows.set(globalAddrLastRead >> LAST_RW_ROW_BITS);
 		}
-		auto globalAddrLastWrite = m_lastWritesAddrsOld[i];
+		auto globalAddrLastWrite = m_lastRWOld.writes[i];
 		if (globalAddrLastWrite != LAST_RW_NO_DATA) {
 			m_memLastRW[globalAddrLastWrite] = 0;
+			m_lastRWRows.set(globalAddrLastWrite >> LAST_RW_ROW_BITS);
 		}
 	}
 
 	// copy new reads stats
-	std::lock_guard<std::mutex> mlock(m_lastRWMutex);
-	uint16_t readsIdx = m_lastReadsIdx;
-	for (auto globalAddr : m_lastReadsAddrs){
+	uint16_t readsIdx = lastRW.readsIdx;
+	for (auto globalAddr : lastRW.reads){
 		if (globalAddr != LAST_RW_NO_DATA) 
 		{
 			auto val = m_memLastRW[globalAddr] & 0xFFFF0000; // remove reads, keep writes
 			m_memLastRW[globalAddr] = val | static_cast<uint16_t>(LAST_RW_MAX - readsIdx) % LAST_RW_MAX;
+			m_lastRWRows.set(globalAddr >> LAST_RW_ROW_BITS);
 		}
 		readsIdx--;
 	}
 
 	// copy new writes stats
-	uint16_t writesIdx = m_lastWritesIdx;
-	for (auto globalAddr : m_lastWritesAddrs){
+	uint16_t writesIdx = lastRW.writesIdx;
+	for (auto globalAddr : lastRW.writes){
 		if (globalAddr != LAST_RW_NO_DATA) 
 		{
 			auto val = m_memLastRW[globalAddr] & 0x0000FFFF; // remove writes, keep reads
 			m_memLastRW[globalAddr] = val | (static_cast<uint16_t>(LAST_RW_MAX - writesIdx) % LAST_RW_MAX)<<16;
+			m_lastRWRows.set(globalAddr >> LAST_RW_ROW_BITS);
 		}
 		writesIdx--;
 	}
 	
-	m_lastReadsAddrsOld = m_lastReadsAddrs;
-	m_lastWritesAddrsOld = m_lastWritesAddrs;
+	m_lastRWOld = lastRW;
 }
\ No newline at end of file
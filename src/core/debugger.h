@@ -5,9 +5,11 @@
 #include <unordered_map>
 #include <vector>
 #include <array>
+#include <bitset>
 #include <format>
 
 #include "utils/types.h"
+#include "utils/seqlock.h"
 #include "core/hardware.h"
 #include "core/disasm.h"
 #include "core/debug_data.h"
@@ -15,7 +17,9 @@
 #include "core/breakpoint.h"
 #include "core/watchpoint.h"
 #include "core/trace_log.h"
+#include "core/trace_capture.h"
 #include "core/recorder.h"
+#include "core/profiler.h"
 
 namespace dev
 {
@@ -28,6 +32,31 @@ namespace dev
 		static constexpr uint32_t LAST_RW_NO_DATA = uint32_t(-1);
 		using MemLastRW = std::array<uint32_t, Memory::MEMORY_GLOBAL_LEN>;
 		using LastRWAddrs = std::array<uint32_t, LAST_RW_MAX>;
+		// the memory display uploads the rows of 256 bytes that the recent reads and writes changed
+		static constexpr int LAST_RW_ROW_BITS = 8;
+		using LastRWRows = std::bitset<(Memory::MEMORY_GLOBAL_LEN >> LAST_RW_ROW_BITS)>;
+
+		// the circular buffers of the recently read and written addresses
+		struct LastRW
+		{
+			LastRWAddrs reads;
+			LastRWAddrs writes;
+			int readsIdx = 0; // points to the least recently read. because it's a circular buffer, that element before it is the most recently read
+			int writesIdx = 0; // ...
+		};
+
+		// the per-instruction debug features. Debug() is instantiated for every combination of them,
+		// so a disabled feature costs nothing. The breakpoints are always checked
+		static constexpr uint32_t FEATURE_COUNTERS = 1 << 0;	// the run/read/write counters of the disasm
+		static constexpr uint32_t FEATURE_LAST_RW = 1 << 1;		// the recent reads and writes of the memory display
+		static constexpr uint32_t FEATURE_WATCHPOINTS = 1 << 2;
+		static constexpr uint32_t FEATURE_TRACE = 1 << 3;		// the trace log and the trace capture
+		static constexpr uint32_t FEATURE_RECORDER = 1 << 4;
+		static constexpr uint32_t FEATURE_MEM_EDITS = 1 << 5;	// the read-only memory edits
+		static constexpr uint32_t FEATURE_PROFILER = 1 << 6;	// the cycles per function
+		static constexpr uint32_t FEATURES_LEN = 7;
+		static constexpr uint32_t FEATURES_ALL = (1 << FEATURES_LEN) - 1;
+		static constexpr uint32_t FEATURES_NONE = 0;
 
 		Debugger(Hardware& _hardware);
 		~Debugger();
@@ -36,36 +65,55 @@ namespace dev
 			CpuI8080::State* _cpuStateP, Memory::State* _memStateP,
 			IO::State* _ioStateP, Display::State* _displayStateP);
 
+		template <uint32_t _features>
 		bool Debug(CpuI8080::State* _cpuStateP, Memory::State* _memStateP, 
 			IO::State* _ioStateP, Display::State* _displayStateP);
+		// attaches the Debug() instantiation of the _features. The enabled recorder and trace log start over
+		void SetFeatures(const uint32_t _features,
+			CpuI8080::State* _cpuStateP, Memory::State* _memStateP,
+			IO::State* _ioStateP, Display::State* _displayStateP);
+		auto GetFeatures() const -> uint32_t { return m_features; }
 		auto DebugReqHandling(Hardware::Req _req, nlohmann::json _reqDataJ, 
 			CpuI8080::State* _cpuStateP, Memory::State* _memStateP,
 			IO::State* _ioStateP, Display::State* _displayStateP) -> nlohmann::json;
 
 		void UpdateLastRW();
 		auto GetLastRW() -> const MemLastRW* { return &m_memLastRW; }
+		// the rows of m_memLastRW changed since the last ClearLastRWRows()
+		auto GetLastRWRows() const -> const LastRWRows& { return m_lastRWRows; }
+		void ClearLastRWRows() { m_lastRWRows.reset(); }
 		void UpdateDisasm(const Addr _addr, const size_t _lines, const int _instructionOffset);
 		auto GetTraceLog() -> TraceLog& { return m_traceLog; };
+		auto GetTraceCapture() -> TraceCapture& { return m_traceCapture; };
 		auto GetDebugData() -> DebugData& { return m_debugData; };
 		auto GetDisasm() -> Disasm& { return m_disasm; };
 		auto GetRecorder() -> Recorder& { return m_recorder; };
+		auto GetProfiler() -> Profiler& { return m_profiler; };
 
 	private:
+		// the Hardware::DebugFunc calling the Debug() instantiation of the _features
+		template <uint32_t _features>
+		static bool DebugHook(void* _debuggerP, CpuI8080::State* _cpuStateP, Memory::State* _memStateP,
+			IO::State* _ioStateP, Display::State* _displayStateP);
+		void PublishLastRW(const uint64_t _frameNum);
 
 		Hardware& m_hardware;
+		uint32_t m_features = FEATURES_ALL;
 		DebugData m_debugData;
 		Disasm m_disasm;
 		TraceLog m_traceLog;
+		TraceCapture m_traceCapture;
 		Recorder m_recorder;
+		Profiler m_profiler;
 
-		std::mutex m_lastRWMutex;
-		LastRWAddrs m_lastReadsAddrs; // a circular buffer that contains addresses
-		LastRWAddrs m_lastWritesAddrs; // ...
-		LastRWAddrs m_lastReadsAddrsOld; // ... used to clean up m_memLastReads
-		LastRWAddrs m_lastWritesAddrsOld; // ... ...
-		LastRWAddrs m_lastRWAddrsOut; // used to sent the data out of this thread
-		int m_lastReadsIdx = 0; // index to m_memLastReads, points to the least recently read. because it's a circular buffer, that element before it is the most recently read
-		int m_lastWritesIdx = 0; // ...
+		// the Hardware thread fills m_lastRW without locking and publishes a copy of it once a frame
+		LastRW m_lastRW;
+		uint64_t m_lastRWFrameNum = 0;
+		SeqLock<LastRW> m_lastRWPublished;
+		// UI thread
+		uint32_t m_lastRWVer = uint32_t(-1); // the version of the published buffers applied to m_memLastRW
+		LastRW m_lastRWOld; // used to clean up m_memLastRW
+		LastRWRows m_lastRWRows;
 		MemLastRW m_memLastRW; // low 2 bytes of each element contains the order of readings. 255 is the most recently read, 0 - the least recently read
 								// high 2 bytes contains the order of writings. 255 is the most recently written, 0 - the least recently written
 	};
@@ -878,10 +878,10 @@ auto dev::Disasm::AddCode(const Addr _addr, const uint32_t _cmd,
 {
 	if (m_lineIdx >= DISASM_LINES_MAX) return 0;
 
-	GlobalAddr globalAddr = m_hardware.Request(Hardware::Req::GET_GLOBAL_ADDR_RAM, { { "addr", _addr } })->at("data");
-	auto runs = m_memRuns[globalAddr];
-	auto reads = m_memReads[globalAddr];
-	auto writes = m_memWrites[globalAddr];
+	GlobalAddr globalAddr = GetGlobalAddr(_addr);
+	auto runs = m_memRuns.Get(globalAddr);
+	auto reads = m_memReads.Get(globalAddr);
+	auto writes = m_memWrites.Get(globalAddr);
 
 	uint8_t opcode = _cmd & 0xFF;
 	auto immType = cmdImms[opcode];
@@ -978,8 +978,7 @@ auto dev::Disasm::Line::GetStr() const
 }
 
 dev::Disasm::Disasm(Hardware& _hardware, DebugData& _debugData)
-	: m_hardware(_hardware), m_debugData(_debugData),
-	m_memRuns(), m_memReads(), m_memWrites()
+	: m_hardware(_hardware), m_debugData(_debugData)
 {}
 
 void dev::Disasm::Init(const LineIdx _linesNum)
@@ -991,9 +990,9 @@ void dev::Disasm::Init(const LineIdx _linesNum)
 
 void dev::Disasm::Reset() 
 {
-	m_memRuns.fill(0);
-	m_memReads.fill(0);
-	m_memWrites.fill(0);
+	m_memRuns.Reset();
+	m_memReads.Reset();
+	m_memWrites.Reset();
 
 	m_linesP = nullptr;
 }
@@ -1056,8 +1055,7 @@ auto dev::Disasm::GetAddr(const Addr _addr, const int _instructionOffset) const
 		Addr addr = _addr;
 		for (int i = 0; i < instructions; i++)
 		{
-			auto resOpcode = m_hardware.Request(Hardware::Req::GET_BYTE_RAM, { { "addr", addr } });
-			uint8_t opcode = resOpcode->at("data");
+			uint8_t opcode = GetByte(addr);
 
 			auto cmdLen = GetCmdLen(opcode);
 			addr = addr + cmdLen;
@@ -1077,8 +1075,7 @@ auto dev::Disasm::GetAddr(const Addr _addr, const int _instructionOffset) const
 
 			while (addr < _addr && currentInstruction < instructions)
 			{
-				auto resOpcode = m_hardware.Request(Hardware::Req::GET_BYTE_RAM, { { "addr", addr } });
-				uint8_t opcode = resOpcode->at("data");
+				uint8_t opcode = GetByte(addr);
 
 				auto cmdLen = GetCmdLen(opcode);
 				addr = addr + cmdLen;
@@ -1103,10 +1100,43 @@ auto dev::Disasm::GetAddr(const Addr _addr, const int _instructionOffset) const
 		// get the best result basing on the execution counter
 		for (const auto possibleDisasmStartAddr : possibleDisasmStartAddrs)
 		{
-			if (m_memRuns[possibleDisasmStartAddr] > 0) return possibleDisasmStartAddr;
+			if (m_memRuns.Get(possibleDisasmStartAddr) > 0) return possibleDisasmStartAddr;
 		}
 		return possibleDisasmStartAddrs[0];
 	}
 
 	return _addr;
 }
+
+// copies the memory range GetAddr and the following disasm of DISASM_LINES_MAX lines can access
+void dev::Disasm::UpdateMem(const Addr _addr, const int _instructionOffset)
+{
+	size_t offsetLen = dev::Abs(_instructionOffset) * CMD_LEN_MAX;
+	size_t len = dev::Min(offsetLen * 2 + (DISASM_LINES_MAX + 1) * CMD_LEN_MAX, Memory::MEM_64K);
+
+	m_memAddr = static_cast<Addr>(_addr - offsetLen);
+	m_mem.resize(len);
+	m_memUpdate = m_hardware.RequestMemRange(m_mem.data(), m_memAddr, len);
+}
+
+// reads the local copy. falls back to the request if the addr is out of the copied range
+auto dev::Disasm::GetByte(const Addr _addr) const
+-> uint8_t
+{
+	Addr idx = _addr - m_memAddr;
+	if (idx < m_mem.size()) return m_mem[idx];
+
+	return m_hardware.RequestByte(_addr);
+}
+
+auto dev::Disasm::Get3Bytes(const Addr _addr) const
+-> uint32_t
+{
+	return GetByte(_addr) | GetByte(_addr + 1) << 8 | GetByte(_addr + 2) << 16;
+}
+
+auto dev::Disasm::GetGlobalAddr(const Addr _addr) const
+-> GlobalAddr
+{
+	return Memory::GetGlobalAddr(_addr, Memory::AddrSpace::RAM, m_memUpdate);
+}
@@ -9,6 +9,7 @@
 #include "core/breakpoint.h"
 #include "core/hardware.h"
 #include "core/debug_data.h"
+#include "core/mem_counters.h"
 
 namespace dev
 {
@@ -116,12 +117,16 @@ namespace dev
 		auto GetImmAddrlinkNum() const -> size_t { return m_immAddrlinkNum; }
 
 		auto GetAddr(const Addr _endAddr, const int _instructionOffset) const->Addr;
+		void UpdateMem(const Addr _addr, const int _instructionOffset);
+		auto GetByte(const Addr _addr) const -> uint8_t;
+		auto Get3Bytes(const Addr _addr) const -> uint32_t;
+		auto GetGlobalAddr(const Addr _addr) const -> GlobalAddr;
 		void Reset();
 		void SetUpdated() { m_linesP = &m_lines; };
 
-		inline void MemRunsUpdate(const GlobalAddr _globalAddr) { m_memRuns[_globalAddr]++; };
-		inline void MemReadsUpdate(const GlobalAddr _globalAddr) { m_memReads[_globalAddr]++; };
-		inline void MemWritesUpdate(const GlobalAddr _globalAddr) { m_memWrites[_globalAddr]++; };
+		inline void MemRunsUpdate(const GlobalAddr _globalAddr) { m_memRuns.Inc(_globalAddr); };
+		inline void MemReadsUpdate(const GlobalAddr _globalAddr) { m_memReads.Inc(_globalAddr); };
+		inline void MemWritesUpdate(const GlobalAddr _globalAddr) { m_memWrites.Inc(_globalAddr); };
 
 	private:
 
@@ -134,10 +139,14 @@ namespace dev
 		size_t m_immAddrlinkNum = 0; // the total number of links between the immediate operand and the corresponding address
 		Hardware& m_hardware;
 		DebugData& m_debugData;
+
+		// a copy of the memory the disasm is built from. it is requested in one round trip
+		std::vector<uint8_t> m_mem;
+		Addr m_memAddr = 0;
+		Memory::Update m_memUpdate; // the mapping the memory was copied with
 		
-		using MemStats = std::array<uint64_t, Memory::MEMORY_GLOBAL_LEN>;
-		MemStats m_memRuns;
-		MemStats m_memReads;
-		MemStats m_memWrites;
+		MemCounters m_memRuns;
+		MemCounters m_memReads;
+		MemCounters m_memWrites;
 	};
 }
\ No newline at end of file
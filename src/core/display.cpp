@@ -3,9 +3,9 @@
 
 #define BORDER_RIGHT	( m_borderLeft + ACTIVE_AREA_W )
 
-dev::Display::Display(Memory& _memory, IO& _io)
+dev::Display::Display(Memory& _memory, IO& _io, Scheduler& _scheduler)
 	:
-	m_memory(_memory), m_io(_io)
+	m_memory(_memory), m_io(_io), m_scheduler(_scheduler)
 {
 	// init the full palette
 	for (int i = 0; i < FULL_PALLETE_LEN; i++) {
@@ -22,16 +22,44 @@ void dev::Display::Init()
 {
 	m_state.update.framebufferIdx = 0;
 	m_frameBuffer.fill(0xff000000);
+	ScheduleEvents();
 }
 
-void dev::Display::RasterizeActiveArea(const int _rasterizedPixels)
+// registers the timed events of the current frame.
+// has to be called when the frame is over or the state is restored
+void dev::Display::ScheduleEvents()
 {
-	int rasterLine = GetRasterLine();
-	int rasterPixel = GetRasterPixel();
-	auto commitTime = m_io.GetOutCommitTimer() > 0 || m_io.GetPaletteCommitTimer() > 0;
+	Scheduler::Time frameStart = m_state.update.frameNum * FRAME_LEN;
+	m_scheduler.SetTime(frameStart + m_state.update.framebufferIdx);
 
-	bool scrollTime = rasterLine == SCAN_ACTIVE_AREA_TOP && rasterPixel < m_borderLeft + RASTERIZED_PXLS_MAX;
-	if (commitTime || scrollTime)
+	// the irq and the frame end are checked after the pixel is stored
+	if (m_irqCommitPxl > 0 && m_state.update.framebufferIdx < m_irqCommitPxl) {
+		m_scheduler.Schedule(Scheduler::Event::DISPLAY_IRQ, frameStart + m_irqCommitPxl - 1);
+	}
+	else {
+		m_scheduler.Cancel(Scheduler::Event::DISPLAY_IRQ);
+	}
+
+	constexpr int scrollCommitIdx = SCAN_ACTIVE_AREA_TOP * FRAME_W + SCROLL_COMMIT_PXL;
+	if (m_state.update.framebufferIdx <= scrollCommitIdx) {
+		m_scheduler.Schedule(Scheduler::Event::DISPLAY_SCROLL, frameStart + scrollCommitIdx);
+	}
+	else {
+		m_scheduler.Cancel(Scheduler::Event::DISPLAY_SCROLL);
+	}
+
+	m_scheduler.Schedule(Scheduler::Event::DISPLAY_FRAME_END, frameStart + FRAME_LEN - 1);
+}
+
+void dev::Display::SetIrqCommitPxl(const int _irqCommitPxl)
+{
+	m_irqCommitPxl = _irqCommitPxl;
+	ScheduleEvents();
+}
+
+void dev::Display::RasterizeActiveArea(const int _rasterizedPixels, const bool _eventTime)
+{
+	if (_eventTime)
 	{
 		if (m_io.GetDisplayMode() == IO::MODE_256) FillActiveArea256PortHandling(_rasterizedPixels);
 		else FillActiveArea512PortHandling(_rasterizedPixels);
@@ -42,12 +70,9 @@ void dev::Display::RasterizeActiveArea(const int _rasterizedPixels)
 	}
 }
 
-void dev::Display::RasterizeBorder(const int _rasterizedPixels)
+void dev::Display::RasterizeBorder(const int _rasterizedPixels, const bool _eventTime)
 {
-	int rasterLine = GetRasterLine();
-	auto commitTime = m_io.GetOutCommitTimer() >= 0 || m_io.GetPaletteCommitTimer() >= 0;
-
-	if (commitTime || rasterLine == 0 || rasterLine == 311)
+	if (_eventTime)
 	{
 		FillBorderPortHandling(_rasterizedPixels);
 	}
@@ -62,6 +87,9 @@ void dev::Display::Rasterize()
 	// reset the interrupt request. it can be set during border drawing.
 	m_state.update.irq = false;
 
+	// the per-pixel handling is required only when an event is due within this block
+	bool eventTime = m_scheduler.IsDue(RASTERIZED_PXLS_MAX);
+
 	int rasterLine = GetRasterLine();
 	int rasterPixel = GetRasterPixel();
 	
@@ -73,12 +101,12 @@ void dev::Display::Rasterize()
 	if (isActiveArea)
 	{
 		int rasterizedPixels = dev::Min(BORDER_RIGHT - rasterPixel, RASTERIZED_PXLS_MAX);
-		RasterizeActiveArea(rasterizedPixels);
+		RasterizeActiveArea(rasterizedPixels, eventTime);
 		// Rasterize the border if there is a leftover
 		if (rasterizedPixels < RASTERIZED_PXLS_MAX)
 		{
 			rasterizedPixels = RASTERIZED_PXLS_MAX - rasterizedPixels;
-			RasterizeBorder(rasterizedPixels);
+			RasterizeBorder(rasterizedPixels, eventTime);
 		}
 	}
 	// Rasterize the Border
@@ -86,15 +114,17 @@ void dev::Display::Rasterize()
 		int rasterizedPixels = !isActiveScan || rasterPixel >= BORDER_RIGHT ? RASTERIZED_PXLS_MAX :
 						dev::Min(m_borderLeft - rasterPixel, RASTERIZED_PXLS_MAX);
 
-		RasterizeBorder(rasterizedPixels);
+		RasterizeBorder(rasterizedPixels, eventTime);
 
 		// Rasterize the Active Area if there is a leftover
 		if (rasterizedPixels < RASTERIZED_PXLS_MAX)
 		{
 			rasterizedPixels = RASTERIZED_PXLS_MAX - rasterizedPixels;
-			RasterizeActiveArea(rasterizedPixels);
+			RasterizeActiveArea(rasterizedPixels, eventTime);
 		}
 	}
+
+	m_scheduler.SetTime(m_state.update.frameNum * FRAME_LEN + m_state.update.framebufferIdx);
 }
 
 void dev::Display::FillBorder(const int _rasterizedPixels)
@@ -117,15 +147,19 @@ void dev::Display::FillBorderPortHandling(const int _rasterizedPixels)
 		int isNewFrame = m_state.update.framebufferIdx / FRAME_LEN;
 		m_state.update.framebufferIdx %= FRAME_LEN;
 
-		int rasterLine = GetRasterLine();
-		int rasterPixel = GetRasterPixel();
-		m_state.update.irq |= m_state.update.framebufferIdx == m_irqCommitPxl;
+		if (m_state.update.framebufferIdx == m_irqCommitPxl) {
+			m_state.update.irq = true;
+			m_scheduler.Cancel(Scheduler::Event::DISPLAY_IRQ);
+		}
 
 		if (isNewFrame)
 		{
 			m_state.update.frameNum++;
-			std::unique_lock<std::mutex> mlock(m_backBufferMutex);
-			m_backBuffer = m_frameBuffer; // copy a frame to a back buffer
+			{
+				std::unique_lock<std::mutex> mlock(m_backBufferMutex);
+				m_backBuffer = m_frameBuffer; // copy a frame to a back buffer
+			}
+			ScheduleEvents();
 		}
 	}
 }
@@ -173,6 +207,7 @@ void dev::Display::FillActiveArea256PortHandling(const int _rasterizedPixels)
 
 		if (rasterLine == SCAN_ACTIVE_AREA_TOP && rasterPixel == SCROLL_COMMIT_PXL) {
 			m_state.update.scrollIdx = m_io.GetScroll();
+			m_scheduler.Cancel(Scheduler::Event::DISPLAY_SCROLL);
 		}
 
 		auto colorIdx = BytesToColorIdx256(screenBytes, bitIdx);
@@ -206,6 +241,7 @@ void dev::Display::FillActiveArea512PortHandling(const int _rasterizedPixels)
 
 		if (rasterLine == SCAN_ACTIVE_AREA_TOP && rasterPixel == SCROLL_COMMIT_PXL) {
 			m_state.update.scrollIdx = m_io.GetScroll();
+			m_scheduler.Cancel(Scheduler::Event::DISPLAY_SCROLL);
 		}
 
 		auto colorIdx = BytesToColorIdx512(screenBytes, pxlIdx);
@@ -250,6 +286,23 @@ void dev::Display::FillActiveArea512(const int _rasterizedPixels)
 
 bool dev::Display::IsIRQ() { return m_state.update.irq; }
 
+void dev::Display::StoreState(SaveState& _state)
+{
+	_state.update = m_state.update;
+	_state.frameBuffer = m_frameBuffer;
+	std::unique_lock<std::mutex> mlock(m_backBufferMutex);
+	_state.backBuffer = m_backBuffer;
+}
+
+// the caller has to restore the scheduler or call ScheduleEvents after
+void dev::Display::RestoreState(const SaveState& _state)
+{
+	m_state.update = _state.update;
+	m_frameBuffer = _state.frameBuffer;
+	std::unique_lock<std::mutex> mlock(m_backBufferMutex);
+	m_backBuffer = _state.backBuffer;
+}
+
 auto dev::Display::GetFrame(const bool _vsync)
 ->const FrameBuffer*
 {
@@ -8,6 +8,7 @@
 #include "utils/types.h"
 #include "core/memory.h"
 #include "core/io.h"
+#include "core/scheduler.h"
 
 namespace dev
 {
@@ -81,9 +82,20 @@ namespace dev
 			BuffUpdateFunc BuffUpdate = nullptr;
 		};
 
+		// the display part of the machine state to clone it.
+		// the frame buffer holds the pixels of the current frame rasterized so far,
+		// the back buffer holds the last completed frame
+		struct SaveState
+		{
+			Update update;
+			FrameBuffer frameBuffer;
+			FrameBuffer backBuffer;
+		};
+
 	private:
 		Memory& m_memory;
 		IO& m_io;
+		Scheduler& m_scheduler;
 
 		State m_state;
 
@@ -96,11 +108,13 @@ namespace dev
 		int m_irqCommitPxl = IRQ_COMMIT_PXL;
 
 	public:
-		Display(Memory& _memory, IO& _io);
+		Display(Memory& _memory, IO& _io, Scheduler& _scheduler);
 		void Init();
+		void ScheduleEvents();
 		void Rasterize();
 		bool IsIRQ();
 		auto GetFrame(const bool _vsync) ->const FrameBuffer*;
+		auto GetBackBuffer() const -> const FrameBuffer* { return &m_backBuffer; }; // Hardware thread. The last completed frame
 		inline auto GetFrameNum() const -> uint64_t { return m_state.update.frameNum; };
 		inline int GetRasterLine() const { return m_state.update.framebufferIdx / FRAME_W; };
 		inline int GetRasterPixel() const { return m_state.update.framebufferIdx % FRAME_W; };
@@ -112,19 +126,22 @@ namespace dev
 		auto GetBorderLeft() const -> int { return m_borderLeft; };
 		void SetBorderLeft(const int _borderLeft) { m_borderLeft = _borderLeft; };
 		auto GetIrqCommitPxl() const -> int { return m_irqCommitPxl; };
-		void SetIrqCommitPxl(const int _irqCommitPxl) { m_irqCommitPxl = _irqCommitPxl; };
+		// re-arms the irq event of the current frame
+		void SetIrqCommitPxl(const int _irqCommitPxl);
+		void StoreState(SaveState& _state);
+		void RestoreState(const SaveState& _state);
 
 	private:
 		uint32_t BytesToColorIdxs();
 		uint32_t GetScreenBytes(int _rasterLine, int _rasterPixel);
 		uint32_t BytesToColorIdx256(uint32_t _screenBytes, uint8_t _bitIdx);
 		uint32_t BytesToColorIdx512(uint32_t _screenBytes, uint8_t _bitIdx);
-		void RasterizeActiveArea(const int _rasterizedPixels);
+		void RasterizeActiveArea(const int _rasterizedPixels, const bool _eventTime);
 		void FillActiveArea256(const int _rasterizedPixels = RASTERIZED_PXLS_MAX);
 		void FillActiveArea512(const int _rasterizedPixels = RASTERIZED_PXLS_MAX);
 		void FillActiveArea256PortHandling(const int _rasterizedPixels = RASTERIZED_PXLS_MAX);
 		void FillActiveArea512PortHandling(const int _rasterizedPixels = RASTERIZED_PXLS_MAX);
-		void RasterizeBorder(const int _rasterizedPixels);
+		void RasterizeBorder(const int _rasterizedPixels, const bool _eventTime);
 		void FillBorder(const int _rasterizedPixels = RASTERIZED_PXLS_MAX);
 		void FillBorderPortHandling(const int _rasterizedPixels = RASTERIZED_PXLS_MAX);
 		void BuffUpdate(Buffer _buffer);
@@ -0,0 +1,336 @@
+#include <algorithm>
+#include <cstring>
+
+#include "core/exporter.h"
+#include "utils/utils.h"
+#include "utils/str_utils.h"
+
+namespace
+{
+	// PNG chunks checksum
+	constexpr auto CRC_TABLE = [] {
+		std::array<uint32_t, 256> table{};
+		for (uint32_t n = 0; n < 256; n++)
+		{
+			uint32_t c = n;
+			for (int k = 0; k < 8; k++) {
+				c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+			}
+			table[n] = c;
+		}
+		return table;
+	}();
+
+	auto Crc32(const uint8_t* _data, const size_t _len, uint32_t _crc = 0xffffffffu)
+		-> uint32_t
+	{
+		for (size_t i = 0; i < _len; i++) {
+			_crc = CRC_TABLE[(_crc ^ _data[i]) & 0xff] ^ (_crc >> 8);
+		}
+		return _crc;
+	}
+
+	void PushU32BE(std::vector<uint8_t>& _out, const uint32_t _val)
+	{
+		_out.push_back(_val >> 24);
+		_out.push_back(_val >> 16);
+		_out.push_back(_val >> 8);
+		_out.push_back(_val);
+	}
+
+	void PushChunk(std::vector<uint8_t>& _out, const char* _type, const std::vector<uint8_t>& _data)
+	{
+		PushU32BE(_out, static_cast<uint32_t>(_data.size()));
+		auto crcStart = _out.size();
+		_out.insert(_out.end(), _type, _type + 4);
+		_out.insert(_out.end(), _data.begin(), _data.end());
+		PushU32BE(_out, Crc32(_out.data() + crcStart, _out.size() - crcStart) ^ 0xffffffffu);
+	}
+}
+
+dev::Exporter::Exporter(const std::string& _videoPath, const std::string& _audioPath, const int _workers)
+	:
+	m_videoFormat(GetVideoFormat(_videoPath)),
+	m_audioFormat(GetAudioFormat(_audioPath)),
+	m_videoPath(_videoPath)
+{
+	if (!_videoPath.empty() && m_videoFormat == VideoFormat::NONE) {
+		dev::Log("Exporter: unsupported video format. Use .rgba, .y4m, or .png. Path: {}", _videoPath);
+		return;
+	}
+	if (!_audioPath.empty() && m_audioFormat == AudioFormat::NONE) {
+		dev::Log("Exporter: unsupported audio format. Use .wav or .raw. Path: {}", _audioPath);
+		return;
+	}
+
+	if (m_videoFormat == VideoFormat::RGBA || m_videoFormat == VideoFormat::Y4M)
+	{
+		m_videoFile.open(_videoPath, std::ios::binary | std::ios::trunc);
+		if (!m_videoFile) {
+			dev::Log("Exporter: failed to create the file: {}", _videoPath);
+			return;
+		}
+		if (m_videoFormat == VideoFormat::Y4M)
+		{
+			m_videoFile << "YUV4MPEG2 W" << Display::FRAME_W << " H" << Display::FRAME_H
+				<< " F" << FRAME_RATE_NUM << ":" << FRAME_RATE_DEN << " Ip A1:1 C444\n";
+		}
+	}
+
+	if (m_audioFormat != AudioFormat::NONE)
+	{
+		m_audioFile.open(_audioPath, std::ios::binary | std::ios::trunc);
+		if (!m_audioFile) {
+			dev::Log("Exporter: failed to create the file: {}", _audioPath);
+			return;
+		}
+		// reserves the space, the sizes are updated in Finish
+		if (m_audioFormat == AudioFormat::WAV) dev::WriteWavHeader(m_audioFile, m_samples, AUDIO_RATE);
+	}
+
+	if (m_videoFormat != VideoFormat::NONE)
+	{
+		int workers = _workers > 0 ? _workers : dev::Max(1, int(std::thread::hardware_concurrency()) - 1);
+		m_jobsMax = workers * JOBS_PER_WORKER;
+		for (int i = 0; i < workers; i++) {
+			m_workers.emplace_back(&Exporter::Worker, this);
+		}
+	}
+
+	m_inited = true;
+}
+
+dev::Exporter::~Exporter()
+{
+	Finish();
+}
+
+auto dev::Exporter::GetVideoFormat(const std::string& _path)
+-> VideoFormat
+{
+	auto ext = dev::StrToUpper(dev::GetExt(_path));
+	if (ext == ".RGBA" || ext == ".RAW") return VideoFormat::RGBA;
+	if (ext == ".Y4M") return VideoFormat::Y4M;
+	if (ext == ".PNG") return VideoFormat::PNG;
+	return VideoFormat::NONE;
+}
+
+auto dev::Exporter::GetAudioFormat(const std::string& _path)
+-> AudioFormat
+{
+	auto ext = dev::StrToUpper(dev::GetExt(_path));
+	if (ext == ".WAV") return AudioFormat::WAV;
+	if (ext == ".RAW" || ext == ".F32") return AudioFormat::RAW;
+	return AudioFormat::NONE;
+}
+
+// Hardware thread
+// blocks when the workers fall behind to keep the memory usage limited
+void dev::Exporter::Push(const Display::FrameBuffer& _frame, const std::vector<float>& _samples)
+{
+	if (!m_inited || m_finished) return;
+
+	if (m_audioFormat != AudioFormat::NONE && !_samples.empty())
+	{
+		m_audioFile.write(reinterpret_cast<const char*>(_samples.data()), _samples.size() * sizeof(float));
+		m_samples += _samples.size();
+	}
+
+	if (m_videoFormat != VideoFormat::NONE)
+	{
+		auto frameP = std::make_unique<Display::FrameBuffer>(_frame);
+
+		std::unique_lock<std::mutex> mlock(m_jobsMutex);
+		m_doneCond.wait(mlock, [this] { return m_jobsInFlight < m_jobsMax; });
+		m_jobs.push_back({ m_frameIdx, std::move(frameP) });
+		m_jobsInFlight++;
+		mlock.unlock();
+		m_jobsCond.notify_one();
+	}
+
+	m_frameIdx++;
+}
+
+void dev::Exporter::Finish()
+{
+	if (m_finished) return;
+	m_finished = true;
+
+	{
+		std::unique_lock<std::mutex> mlock(m_jobsMutex);
+		m_exit = true;
+	}
+	m_jobsCond.notify_all();
+	for (auto& worker : m_workers) worker.join();
+	m_workers.clear();
+
+	if (m_audioFormat == AudioFormat::WAV && m_audioFile.is_open()) dev::WriteWavHeader(m_audioFile, m_samples, AUDIO_RATE);
+
+	m_videoFile.close();
+	m_audioFile.close();
+
+	if (m_inited) {
+		dev::Log("Exporter: frames: {}, audio samples: {}", m_frameIdx, m_samples);
+	}
+}
+
+// worker thread
+void dev::Exporter::Worker()
+{
+	while (true)
+	{
+		Job job;
+		{
+			std::unique_lock<std::mutex> mlock(m_jobsMutex);
+			m_jobsCond.wait(mlock, [this] { return m_exit || !m_jobs.empty(); });
+			if (m_jobs.empty()) return; // exit only when all jobs are done
+			job = std::move(m_jobs.front());
+			m_jobs.pop_front();
+		}
+
+		switch (m_videoFormat)
+		{
+		case VideoFormat::RGBA:
+			Write(job.frameIdx, EncodeRGBA(*job.frameP));
+			break;
+		case VideoFormat::Y4M:
+			Write(job.frameIdx, EncodeY4M(*job.frameP));
+			break;
+		case VideoFormat::PNG:
+		{
+			// every frame is a separate file, no ordering required
+			auto [dir, stem, ext] = dev::GetDirStemExt(m_videoPath);
+			auto path = std::format("{}{}{}_{:06}{}", dir, dir.empty() ? "" : "/", stem, job.frameIdx, ext);
+			if (!dev::SaveFile(path, EncodePNG(*job.frameP))) {
+				dev::Log("Exporter: failed to save the file: {}", path);
+			}
+			break;
+		}
+		default:
+			break;
+		}
+
+		{
+			std::unique_lock<std::mutex> mlock(m_jobsMutex);
+			m_jobsInFlight--;
+		}
+		m_doneCond.notify_one();
+	}
+}
+
+// writes the frames into the stream in the order they were pushed
+void dev::Exporter::Write(const uint64_t _frameIdx, std::vector<uint8_t>&& _data)
+{
+	std::unique_lock<std::mutex> mlock(m_writeMutex);
+	m_encoded.emplace(_frameIdx, std::move(_data));
+
+	for (auto it = m_encoded.find(m_frameWriteIdx); it != m_encoded.end(); it = m_encoded.find(m_frameWriteIdx))
+	{
+		m_videoFile.write(reinterpret_cast<const char*>(it->second.data()), it->second.size());
+		m_encoded.erase(it);
+		m_frameWriteIdx++;
+	}
+}
+
+// ColorI is stored as 0xAABBGGRR
+auto dev::Exporter::EncodeRGBA(const Display::FrameBuffer& _frame)
+-> std::vector<uint8_t>
+{
+	std::vector<uint8_t> out(Display::FRAME_LEN * sizeof(ColorI));
+	for (int i = 0; i < Display::FRAME_LEN; i++)
+	{
+		auto color = _frame[i];
+		out[i * 4 + 0] = color & 0xff;
+		out[i * 4 + 1] = (color >> 8) & 0xff;
+		out[i * 4 + 2] = (color >> 16) & 0xff;
+		out[i * 4 + 3] = (color >> 24) & 0xff;
+	}
+	return out;
+}
+
+// planar YCbCr 4:4:4, BT.601 studio range
+auto dev::Exporter::EncodeY4M(const Display::FrameBuffer& _frame)
+-> std::vector<uint8_t>
+{
+	static constexpr char FRAME_HEADER[] = "FRAME\n";
+	constexpr size_t headerLen = sizeof(FRAME_HEADER) - 1;
+
+	std::vector<uint8_t> out(headerLen + Display::FRAME_LEN * 3);
+	std::memcpy(out.data(), FRAME_HEADER, headerLen);
+	uint8_t* y = out.data() + headerLen;
+	uint8_t* u = y + Display::FRAME_LEN;
+	uint8_t* v = u + Display::FRAME_LEN;
+
+	for (int i = 0; i < Display::FRAME_LEN; i++)
+	{
+		int r = _frame[i] & 0xff;
+		int g = (_frame[i] >> 8) & 0xff;
+		int b = (_frame[i] >> 16) & 0xff;
+		y[i] = static_cast<uint8_t>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+		u[i] = static_cast<uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+		v[i] = static_cast<uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+	}
+	return out;
+}
+
+// 8-bit RGB PNG with uncompressed deflate blocks.
+// The encoding speed matters more than the file size here
+auto dev::Exporter::EncodePNG(const Display::FrameBuffer& _frame)
+-> std::vector<uint8_t>
+{
+	constexpr size_t rowLen = 1 + Display::FRAME_W * 3; // filter type + pixels
+	constexpr size_t rawLen = rowLen * Display::FRAME_H;
+	constexpr size_t blockMax = 0xffff;
+
+	// raw scanlines
+	std::vector<uint8_t> raw(rawLen);
+	for (int line = 0; line < Display::FRAME_H; line++)
+	{
+		uint8_t* rowP = raw.data() + line * rowLen;
+		*rowP++ = 0; // no filter
+		for (int x = 0; x < Display::FRAME_W; x++)
+		{
+			auto color = _frame[line * Display::FRAME_W + x];
+			*rowP++ = color & 0xff;
+			*rowP++ = (color >> 8) & 0xff;
+			*rowP++ = (color >> 16) & 0xff;
+		}
+	}
+
+	// zlib stream of stored blocks
+	std::vector<uint8_t> idat;
+	idat.reserve(rawLen + (rawLen / blockMax + 1) * 5 + 6);
+	idat.push_back(0x78);
+	idat.push_back(0x01);
+	uint32_t adlerA = 1;
+	uint32_t adlerB = 0;
+	for (size_t pos = 0; pos < rawLen; pos += blockMax)
+	{
+		uint16_t len = static_cast<uint16_t>(dev::Min(blockMax, rawLen - pos));
+		idat.push_back(pos + len >= rawLen ? 1 : 0); // BFINAL, BTYPE = 00
+		idat.push_back(len & 0xff);
+		idat.push_back(len >> 8);
+		idat.push_back(~len & 0xff);
+		idat.push_back((~len >> 8) & 0xff);
+		idat.insert(idat.end(), raw.begin() + pos, raw.begin() + pos + len);
+
+		for (size_t i = pos; i < pos + len; i++)
+		{
+			adlerA = (adlerA + raw[i]) % 65521;
+			adlerB = (adlerB + adlerA) % 65521;
+		}
+	}
+	PushU32BE(idat, adlerB << 16 | adlerA);
+
+	std::vector<uint8_t> ihdr;
+	PushU32BE(ihdr, Display::FRAME_W);
+	PushU32BE(ihdr, Display::FRAME_H);
+	ihdr.insert(ihdr.end(), { 8, 2, 0, 0, 0 }); // bit depth, color type RGB, compression, filter, interlace
+
+	std::vector<uint8_t> out = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+	out.reserve(idat.size() + 64);
+	PushChunk(out, "IHDR", ihdr);
+	PushChunk(out, "IDAT", idat);
+	PushChunk(out, "IEND", {});
+	return out;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <fstream>
+#include <deque>
+
+#include "utils/types.h"
+#include "core/display.h"
+#include "core/audio.h"
+#include "core/audio_sink.h"
+
+namespace dev
+{
+	// Writes the emulated output to files as fast as the Hardware thread produces it.
+	// Audio is written directly on the Hardware thread, frames are encoded on a pool of worker threads
+	class Exporter
+	{
+	public:
+		enum class VideoFormat : int { NONE = 0, RGBA, Y4M, PNG };
+		enum class AudioFormat : int { NONE = 0, WAV, RAW };
+
+		static constexpr int AUDIO_RATE = Audio::OUTPUT_RATE;
+		static constexpr int FRAME_RATE_NUM = 3000000;	// 3 MHz cpu clock
+		static constexpr int FRAME_RATE_DEN = 59904;	// cpu cycles per frame
+		static constexpr int JOBS_PER_WORKER = 2;		// limits the amount of frames waiting for encoding
+
+		Exporter(const std::string& _videoPath, const std::string& _audioPath, const int _workers = 0);
+		~Exporter();
+
+		// Hardware thread
+		void Push(const Display::FrameBuffer& _frame, const std::vector<float>& _samples);
+		void Finish();
+
+		auto GetFrames() const -> uint64_t { return m_frameIdx; };
+		auto GetSamples() const -> uint64_t { return m_samples; };
+		bool IsInited() const { return m_inited; };
+
+		static auto GetVideoFormat(const std::string& _path) -> VideoFormat;
+		static auto GetAudioFormat(const std::string& _path) -> AudioFormat;
+
+	private:
+		struct Job
+		{
+			uint64_t frameIdx = 0;
+			std::unique_ptr<Display::FrameBuffer> frameP;
+		};
+
+		VideoFormat m_videoFormat = VideoFormat::NONE;
+		AudioFormat m_audioFormat = AudioFormat::NONE;
+		std::string m_videoPath;
+		std::ofstream m_videoFile;
+		std::ofstream m_audioFile;
+		uint64_t m_frameIdx = 0;
+		uint64_t m_samples = 0;
+		bool m_inited = false;
+		bool m_finished = false;
+
+		std::vector<std::thread> m_workers;
+		std::deque<Job> m_jobs;
+		std::mutex m_jobsMutex;
+		std::condition_variable m_jobsCond;	// signals workers a new job or the exit
+		std::condition_variable m_doneCond;	// signals the Hardware thread there is space for a new job
+		size_t m_jobsInFlight = 0;
+		size_t m_jobsMax = 0;
+		bool m_exit = false;
+
+		std::mutex m_writeMutex;
+		std::map<uint64_t, std::vector<uint8_t>> m_encoded; // frames encoded out of order
+		uint64_t m_frameWriteIdx = 0; // the next frame to write into the stream
+
+		void Worker();
+		void Write(const uint64_t _frameIdx, std::vector<uint8_t>&& _data);
+
+		static auto EncodeRGBA(const Display::FrameBuffer& _frame) -> std::vector<uint8_t>;
+		static auto EncodeY4M(const Display::FrameBuffer& _frame) -> std::vector<uint8_t>;
+		static auto EncodePNG(const Display::FrameBuffer& _frame) -> std::vector<uint8_t>;
+	};
+}
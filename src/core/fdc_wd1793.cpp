@@ -461,4 +461,87 @@ auto dev::Fdc1793::GetFddImage(const int _driveIdx)
 	return { data, data + FDD_SIZE };
 }
 
-void dev::Fdc1793::ResetUpdate(const int _driveIdx) { m_disks[_driveIdx].updated = false; }
\ No newline at end of file
+void dev::Fdc1793::ResetUpdate(const int _driveIdx) { m_disks[_driveIdx].updated = false; }
+
+void dev::Fdc1793::StoreState(SaveState& _state) const
+{
+	memcpy(_state.regs, m_regs, sizeof(m_regs));
+	_state.drive = m_drive;
+	_state.side = m_side;
+	_state.track = m_track;
+	_state.lastS = m_lastS;
+	_state.irq = m_irq;
+	_state.wait = m_wait;
+	_state.cmd = m_cmd;
+	_state.rwLen = m_rwLen;
+	_state.diskIdx = m_disk ? static_cast<int>(m_disk - m_disks) : -1;
+
+	_state.ptrDiskIdx = -1;
+	_state.ptrOffset = 0;
+	_state.ptrInHeader = false;
+	for (int i = 0; i < DRIVES_MAX; i++)
+	{
+		auto& disk = m_disks[i];
+		memcpy(_state.headers[i], disk.header, HEADER_LEN);
+
+		if (m_ptr >= disk.data && m_ptr <= disk.data + FDD_SIZE) {
+			_state.ptrDiskIdx = i;
+			_state.ptrOffset = static_cast<int>(m_ptr - disk.data);
+		}
+		else if (m_ptr >= disk.header && m_ptr <= disk.header + HEADER_LEN) {
+			_state.ptrDiskIdx = i;
+			_state.ptrOffset = static_cast<int>(m_ptr - disk.header);
+			_state.ptrInHeader = true;
+		}
+	}
+}
+
+void dev::Fdc1793::RestoreState(const SaveState& _state)
+{
+	memcpy(m_regs, _state.regs, sizeof(m_regs));
+	m_drive = _state.drive;
+	m_side = _state.side;
+	m_track = _state.track;
+	m_lastS = _state.lastS;
+	m_irq = _state.irq;
+	m_wait = _state.wait;
+	m_cmd = _state.cmd;
+	m_rwLen = _state.rwLen;
+	m_disk = _state.diskIdx >= 0 ? &m_disks[_state.diskIdx % DRIVES_MAX] : nullptr;
+
+	for (int i = 0; i < DRIVES_MAX; i++) {
+		memcpy(m_disks[i].header, _state.headers[i], HEADER_LEN);
+	}
+
+	// the transfer left has to fit the buffer the data pointer points into
+	m_ptr = nullptr;
+	int len = _state.ptrDiskIdx < 0 ? 0 : _state.ptrInHeader ? HEADER_LEN : FDD_SIZE;
+	if (_state.ptrOffset < 0 || _state.ptrOffset > len || m_rwLen < 0 || m_rwLen > len - _state.ptrOffset)
+	{
+		dev::Log("FDC: the restored data pointer is out of the disk, the transfer is aborted");
+		m_rwLen = 0;
+		return;
+	}
+	if (_state.ptrDiskIdx >= 0)
+	{
+		auto& disk = m_disks[_state.ptrDiskIdx % DRIVES_MAX];
+		m_ptr = (_state.ptrInHeader ? disk.header : disk.data) + _state.ptrOffset;
+	}
+}
+
+auto dev::Fdc1793::GetFddData(const int _driveIdx) const
+-> const uint8_t*
+{
+	auto& disk = m_disks[_driveIdx % DRIVES_MAX];
+	return disk.mounted ? disk.data : nullptr;
+}
+
+void dev::Fdc1793::RestoreFdd(const int _driveIdx, const uint8_t* _dataP, const std::string& _path, const bool _updated)
+{
+	auto& disk = m_disks[_driveIdx % DRIVES_MAX];
+	disk.mounted = _dataP != nullptr;
+	disk.path = _path;
+	disk.updated = _updated;
+	disk.reads = disk.writes = 0;
+	if (_dataP) memcpy(disk.data, _dataP, FDD_SIZE);
+}
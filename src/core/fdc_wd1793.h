@@ -18,7 +18,7 @@ namespace dev
 		uint8_t data[FDD_SIZE];
 	public:
 
-		uint8_t header[6];		// current header, result of Seek()
+		uint8_t header[6];		// current header, result of Seek(). Fdc1793::HEADER_LEN
 		bool updated = false;
 		std::string path;
 		bool mounted = false;
@@ -67,6 +67,26 @@ namespace dev
 		};
 		
 		static constexpr int DRIVES_MAX = 4;
+		static constexpr int HEADER_LEN = 6;
+
+		// the controller part of the machine state to clone it. The disk images are stored separately
+		struct SaveState
+		{
+			uint8_t regs[5];
+			uint8_t drive;
+			uint8_t side;
+			uint8_t track;
+			uint8_t lastS;
+			uint8_t irq;
+			uint8_t wait;
+			uint8_t cmd;
+			int rwLen;
+			int diskIdx;		// the selected disk, -1 if none
+			int ptrDiskIdx;		// the disk the data pointer points into, -1 if none
+			int ptrOffset;		// the data pointer offset in the disk data or in the header
+			bool ptrInHeader;
+			uint8_t headers[DRIVES_MAX][HEADER_LEN];
+		};
 
 	private:
 		FDisk m_disks[DRIVES_MAX];
@@ -97,5 +117,10 @@ namespace dev
 		auto GetFddInfo(const int _driveIdx) -> DiskInfo;
 		auto GetFddImage(const int _driveIdx) -> const std::vector<uint8_t>;
 		void ResetUpdate(const int _driveIdx);
+		void StoreState(SaveState& _state) const;
+		void RestoreState(const SaveState& _state);
+		auto GetFddData(const int _driveIdx) const -> const uint8_t*;
+		// restores the disk image of FDD_SIZE bytes. _dataP = nullptr unmounts the drive. It doesn't touch the controller
+		void RestoreFdd(const int _driveIdx, const uint8_t* _dataP, const std::string& _path, const bool _updated);
 	};
 }
\ No newline at end of file
@@ -1,9 +1,35 @@
 #include "core/hardware.h"
 #include "utils/str_utils.h"
 #include "core/disasm.h"
-
+#include "core/save_state.h"
+
+// the save state section versions. Bump a version when the related state layout changes
+static constexpr uint16_t STATE_VER_CPU = 1;
+static constexpr uint16_t STATE_VER_MEMORY = 1;
+static constexpr uint16_t STATE_VER_IO = 1;
+static constexpr uint16_t STATE_VER_DISPLAY = 1;
+static constexpr uint16_t STATE_VER_SCHEDULER = 1;
+static constexpr uint16_t STATE_VER_TIMER = 1;
+static constexpr uint16_t STATE_VER_AY = 1;
+static constexpr uint16_t STATE_VER_AY_WRAPPER = 1;
+static constexpr uint16_t STATE_VER_KEYBOARD = 1;
+static constexpr uint16_t STATE_VER_FDC = 1;
+static constexpr uint16_t STATE_VER_FDD = 1;
+
+// the fdd section: the header, the path, and the disk image if mounted
+#pragma pack(push, 1)
+struct FddStateHeader
+{
+	uint8_t mounted;
+	uint8_t updated;
+	uint16_t pathLen;
+};
+#pragma pack(pop)
+
+// _threaded = false means no execution thread. The requests are executed by the caller thread then,
+// that lets the runners execute many instances on their own threads
 dev::Hardware::Hardware(const std::string& _pathBootData, 
-		const std::string& _pathRamDiskData, const bool _ramDiskClearAfterRestart)
+		const std::string& _pathRamDiskData, const bool _ramDiskClearAfterRestart, const bool _threaded)
 	:
 	m_status(Status::STOP),
 	m_memory(_pathBootData, _pathRamDiskData, _ramDiskClearAfterRestart),
@@ -13,19 +39,25 @@ dev::Hardware::Hardware(const std::string& _pathBootData,
 	m_aywrapper(m_ay),
 	m_audio(m_timer, m_aywrapper),
 	m_fdc(),
-	m_io(m_keyboard, m_memory, m_timer, m_ay, m_fdc),
+	m_io(m_keyboard, m_memory, m_timer, m_ay, m_fdc, m_scheduler),
 	m_cpu(
 		m_memory,
-		std::bind(&IO::PortIn, &m_io, std::placeholders::_1),
-		std::bind(&IO::PortOut, &m_io, std::placeholders::_1, std::placeholders::_2)),
-	m_display(m_memory, m_io)
+		[this](const uint8_t _port) { SyncDevices(); return m_io.PortIn(_port); },
+		[this](const uint8_t _port, const uint8_t _value) { SyncDevices(); m_io.PortOut(_port, _value); }),
+	m_display(m_memory, m_io, m_scheduler)
 {
+	// the rasterizer reads the screen memory, it has to catch up before the cpu changes it
+	m_memory.SetScreenWriteFunc([](void* _hardwareP) { static_cast<Hardware*>(_hardwareP)->SyncDevices(); }, this);
+
 	Init();
-	m_executionThread = std::thread(&Hardware::Execution, this);
+	PublishSnapshot();
+	if (_threaded) m_executionThread = std::thread(&Hardware::Execution, this);
 }
 
 dev::Hardware::~Hardware()
 {
+	if (!m_executionThread.joinable()) return;
+
 	Request(Hardware::Req::EXIT);
 	m_executionThread.join();
 }
@@ -33,40 +65,89 @@ dev::Hardware::~Hardware()
 // when HW needs Reset
 void dev::Hardware::Init()
 {
+	m_rasterLag = 0;
+	m_audioLag = 0;
 	m_memory.Init();
 	m_display.Init();
 	m_io.Init();
 }
 
+// re-registers the devices timed events from their states.
+// required when the states were changed outside of the execution
+void dev::Hardware::ScheduleEvents()
+{
+	m_display.ScheduleEvents();
+	m_io.ScheduleEvents();
+}
+
 
-void dev::Hardware::AttachDebugFuncs(DebugFunc _debugFunc, DebugReqHandlingFunc _debugReqHandlingFunc)
+void dev::Hardware::AttachDebugFuncs(DebugFunc _debugFunc, void* _debugContextP, DebugReqHandlingFunc _debugReqHandlingFunc)
 { 
 	Debug = _debugFunc;
+	m_debugContextP = _debugContextP;
 	DebugReqHandling = _debugReqHandlingFunc;
 }
 
+void dev::Hardware::AttachExportFunc(ExportFunc _exportFunc)
+{
+	Export = _exportFunc;
+}
+
+// the sink has to outlive the Hardware or be detached with nullptr.
+// without a sink the audio isn't mixed, the ay state is clocked anyway
+void dev::Hardware::AttachAudioSink(AudioSink* _sinkP)
+{
+	std::lock_guard<std::mutex> mlock(m_requestMutex);
+	Call(CmdSetAudioSink{ _sinkP });
+}
+
 // outputs true if the execution breaks
 bool dev::Hardware::ExecuteInstruction()
 {
 	// mem debug init
 	m_memory.DebugInit();
 
+	const auto& cpuState = m_cpu.GetState();
+	Addr pc = cpuState.regs.pc.word;
+	bool inte = cpuState.ints.inte;
+
 	do
 	{
-		m_display.Rasterize();
-		m_cpu.ExecuteMachineCycle(m_display.IsIRQ());
-		m_audio.Clock(2, m_io.GetBeeper());
+		// the cpu runs in bulk until the next event is due. The display and the audio
+		// catch up at the event, on the io access, and on the screen memory write
+		if (m_scheduler.IsDue((m_rasterLag + 1) * Display::RASTERIZED_PXLS_MAX))
+		{
+			SyncDevices();
+			m_display.Rasterize();
+			m_cpu.ExecuteMachineCycle(m_display.IsIRQ());
+			m_audio.Clock(2, m_io.GetBeeper());
+		}
+		else {
+			m_rasterLag++;
+			m_cpu.ExecuteMachineCycle(false);
+			m_audioLag += 2;
+		}
 
 	} while (!m_cpu.IsInstructionExecuted());
 
+	m_branches.Update(pc, inte, m_memory.GetState().debug.instrLen, cpuState);
+
+	if (m_cpu.GetCC() >= m_inputLogNextCC) {
+		SyncDevices();
+		InputLogUpdate();
+	}
+
+	// the debugger reads the raster position and the io state
+	if (m_debugAttached) SyncDevices();
+
 	// debug per instruction
-	if (m_debugAttached && Debug(m_cpu.GetStateP(), m_memory.GetStateP(), m_io.GetStateP(), m_display.GetStateP()) ) {
+	if (m_debugAttached && Debug(m_debugContextP, m_cpu.GetStateP(), m_memory.GetStateP(), m_io.GetStateP(), m_display.GetStateP()) ) {
 		return true;
 	}
 
 	if (m_memory.IsException())
 	{
-		dev::Log("ERROR: more than one Ram-disk has mapping enabled");
+		dev::Log("ERROR: more than one Ram-disk has mapping enabled. The last branches:\n{}", m_branches.ToString());
 		return true;
 	}
 
@@ -75,6 +156,21 @@ bool dev::Hardware::ExecuteInstruction()
 	return false;
 }
 
+// the display and the audio catch up with the cpu.
+// the rasterized blocks have no events due, so the rasterizer takes its fast path
+void dev::Hardware::SyncDevices()
+{
+	for (; m_rasterLag > 0; m_rasterLag--) {
+		m_display.Rasterize();
+	}
+
+	// the beeper only changes on the io access, so it's the same over the lag
+	if (m_audioLag > 0) {
+		m_audio.Clock(m_audioLag, m_io.GetBeeper());
+		m_audioLag = 0;
+	}
+}
+
 // TODO:
 // 1. reload, reset, update the palette, and other non-hardware-initiated operations have to reset the playback history
 // 2. navigation. show data as data in the disasm. take the list from the watchpoints
@@ -104,6 +200,8 @@ void dev::Hardware::Execution()
 
 			} while (m_status == Status::RUN && m_display.GetFrameNum() == frameNum);
 
+			PublishSnapshot();
+
 			// vsync
 			if (m_status == Status::RUN)
 			{
@@ -131,352 +229,694 @@ void dev::Hardware::Execution()
 	}
 }
 
-// UI thread. It return when the request fulfilled
+// UI thread. It returns when the command is fulfilled.
+// the caller has to hold m_requestMutex and read m_reply before releasing it
+void dev::Hardware::Call(Cmd&& _cmd)
+{
+	// no execution thread, the caller executes the command
+	if (!m_executionThread.joinable())
+	{
+		SyncDevices();
+		std::visit([this](auto& _cmd) { CmdHandling(_cmd); }, _cmd);
+		return;
+	}
+
+	auto replySeq = m_replySeq.load(std::memory_order_acquire);
+
+	// the callers are serialized and wait for the reply, so the ring can't be full
+	m_cmds.push(std::move(_cmd));
+	m_cmdsPending.fetch_add(1, std::memory_order_release);
+	m_cmdsPending.notify_one();
+
+	while (m_replySeq.load(std::memory_order_acquire) == replySeq) {
+		m_replySeq.wait(replySeq, std::memory_order_acquire);
+	}
+}
+
+// UI thread. The JSON adapter for the requests without a typed form
 auto dev::Hardware::Request(const Req _req, const nlohmann::json& _dataJ)
 -> Result<nlohmann::json>
 {
-	m_reqs.push({ _req, _dataJ });
-	return m_reqRes.pop();
+	std::lock_guard<std::mutex> mlock(m_requestMutex);
+	Call(CmdJson{ _req, _dataJ });
+	return std::move(m_reply.dataJ);
 }
 
-// internal thread
-void dev::Hardware::ReqHandling(const bool _waitReq)
+auto dev::Hardware::RequestCC()
+-> uint64_t
 {
-	if (!m_reqs.empty() || _waitReq)
-	{        
-		auto result = m_reqs.pop();
+	std::lock_guard<std::mutex> mlock(m_requestMutex);
+	Call(CmdGetCC{});
+	return m_reply.data;
+}
 
-		const auto& [req, dataJ] = *result;
+auto dev::Hardware::RequestCpuState()
+-> CpuI8080::State
+{
+	std::lock_guard<std::mutex> mlock(m_requestMutex);
+	Call(CmdGetCpuState{});
+	return m_reply.cpuState;
+}
 
-		nlohmann::json out;
+auto dev::Hardware::RequestByte(const Addr _addr, const Memory::AddrSpace _addrSpace)
+-> uint8_t
+{
+	std::lock_guard<std::mutex> mlock(m_requestMutex);
+	Call(CmdGetByte{ _addr, _addrSpace });
+	return static_cast<uint8_t>(m_reply.data);
+}
 
-		switch (req)
-		{
-		case Req::RUN:
-			Run();
-			break;
+auto dev::Hardware::Request3Bytes(const Addr _addr, const Memory::AddrSpace _addrSpace)
+-> uint32_t
+{
+	std::lock_guard<std::mutex> mlock(m_requestMutex);
+	Call(CmdGet3Bytes{ _addr, _addrSpace });
+	return static_cast<uint32_t>(m_reply.data);
+}
 
-		case Req::STOP:
-			Stop();
-			break;
+auto dev::Hardware::RequestWord(const Addr _addr, const Memory::AddrSpace _addrSpace)
+-> uint16_t
+{
+	std::lock_guard<std::mutex> mlock(m_requestMutex);
+	Call(CmdGetWord{ _addr, _addrSpace });
+	return static_cast<uint16_t>(m_reply.data);
+}
 
-		case Req::IS_RUNNING:
-			out = {
-				{"isRunning", m_status == Status::RUN},
-				};
-			break;
+auto dev::Hardware::RequestGlobalAddr(const Addr _addr, const Memory::AddrSpace _addrSpace)
+-> GlobalAddr
+{
+	std::lock_guard<std::mutex> mlock(m_requestMutex);
+	Call(CmdGetGlobalAddr{ _addr, _addrSpace });
+	return static_cast<GlobalAddr>(m_reply.data);
+}
 
-		case Req::EXIT:
-			m_status = Status::EXIT;
-			break;
+auto dev::Hardware::RequestByteGlobal(const GlobalAddr _globalAddr)
+-> uint8_t
+{
+	std::lock_guard<std::mutex> mlock(m_requestMutex);
+	Call(CmdGetByteGlobal{ _globalAddr });
+	return static_cast<uint8_t>(m_reply.data);
+}
 
-		case Req::RESET:
-			Reset();
-			break;
+// UI thread. Copies _len bytes of the cpu-mapped memory starting from _addr into _dstP
+// in one round trip. The addr wraps around 64K, _len is clamped to 64K.
+// It returns the mapping used for the copy, so the caller can convert the addrs to global addrs
+auto dev::Hardware::RequestMemRange(uint8_t* _dstP, const Addr _addr, const size_t _len,
+	const Memory::AddrSpace _addrSpace)
+-> Memory::Update
+{
+	std::lock_guard<std::mutex> mlock(m_requestMutex);
+	Call(CmdGetMemRange{ _dstP, _addr, _len, _addrSpace });
+	return m_reply.memUpdate;
+}
 
-		case Req::RESTART:
-			Restart();
-			break;
+// UI thread. Copies _len bytes of the global memory starting from _globalAddr into _dstP.
+// The range is clamped to the global memory
+auto dev::Hardware::RequestMemRangeGlobal(uint8_t* _dstP, const GlobalAddr _globalAddr, const size_t _len)
+-> Memory::Update
+{
+	std::lock_guard<std::mutex> mlock(m_requestMutex);
+	Call(CmdGetMemRangeGlobal{ _dstP, _globalAddr, _len });
+	return m_reply.memUpdate;
+}
 
-		case Req::EXECUTE_INSTR:
-			ExecuteInstruction();
-			break;
+// UI thread. Stores the complete machine state including the mounted disk images
+auto dev::Hardware::RequestSaveState(const bool _compress)
+-> std::vector<uint8_t>
+{
+	std::vector<uint8_t> out;
+	std::lock_guard<std::mutex> mlock(m_requestMutex);
+	Call(CmdSaveState{ &out, _compress });
+	return out;
+}
 
-		case Req::EXECUTE_FRAME_NO_BREAKS:
-		{
-			ExecuteFrameNoBreaks();
-			break;
-		}
-		case Req::GET_CC:
-			out = {
-				{"cc", m_cpu.GetCC() },
-				};
-			break;
+// UI thread. Returns false and keeps the current state if the data is invalid or incompatible
+auto dev::Hardware::RequestLoadState(const std::vector<uint8_t>& _data)
+-> bool
+{
+	std::lock_guard<std::mutex> mlock(m_requestMutex);
+	Call(CmdLoadState{ &_data });
+	return m_reply.data != 0;
+}
 
-		case Req::GET_REGS:
-			out = GetRegs();
-			break;
+// internal thread
+// the hot path is a single atomic load when there is no pending command
+void dev::Hardware::ReqHandling(const bool _waitReq)
+{
+	if (m_cmdsPending.load(std::memory_order_acquire) == 0)
+	{
+		if (!_waitReq) return;
+		m_cmdsPending.wait(0, std::memory_order_acquire);
+	}
 
-		case Req::GET_REG_PC:
-			out = {
-				{"pc", m_cpu.GetPC() },
-				};
-			break;
+	Cmd cmd;
+	while (m_cmds.pop(cmd))
+	{
+		// decremented before the handling because the handling can execute instructions
+		// that call ReqHandling recursively
+		m_cmdsPending.fetch_sub(1, std::memory_order_acq_rel);
 
-		case Req::GET_RUSLAT_HISTORY:
-			out = {
-				{"data", m_io.GetRusLatHistory()},
-				};
-			break;
+		SyncDevices();
+		std::visit([this](auto& _cmd) { CmdHandling(_cmd); }, cmd);
 
-		case Req::GET_IO_PALETTE:
-		{
-			auto data = m_io.GetPalette();
-			out = {
-				{"low", data->low},
-				{"hi", data->hi},
-				};
-			break;
-		}
-		case Req::GET_IO_PORTS:
-		{
-			auto data = m_io.GetPorts();
-			out = {
-				{"data", data->data},
-				};
-			break;
-		}
+		m_replySeq.fetch_add(1, std::memory_order_release);
+		m_replySeq.notify_all();
+	}
+}
 
-		case Req::GET_IO_PALETTE_COMMIT_TIME:
-		{
-			auto data = m_io.GetPaletteCommitTime();
-			out = {
-				{"paletteCommitTime", data},
-				};
-			break;
-		}
+void dev::Hardware::CmdHandling(CmdJson& _cmd)
+{
+	auto cc = m_cpu.GetCC();
+	m_reply.dataJ = ReqJsonHandling(_cmd.req, _cmd.dataJ);
 
-		case Req::SET_IO_PALETTE_COMMIT_TIME:
+	// steps, resets, memory edits, and the recorder restores change the state while stopped
+	if (m_status == Status::STOP)
+	{
+		PublishSnapshot();
+		// the debugger publishes the last reads and writes once a frame, a step doesn't reach the next one
+		if (m_debugAttached && cc != m_cpu.GetCC())
 		{
-			m_io.SetPaletteCommitTime(dataJ["paletteCommitTime"]);
-			break;
+			DebugReqHandling(Req::DEBUG_PUBLISH_LAST_RW, {},
+				m_cpu.GetStateP(), m_memory.GetStateP(), m_io.GetStateP(), m_display.GetStateP());
 		}
+	}
+}
 
-		case Req::GET_DISPLAY_BORDER_LEFT:
-		{
-			auto data = m_display.GetBorderLeft();
-			out = {
-				{"borderLeft", data},
-				};
-			break;
-		}
+// Hardware thread. It is the only writer of the snapshot
+void dev::Hardware::PublishSnapshot()
+{
+	SyncDevices();
 
-		case Req::SET_DISPLAY_BORDER_LEFT:
-		{
-			m_display.SetBorderLeft(dataJ["borderLeft"]);
-			break;
-		}
+	Snapshot snapshot;
 
-		case Req::GET_DISPLAY_IRQ_COMMIT_PXL:
-		{
-			auto data = m_display.GetIrqCommitPxl();
-			out = {
-				{"irqCommitPxl", data},
-				};
-			break;
-		}
+	snapshot.cpuState = m_cpu.GetState();
 
-		case Req::SET_DISPLAY_IRQ_COMMIT_PXL:
-		{
-			m_display.SetIrqCommitPxl(dataJ["irqCommitPxl"]);
-			break;
-		}
+	Addr sp = m_cpu.GetSP();
+	for (int i = 0; i < STACK_SAMPLE_LEN; i++)
+	{
+		Addr addr = sp + (i - STACK_SAMPLE_LEN / 2) * 2;
+		snapshot.stack[i] = m_memory.GetByte(addr + 1, Memory::AddrSpace::STACK) << 8 |
+			m_memory.GetByte(addr, Memory::AddrSpace::STACK);
+	}
 
-		case Req::GET_IO_DISPLAY_MODE:
-			out = {
-				{"data", m_io.GetDisplayMode()},
-				};
-			break;
+	snapshot.frameNum = m_display.GetFrameNum();
+	snapshot.rasterLine = m_display.GetRasterLine();
+	snapshot.rasterPixel = m_display.GetRasterPixel();
+	snapshot.scrollVert = m_display.GetScrollVert();
+	snapshot.displayMode = m_io.GetDisplayMode();
 
-		case Req::GET_BYTE_GLOBAL:
-			out = GetByteGlobal(dataJ);
-			break;
+	snapshot.mapping = m_memory.GetState().update.mapping;
+	snapshot.ramdiskIdx = m_memory.GetState().update.ramdiskIdx;
 
-		case Req::GET_BYTE_RAM:
-			out = GetByte(dataJ, Memory::AddrSpace::RAM);
-			break;
+	snapshot.palette = *m_io.GetPalette();
+	snapshot.portsInData = *m_io.GetPortsInData();
+	snapshot.portsOutData = *m_io.GetPortsOutData();
 
-		case Req::GET_THREE_BYTES_RAM:
-			out = Get3Bytes(dataJ, Memory::AddrSpace::RAM);
-			break;
+	snapshot.fdcInfo = m_fdc.GetFdcInfo();
+	for (int driveIdx = 0; driveIdx < Fdc1793::DRIVES_MAX; driveIdx++)
+	{
+		auto info = m_fdc.GetFddInfo(driveIdx);
+		auto& fdd = snapshot.fddInfo[driveIdx];
+		info.path.copy(fdd.path, FDD_PATH_LEN - 1);
+		fdd.reads = info.reads;
+		fdd.writes = info.writes;
+		fdd.updated = info.updated;
+		fdd.mounted = info.mounted;
+	}
 
-		case Req::GET_WORD_STACK:
-			out = GetWord(dataJ, Memory::AddrSpace::STACK);
-			break;
+	m_snapshot.store(snapshot);
+}
 
-		case Req::GET_STACK_SAMPLE:
-			out = GetStackSample(dataJ);
-			break;
+void dev::Hardware::CmdHandling(const CmdGetCC&)
+{
+	m_reply.data = m_cpu.GetCC();
+}
 
-		case Req::GET_DISPLAY_DATA:
-			out = {
-				{"rasterLine", m_display.GetRasterLine()},
-				{"rasterPixel", m_display.GetRasterPixel()},
-				{"frameNum", m_display.GetFrameNum()},
-				};
-			break;
+void dev::Hardware::CmdHandling(const CmdGetCpuState&)
+{
+	m_reply.cpuState = m_cpu.GetState();
+}
 
-		case Req::GET_MEMORY_MAPPING:
-			out = {
-				{"mapping", m_memory.GetState().update.mapping.data},
-				{"ramdiskIdx", m_memory.GetState().update.ramdiskIdx},
-				};
-			break;
+void dev::Hardware::CmdHandling(const CmdGetByte& _cmd)
+{
+	m_reply.data = m_memory.GetByte(_cmd.addr, _cmd.addrSpace);
+}
 
-		case Req::GET_MEMORY_MAPPINGS:{
-			auto mappingsP = m_memory.GetMappingsP();
-			out = {{"ramdiskIdx", m_memory.GetState().update.ramdiskIdx}};
-			for (auto i=0; i < Memory::RAM_DISK_MAX; i++) {
-				out["mapping"+std::to_string(i)] = mappingsP[i].data;
-			}
-			break;
-		}
-		case Req::GET_GLOBAL_ADDR_RAM:
-			out = {
-				{"data", m_memory.GetGlobalAddr(dataJ["addr"], Memory::AddrSpace::RAM)}
-				};
-			break;
+void dev::Hardware::CmdHandling(const CmdGet3Bytes& _cmd)
+{
+	m_reply.data = m_memory.GetByte(_cmd.addr, _cmd.addrSpace) |
+		m_memory.GetByte(_cmd.addr + 1, _cmd.addrSpace) << 8 |
+		m_memory.GetByte(_cmd.addr + 2, _cmd.addrSpace) << 16;
+}
 
-		case Req::GET_FDC_INFO: {
-			auto info = m_fdc.GetFdcInfo();
-			out = {
-				{"drive", info.drive},
-				{"side", info.side},
-				{"track", info.track},
-				{"lastS", info.lastS},
-				{"wait", info.irq},
-				{"cmd", info.cmd},
-				{"rwLen", info.rwLen},
-				{"position", info.position},
-				};
-			break;
-		}
+void dev::Hardware::CmdHandling(const CmdGetWord& _cmd)
+{
+	m_reply.data = m_memory.GetByte(_cmd.addr + 1, _cmd.addrSpace) << 8 | m_memory.GetByte(_cmd.addr, _cmd.addrSpace);
+}
 
-		case Req::GET_FDD_INFO: {
-			auto info = m_fdc.GetFddInfo(dataJ["driveIdx"]);
-			out = {
-				{"path", info.path},
-				{"updated", info.updated},
-				{"reads", info.reads},
-				{"writes", info.writes},
-				{"mounted", info.mounted},
-				};
-			break;
-		}
-		
-		case Req::GET_FDD_IMAGE:
-			out = {
-				{"data", m_fdc.GetFddImage(dataJ["driveIdx"])},
-				};
-			break;
+void dev::Hardware::CmdHandling(const CmdGetGlobalAddr& _cmd)
+{
+	m_reply.data = m_memory.GetGlobalAddr(_cmd.addr, _cmd.addrSpace);
+}
 
-		case Req::GET_STEP_OVER_ADDR:
-			out = {
-				{"data", GetStepOverAddr()},
-				};
-			break;
+void dev::Hardware::CmdHandling(const CmdGetByteGlobal& _cmd)
+{
+	m_reply.data = m_memory.GetRam()->at(_cmd.globalAddr);
+}
 
-		case Req::GET_IO_PORTS_IN_DATA:
-		{
-			auto portsData = m_io.GetPortsInData();
-			out = {
-				{"data0", portsData->data0},
-				{"data1", portsData->data1},
-				{"data2", portsData->data2},
-				{"data3", portsData->data3},
-				{"data4", portsData->data4},
-				{"data5", portsData->data5},
-				{"data6", portsData->data6},
-				{"data7", portsData->data7},
-				};
-			break;
-		}
-		case Req::GET_IO_PORTS_OUT_DATA:
-		{
-			auto portsData = m_io.GetPortsOutData();
-			out = {
-				{"data0", portsData->data0},
-				{"data1", portsData->data1},
-				{"data2", portsData->data2},
-				{"data3", portsData->data3},
-				{"data4", portsData->data4},
-				{"data5", portsData->data5},
-				{"data6", portsData->data6},
-				{"data7", portsData->data7},
-				};
-			break;
-		}
-		case Req::SET_MEM:
-			m_memory.SetRam(dataJ["addr"], dataJ["data"]);
-			break;
+void dev::Hardware::CmdHandling(const CmdSetAudioSink& _cmd)
+{
+	m_audio.SetSink(_cmd.sinkP);
+	m_audio.Pause(m_status != Status::RUN);
+}
 
-		case Req::SET_BYTE_GLOBAL:
-			m_memory.SetByteGlobal(dataJ["addr"], dataJ["data"]);
-			break;
+void dev::Hardware::CmdHandling(const CmdSaveState& _cmd)
+{
+	*_cmd.dstP = SerializeState(_cmd.compress);
+}
 
-		case Req::SET_CPU_SPEED:
-		{
-			int speed = dataJ["speed"];
-			speed = std::clamp(speed, 0, int(sizeof(m_execDelays) - 1));
-			m_execSpeed = static_cast<ExecSpeed>(speed);
-			if (m_execSpeed == ExecSpeed::_20PERCENT) { m_audio.Mute(true); }
-			else { m_audio.Mute(false); }
-			break;
-		}
+void dev::Hardware::CmdHandling(const CmdLoadState& _cmd)
+{
+	m_reply.data = DeserializeState(*_cmd.srcP);
+	if (m_status == Status::STOP) PublishSnapshot();
+}
 
-		case Req::GET_HW_MAIN_STATS:
-		{
-			auto paletteP = m_io.GetPalette();
-
-			out = {{"cc", m_cpu.GetCC()},
-				{"rasterLine", m_display.GetRasterLine()},
-				{"rasterPixel", m_display.GetRasterPixel()},
-				{"frameCc", (m_display.GetRasterPixel() + m_display.GetRasterLine() * Display::FRAME_W) / 4},
-				{"frameNum", m_display.GetFrameNum()},
-				{"displayMode", m_io.GetDisplayMode()},
-				{"scrollVert", m_display.GetScrollVert()},
-				{"rusLat", (m_io.GetRusLatHistory() & 0b1000) != 0},
-				{"inte", m_cpu.GetState().ints.inte},
-				{"iff", m_cpu.GetState().ints.iff},
-				{"hlta", m_cpu.GetState().ints.hlta},
-				};
-				for (int i=0; i < IO::PALETTE_LEN; i++ ){
-					out["palette"+std::to_string(i)] = Display::VectorColorToArgb(paletteP->bytes[i]);
-				}
-			break;
-		}
-		case Req::IS_MEMROM_ENABLED:
-			out = {
-				{"data", m_memory.IsRomEnabled() },
-				};
-			break;             
+void dev::Hardware::CmdHandling(const CmdGetMemRange& _cmd)
+{
+	auto len = dev::Min(_cmd.len, Memory::MEM_64K);
+	for (size_t i = 0; i < len; i++)
+	{
+		_cmd.dstP[i] = m_memory.GetByte(static_cast<Addr>(_cmd.addr + i), _cmd.addrSpace);
+	}
+	m_reply.memUpdate = m_memory.GetState().update;
+}
 
-		case Req::KEY_HANDLING:
-		{
-			auto op = m_io.GetKeyboard().KeyHandling(dataJ["scancode"], dataJ["action"]);
-			if (op == Keyboard::Operation::RESET) {
-				Reset();
-			}
-			else if (op == Keyboard::Operation::RESTART) {
-				Restart();
-			}
-		}
-			break;
+void dev::Hardware::CmdHandling(const CmdGetMemRangeGlobal& _cmd)
+{
+	if (_cmd.globalAddr < Memory::MEMORY_GLOBAL_LEN)
+	{
+		auto len = dev::Min(_cmd.len, Memory::MEMORY_GLOBAL_LEN - _cmd.globalAddr);
+		auto memP = m_memory.GetRam()->data() + _cmd.globalAddr;
+		std::copy(memP, memP + len, _cmd.dstP);
+	}
+	m_reply.memUpdate = m_memory.GetState().update;
+}
 
-		case Req::GET_SCROLL_VERT:
-			out = {
-				{"scrollVert", m_display.GetScrollVert()}
-				};
-			break;
+auto dev::Hardware::ReqJsonHandling(const Req _req, const nlohmann::json& _dataJ)
+-> nlohmann::json
+{
+	nlohmann::json out;
 
-		case Req::LOAD_FDD:
-			m_fdc.Mount(dataJ["driveIdx"], dataJ["data"], dataJ["path"]);
-			break;
+	switch (_req)
+	{
+	case Req::RUN:
+		Run();
+		break;
+
+	case Req::STOP:
+		Stop();
+		break;
+
+	case Req::IS_RUNNING:
+		out = {
+			{"isRunning", m_status == Status::RUN},
+			};
+		break;
+
+	case Req::EXIT:
+		m_status = Status::EXIT;
+		break;
+
+	case Req::RESET:
+		m_inputLog.AddEvent(m_cpu.GetCC(), InputLog::EventType::RESET);
+		Reset();
+		break;
+
+	case Req::RESTART:
+		m_inputLog.AddEvent(m_cpu.GetCC(), InputLog::EventType::RESTART);
+		Restart();
+		break;
+
+	case Req::EXECUTE_INSTR:
+		ExecuteInstruction();
+		break;
 
-		case Req::RESET_UPDATE_FDD:
-			m_fdc.ResetUpdate(dataJ["driveIdx"]);
-			break;
+	case Req::EXECUTE_FRAME_NO_BREAKS:
+	{
+		ExecuteFrameNoBreaks();
+		break;
+	}
+	case Req::EXPORT_FRAMES:
+		out = {
+			{"frames", ExportFrames(_dataJ["frames"])},
+			};
+		break;
+
+	case Req::EXECUTE_UNTIL:
+		out = ExecuteUntil(_dataJ.value("frames", 0ull), _dataJ.value("pc", -1), _dataJ.value("cc", 0ull));
+		break;
+
+	case Req::GET_CC:
+		out = {
+			{"cc", m_cpu.GetCC() },
+			};
+		break;
+
+	case Req::GET_REGS:
+		out = GetRegs();
+		break;
+
+	case Req::GET_REG_PC:
+		out = {
+			{"pc", m_cpu.GetPC() },
+			};
+		break;
+
+	case Req::GET_RUSLAT_HISTORY:
+		out = {
+			{"data", m_io.GetRusLatHistory()},
+			};
+		break;
+
+	case Req::GET_IO_PALETTE:
+	{
+		auto data = m_io.GetPalette();
+		out = {
+			{"low", data->low},
+			{"hi", data->hi},
+			};
+		break;
+	}
+	case Req::GET_IO_PORTS:
+	{
+		auto data = m_io.GetPorts();
+		out = {
+			{"data", data->data},
+			};
+		break;
+	}
 
-		case Req::DEBUG_ATTACH:
-			m_debugAttached = dataJ["data"];
-			break;
+	case Req::GET_IO_PALETTE_COMMIT_TIME:
+	{
+		auto data = m_io.GetPaletteCommitTime();
+		out = {
+			{"paletteCommitTime", data},
+			};
+		break;
+	}
+
+	case Req::SET_IO_PALETTE_COMMIT_TIME:
+	{
+		m_io.SetPaletteCommitTime(_dataJ["paletteCommitTime"]);
+		break;
+	}
+
+	case Req::GET_DISPLAY_BORDER_LEFT:
+	{
+		auto data = m_display.GetBorderLeft();
+		out = {
+			{"borderLeft", data},
+			};
+		break;
+	}
+
+	case Req::SET_DISPLAY_BORDER_LEFT:
+	{
+		m_display.SetBorderLeft(_dataJ["borderLeft"]);
+		break;
+	}
+
+	case Req::GET_DISPLAY_IRQ_COMMIT_PXL:
+	{
+		auto data = m_display.GetIrqCommitPxl();
+		out = {
+			{"irqCommitPxl", data},
+			};
+		break;
+	}
+
+	case Req::SET_DISPLAY_IRQ_COMMIT_PXL:
+	{
+		m_display.SetIrqCommitPxl(_dataJ["irqCommitPxl"]);
+		break;
+	}
+
+	case Req::GET_IO_DISPLAY_MODE:
+		out = {
+			{"data", m_io.GetDisplayMode()},
+			};
+		break;
+
+	case Req::GET_BYTE_GLOBAL:
+		out = GetByteGlobal(_dataJ);
+		break;
+
+	case Req::GET_BYTE_RAM:
+		out = GetByte(_dataJ, Memory::AddrSpace::RAM);
+		break;
+
+	case Req::GET_THREE_BYTES_RAM:
+		out = Get3Bytes(_dataJ, Memory::AddrSpace::RAM);
+		break;
+
+	case Req::GET_WORD_STACK:
+		out = GetWord(_dataJ, Memory::AddrSpace::STACK);
+		break;
+
+	case Req::GET_STACK_SAMPLE:
+		out = GetStackSample(_dataJ);
+		break;
+
+	case Req::GET_DISPLAY_DATA:
+		out = {
+			{"rasterLine", m_display.GetRasterLine()},
+			{"rasterPixel", m_display.GetRasterPixel()},
+			{"frameNum", m_display.GetFrameNum()},
+			};
+		break;
+
+	case Req::GET_MEMORY_MAPPING:
+		out = {
+			{"mapping", m_memory.GetState().update.mapping.data},
+			{"ramdiskIdx", m_memory.GetState().update.ramdiskIdx},
+			};
+		break;
+
+	case Req::GET_MEMORY_MAPPINGS:{
+		auto mappingsP = m_memory.GetMappingsP();
+		out = {{"ramdiskIdx", m_memory.GetState().update.ramdiskIdx}};
+		for (size_t i=0; i < Memory::RAM_DISK_MAX; i++) {
+			out["mapping"+std::to_string(i)] = mappingsP[i].data;
+		}
+		break;
+	}
+	case Req::GET_GLOBAL_ADDR_RAM:
+		out = {
+			{"data", m_memory.GetGlobalAddr(_dataJ["addr"], Memory::AddrSpace::RAM)}
+			};
+		break;
+
+	case Req::GET_FDC_INFO: {
+		auto info = m_fdc.GetFdcInfo();
+		out = {
+			{"drive", info.drive},
+			{"side", info.side},
+			{"track", info.track},
+			{"lastS", info.lastS},
+			{"wait", info.irq},
+			{"cmd", info.cmd},
+			{"rwLen", info.rwLen},
+			{"position", info.position},
+			};
+		break;
+	}
+
+	case Req::GET_FDD_INFO: {
+		auto info = m_fdc.GetFddInfo(_dataJ["driveIdx"]);
+		out = {
+			{"path", info.path},
+			{"updated", info.updated},
+			{"reads", info.reads},
+			{"writes", info.writes},
+			{"mounted", info.mounted},
+			};
+		break;
+	}
+	
+	case Req::GET_FDD_IMAGE:
+		out = {
+			{"data", m_fdc.GetFddImage(_dataJ["driveIdx"])},
+			};
+		break;
+
+	case Req::GET_STEP_OVER_ADDR:
+		out = {
+			{"data", GetStepOverAddr()},
+			};
+		break;
+
+	case Req::GET_IO_PORTS_IN_DATA:
+	{
+		auto portsData = m_io.GetPortsInData();
+		out = {
+			{"data0", portsData->data0},
+			{"data1", portsData->data1},
+			{"data2", portsData->data2},
+			{"data3", portsData->data3},
+			{"data4", portsData->data4},
+			{"data5", portsData->data5},
+			{"data6", portsData->data6},
+			{"data7", portsData->data7},
+			};
+		break;
+	}
+	case Req::GET_IO_PORTS_OUT_DATA:
+	{
+		auto portsData = m_io.GetPortsOutData();
+		out = {
+			{"data0", portsData->data0},
+			{"data1", portsData->data1},
+			{"data2", portsData->data2},
+			{"data3", portsData->data3},
+			{"data4", portsData->data4},
+			{"data5", portsData->data5},
+			{"data6", portsData->data6},
+			{"data7", portsData->data7},
+			};
+		break;
+	}
+	case Req::SET_MEM:
+	{
+		std::vector<uint8_t> data = _dataJ["data"];
+		m_inputLog.AddPayloadEvent(m_cpu.GetCC(), InputLog::EventType::SET_MEM, _dataJ["addr"], data);
+		m_memory.SetRam(_dataJ["addr"], data);
+		break;
+	}
+
+	case Req::SET_BYTE_GLOBAL:
+		m_memory.SetByteGlobal(_dataJ["addr"], _dataJ["data"]);
+		break;
+
+	case Req::SET_CPU_SPEED:
+	{
+		int speed = _dataJ["speed"];
+		speed = std::clamp(speed, 0, int(sizeof(m_execDelays) - 1));
+		m_execSpeed = static_cast<ExecSpeed>(speed);
+		if (m_execSpeed == ExecSpeed::_20PERCENT) { m_audio.Mute(true); }
+		else { m_audio.Mute(false); }
+		break;
+	}
 
-		default:
-			out = DebugReqHandling(req, dataJ, m_cpu.GetStateP(), m_memory.GetStateP(), m_io.GetStateP(), m_display.GetStateP());
+	case Req::GET_HW_MAIN_STATS:
+	{
+		auto paletteP = m_io.GetPalette();
+
+		out = {{"cc", m_cpu.GetCC()},
+			{"rasterLine", m_display.GetRasterLine()},
+			{"rasterPixel", m_display.GetRasterPixel()},
+			{"frameCc", (m_display.GetRasterPixel() + m_display.GetRasterLine() * Display::FRAME_W) / 4},
+			{"frameNum", m_display.GetFrameNum()},
+			{"displayMode", m_io.GetDisplayMode()},
+			{"scrollVert", m_display.GetScrollVert()},
+			{"rusLat", (m_io.GetRusLatHistory() & 0b1000) != 0},
+			{"inte", m_cpu.GetState().ints.inte},
+			{"iff", m_cpu.GetState().ints.iff},
+			{"hlta", m_cpu.GetState().ints.hlta},
+			};
+			for (int i=0; i < IO::PALETTE_LEN; i++ ){
+				out["palette"+std::to_string(i)] = Display::VectorColorToArgb(paletteP->bytes[i]);
+			}
+		break;
+	}
+	case Req::GET_BRANCHES:
+	{
+		nlohmann::json branchesJ = nlohmann::json::array();
+		for (const auto& branch : m_branches.Get())
+		{
+			branchesJ.push_back({ branch.cc, branch.from, branch.to, branch.opcode, branch.irq, branch.repeats });
 		}
+		out = { {"branches", branchesJ} };
+		break;
+	}
+	case Req::IS_MEMROM_ENABLED:
+		out = {
+			{"data", m_memory.IsRomEnabled() },
+			};
+		break;             
+
+	case Req::KEY_HANDLING:
+		// the replay owns the keyboard
+		if (m_inputLog.GetMode() == InputLog::Mode::PLAY) break;
+
+		m_inputLog.AddKey(m_cpu.GetCC(), _dataJ["scancode"], _dataJ["action"]);
+		KeyHandling(_dataJ["scancode"], _dataJ["action"]);
+		break;
+
+	case Req::GET_SCROLL_VERT:
+		out = {
+			{"scrollVert", m_display.GetScrollVert()}
+			};
+		break;
+
+	case Req::LOAD_FDD:
+	{
+		std::vector<uint8_t> data = _dataJ["data"];
+		m_inputLog.AddPayloadEvent(m_cpu.GetCC(), InputLog::EventType::LOAD_FDD, _dataJ["driveIdx"], data, _dataJ["path"]);
+		m_fdc.Mount(_dataJ["driveIdx"], data, _dataJ["path"]);
+		break;
+	}
+	case Req::INPUT_LOG_RECORD:
+		m_inputLog.StartRecording(SerializeState(true), m_cpu.GetCC());
+		m_inputLogNextCC = m_inputLog.GetNextCC();
+		break;
 
-		m_reqRes.emplace(std::move(out));
+	case Req::INPUT_LOG_STOP:
+	{
+		bool recording = m_inputLog.GetMode() == InputLog::Mode::RECORD;
+		m_inputLog.StopRecording(m_cpu.GetCC());
+		m_inputLog.Stop();
+		m_inputLogNextCC = InputLog::CC_NONE;
+		if (recording) out = { {"data", nlohmann::json::binary(m_inputLog.Serialize())} };
+		break;
 	}
+	case Req::INPUT_LOG_PLAY:
+	{
+		nlohmann::json::binary_t binaryData = _dataJ["data"].get<nlohmann::json::binary_t>();
+		std::vector<uint8_t> data(binaryData.begin(), binaryData.end());
+
+		bool loaded = m_inputLog.StartPlaying(data) && DeserializeState(m_inputLog.GetState());
+		if (!loaded) {
+			dev::Log("Input log: the data is corrupted");
+			m_inputLog.Stop();
+		}
+		InputLogUpdate(); // the inputs recorded right at the start
+		if (m_status == Status::STOP) PublishSnapshot();
+		out = { {"result", loaded} };
+		break;
+	}
+	case Req::INPUT_LOG_GET_STATUS:
+		out = {
+			{"mode", static_cast<int>(m_inputLog.GetMode())},
+			{"events", m_inputLog.GetEventsLen()},
+			{"hashes", m_inputLog.GetHashesLen()},
+			{"divergedCC", m_inputLog.GetDivergedCC()},
+			};
+		break;
+
+	case Req::RESET_UPDATE_FDD:
+		m_fdc.ResetUpdate(_dataJ["driveIdx"]);
+		break;
+
+	case Req::DEBUG_ATTACH:
+		m_debugAttached = _dataJ["data"];
+		break;
+
+	default:
+		out = DebugReqHandling(_req, _dataJ, m_cpu.GetStateP(), m_memory.GetStateP(), m_io.GetStateP(), m_display.GetStateP());
+		ScheduleEvents(); // the recorder can restore the states
+	}
+
+	return out;
 }
 
 void dev::Hardware::Reset()
@@ -497,6 +937,7 @@ void dev::Hardware::Stop()
 {
 	m_status = Status::STOP;
 	m_audio.Pause(true);
+	PublishSnapshot();
 }
 
 // to continue execution
@@ -616,12 +1057,270 @@ auto dev::Hardware::GetFrame(const bool _vsync)
 	return m_display.GetFrame(_vsync);
 }
 
+// caller thread. Executes the frames ignoring the breaks
+void dev::Hardware::ExecuteFrames(const uint64_t _frames)
+{
+	for (uint64_t i = 0; i < _frames; i++) {
+		ExecuteFrameNoBreaks();
+	}
+}
+
+void dev::Hardware::SetKeys(const uint8_t* _matrix, const bool _keySS, const bool _keyUS, const bool _keyRus)
+{
+	m_keyboard.SetKeys(_matrix, _keySS, _keyUS, _keyRus);
+}
+
+void dev::Hardware::StoreState(MachineState& _state)
+{
+	SyncDevices();
+	_state.cpu = m_cpu.GetState();
+	m_memory.StoreState(_state.memory);
+	_state.io = m_io.GetState();
+	m_display.StoreState(_state.display);
+	_state.scheduler = m_scheduler;
+	_state.timer = m_timer;
+	_state.ay = m_ay;
+	m_aywrapper.StoreState(_state.aywrapper);
+	m_keyboard.StoreState(_state.keyboard);
+	m_fdc.StoreState(_state.fdc);
+}
+
+void dev::Hardware::RestoreState(const MachineState& _state)
+{
+	m_rasterLag = 0;
+	m_audioLag = 0;
+	*m_cpu.GetStateP() = _state.cpu;
+	m_memory.RestoreState(_state.memory);
+	*m_io.GetStateP() = _state.io;
+	m_display.RestoreState(_state.display);
+	m_scheduler = _state.scheduler;
+	m_timer = _state.timer;
+	m_ay = _state.ay;
+	m_aywrapper.RestoreState(_state.aywrapper);
+	m_keyboard.RestoreState(_state.keyboard);
+	m_fdc.RestoreState(_state.fdc);
+}
+
+auto dev::Hardware::SerializeState(const bool _compress)
+-> std::vector<uint8_t>
+{
+	if (!m_stateTmpP) m_stateTmpP = std::make_unique<MachineState>();
+	auto& state = *m_stateTmpP;
+	StoreState(state);
+
+	SaveStateWriter writer(_compress);
+	auto Add = [&writer](const StateSection _section, const uint16_t _version, const auto& _data) {
+		writer.Add(static_cast<uint32_t>(_section), _version, &_data, sizeof(_data));
+	};
+	Add(StateSection::CPU, STATE_VER_CPU, state.cpu);
+	Add(StateSection::MEMORY, STATE_VER_MEMORY, state.memory);
+	Add(StateSection::IO, STATE_VER_IO, state.io);
+	Add(StateSection::DISPLAY, STATE_VER_DISPLAY, state.display);
+	Add(StateSection::SCHEDULER, STATE_VER_SCHEDULER, state.scheduler);
+	Add(StateSection::TIMER, STATE_VER_TIMER, state.timer);
+	Add(StateSection::AY, STATE_VER_AY, state.ay);
+	Add(StateSection::AY_WRAPPER, STATE_VER_AY_WRAPPER, state.aywrapper);
+	Add(StateSection::KEYBOARD, STATE_VER_KEYBOARD, state.keyboard);
+	Add(StateSection::FDC, STATE_VER_FDC, state.fdc);
+
+	std::vector<uint8_t> fdd;
+	for (int driveIdx = 0; driveIdx < Fdc1793::DRIVES_MAX; driveIdx++)
+	{
+		auto info = m_fdc.GetFddInfo(driveIdx);
+		auto dataP = m_fdc.GetFddData(driveIdx);
+
+		FddStateHeader header{ dataP != nullptr, info.updated, static_cast<uint16_t>(info.path.size()) };
+		fdd.resize(sizeof(header) + header.pathLen + (dataP ? FDD_SIZE : 0));
+		memcpy(fdd.data(), &header, sizeof(header));
+		memcpy(fdd.data() + sizeof(header), info.path.data(), header.pathLen);
+		if (dataP) memcpy(fdd.data() + sizeof(header) + header.pathLen, dataP, FDD_SIZE);
+
+		writer.Add(static_cast<uint32_t>(StateSection::FDD0) + driveIdx, STATE_VER_FDD, fdd.data(), fdd.size());
+	}
+
+	return writer.Finish();
+}
+
+// applies the state only if every section is valid
+bool dev::Hardware::DeserializeState(const std::vector<uint8_t>& _data)
+{
+	SaveStateReader reader(_data);
+	if (!reader.IsValid()) return false;
+
+	if (!m_stateTmpP) m_stateTmpP = std::make_unique<MachineState>();
+	auto& state = *m_stateTmpP;
+
+	auto Read = [&reader](const StateSection _section, const uint16_t _version, auto& _data) {
+		return reader.Read(static_cast<uint32_t>(_section), _version, &_data, sizeof(_data));
+	};
+	bool valid = Read(StateSection::CPU, STATE_VER_CPU, state.cpu) &&
+		Read(StateSection::MEMORY, STATE_VER_MEMORY, state.memory) &&
+		Read(StateSection::IO, STATE_VER_IO, state.io) &&
+		Read(StateSection::DISPLAY, STATE_VER_DISPLAY, state.display) &&
+		Read(StateSection::SCHEDULER, STATE_VER_SCHEDULER, state.scheduler) &&
+		Read(StateSection::TIMER, STATE_VER_TIMER, state.timer) &&
+		Read(StateSection::AY, STATE_VER_AY, state.ay) &&
+		Read(StateSection::AY_WRAPPER, STATE_VER_AY_WRAPPER, state.aywrapper) &&
+		Read(StateSection::KEYBOARD, STATE_VER_KEYBOARD, state.keyboard) &&
+		Read(StateSection::FDC, STATE_VER_FDC, state.fdc);
+	if (!valid) return false;
+
+	// a missing fdd section means an empty drive
+	std::vector<uint8_t> fdds[Fdc1793::DRIVES_MAX];
+	for (int driveIdx = 0; driveIdx < Fdc1793::DRIVES_MAX; driveIdx++)
+	{
+		auto section = static_cast<uint32_t>(StateSection::FDD0) + driveIdx;
+		if (!reader.Has(section)) continue;
+
+		auto& fdd = fdds[driveIdx];
+		fdd.resize(reader.GetLen(section));
+		if (!reader.Read(section, STATE_VER_FDD, fdd.data(), fdd.size())) return false;
+
+		FddStateHeader header;
+		if (fdd.size() < sizeof(header)) return false;
+		memcpy(&header, fdd.data(), sizeof(header));
+		if (fdd.size() != sizeof(header) + header.pathLen + (header.mounted ? FDD_SIZE : 0)) return false;
+	}
+
+	for (int driveIdx = 0; driveIdx < Fdc1793::DRIVES_MAX; driveIdx++)
+	{
+		auto& fdd = fdds[driveIdx];
+		if (fdd.empty()) {
+			m_fdc.RestoreFdd(driveIdx, nullptr, "", false);
+			continue;
+		}
+		FddStateHeader header;
+		memcpy(&header, fdd.data(), sizeof(header));
+		std::string path(reinterpret_cast<const char*>(fdd.data() + sizeof(header)), header.pathLen);
+		auto dataP = header.mounted ? fdd.data() + sizeof(header) + header.pathLen : nullptr;
+		m_fdc.RestoreFdd(driveIdx, dataP, path, header.updated);
+	}
+
+	RestoreState(state);
+	return true;
+}
+
+// the hash of the ram and the cpu state to detect a replay divergence
+auto dev::Hardware::GetStateHash() const
+-> uint64_t
+{
+	auto ramP = m_memory.GetRam();
+	auto hash = dev::Hash64(ramP->data(), ramP->size());
+	return dev::Hash64(reinterpret_cast<const uint8_t*>(&m_cpu.GetState()), sizeof(CpuI8080::State), hash);
+}
+
+// stores the state hashes while recording.
+// applies the due inputs and checks the state hashes while replaying
+void dev::Hardware::InputLogUpdate()
+{
+	auto cc = m_cpu.GetCC();
+
+	switch (m_inputLog.GetMode())
+	{
+	case InputLog::Mode::RECORD:
+		if (cc >= m_inputLog.GetNextCC()) m_inputLog.AddHash(cc, GetStateHash());
+		break;
+
+	case InputLog::Mode::PLAY:
+		while (m_inputLog.IsHashDue(cc))
+		{
+			if (!m_inputLog.CheckHash(cc, GetStateHash()) && m_inputLog.GetDivergedCC() == cc) {
+				dev::Log("Input log: the replay diverged at cc {}", cc);
+			}
+		}
+
+		while (auto eventP = m_inputLog.PopEvent(cc)) {
+			InputHandling(*eventP);
+		}
+
+		if (m_inputLog.IsPlayed(cc)) {
+			m_inputLog.Stop();
+			dev::Log("Input log: the replay is finished");
+		}
+		break;
+
+	case InputLog::Mode::NONE:
+		break;
+	}
+
+	m_inputLogNextCC = m_inputLog.GetNextCC();
+}
+
+void dev::Hardware::InputHandling(const InputLog::Event& _event)
+{
+	switch (_event.type)
+	{
+	case InputLog::EventType::KEY:
+		KeyHandling(_event.arg0, _event.arg1);
+		break;
+
+	case InputLog::EventType::RESET:
+		Reset();
+		break;
+
+	case InputLog::EventType::RESTART:
+		Restart();
+		break;
+
+	case InputLog::EventType::SET_MEM:
+		m_memory.SetRam(_event.arg0, m_inputLog.GetPayload(_event).data);
+		break;
+
+	case InputLog::EventType::LOAD_FDD:
+	{
+		auto& payload = m_inputLog.GetPayload(_event);
+		m_fdc.Mount(_event.arg0, payload.data, payload.path);
+		break;
+	}
+	}
+}
+
+void dev::Hardware::KeyHandling(const int _scancode, const int _action)
+{
+	auto op = m_io.GetKeyboard().KeyHandling(_scancode, _action);
+	if (op == Keyboard::Operation::RESET) {
+		Reset();
+	}
+	else if (op == Keyboard::Operation::RESTART) {
+		Restart();
+	}
+}
+
 void dev::Hardware::ExecuteFrameNoBreaks()
 {
 	auto frameNum = m_display.GetFrameNum();
 	do {
 		ExecuteInstruction();
 	} while (m_display.GetFrameNum() == frameNum);
+
+	// the callers read the frame and the captured audio
+	SyncDevices();
+}
+
+// runs the frames as fast as the host allows.
+// the audio is captured instead of being played back
+auto dev::Hardware::ExportFrames(const uint64_t _frames)
+-> uint64_t
+{
+	if (!Export) return 0;
+
+	std::vector<float> samples;
+	samples.reserve(Audio::OUTPUT_RATE / 25); // about two frames of samples
+	m_audio.Pause(true);
+	m_audio.Capture(&samples);
+
+	uint64_t frame = 0;
+	for (; frame < _frames && m_status != Status::EXIT; frame++)
+	{
+		ExecuteFrameNoBreaks();
+		Export(*m_display.GetBackBuffer(), samples);
+		samples.clear();
+	}
+
+	m_audio.Capture(nullptr);
+	if (m_status == Status::RUN) m_audio.Pause(false);
+
+	return frame;
 }
 
 auto dev::Hardware::GetStepOverAddr()
@@ -643,4 +1342,33 @@ auto dev::Hardware::GetStepOverAddr()
 		return opcode - CpuI8080::OPCODE_RST0;
 	}
 	return pc + dev::GetCmdLen(opcode);
+}
+
+// runs as fast as the host allows until one of the conditions is met.
+// _frames = 0, _pc = -1, _cc = 0 disable the corresponding condition.
+// the breakpoints are ignored
+auto dev::Hardware::ExecuteUntil(const uint64_t _frames, const int _pc, const uint64_t _cc)
+-> nlohmann::json
+{
+	auto startFrame = m_display.GetFrameNum();
+	bool pcReached = false;
+
+	while (m_status != Status::EXIT)
+	{
+		ExecuteInstruction();
+
+		if (_pc >= 0 && m_cpu.GetPC() == _pc) {
+			pcReached = true;
+			break;
+		}
+		if (_cc && m_cpu.GetCC() >= _cc) break;
+		if (_frames && m_display.GetFrameNum() - startFrame >= _frames) break;
+	}
+
+	return {
+		{"frames", m_display.GetFrameNum() - startFrame},
+		{"cc", m_cpu.GetCC()},
+		{"pc", m_cpu.GetPC()},
+		{"pcReached", pcReached},
+	};
 }
\ No newline at end of file
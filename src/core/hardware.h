@@ -6,6 +6,10 @@
 #include <condition_variable>
 #include <atomic>
 #include <chrono>
+#include <variant>
+#include <vector>
+#include <memory>
+#include <type_traits>
 
 #include "utils/types.h"
 #include "core/cpu_i8080.h"
@@ -17,15 +21,20 @@
 #include "core/sound_ay8910.h"
 #include "core/audio.h"
 #include "core/fdc_wd1793.h"
+#include "core/scheduler.h"
+#include "core/input_log.h"
+#include "core/branch_ring.h"
 #include "utils/utils.h"
 #include "utils/result.h"
-#include "utils/tqueue.h"
+#include "utils/spsc_ring.h"
+#include "utils/seqlock.h"
 #include "utils/json_utils.h"
 
 namespace dev 
 {
 	class Hardware
 	{
+		Scheduler m_scheduler; // has to be constructed before the devices
 		CpuI8080 m_cpu;
 		Memory m_memory;
 		Keyboard m_keyboard;
@@ -48,49 +57,199 @@ namespace dev
 		#include "core/hardware_consts.h"
 		
 
-		using DebugFunc = std::function<bool(
+		// the per-instruction debug func. A plain pointer keeps the call cheap, _contextP is passed back to it
+		using DebugFunc = bool(*)(void* _contextP,
 			CpuI8080::State* _cpuState, Memory::State* _memState,
-			IO::State* _ioState, Display::State* _displayState)>;
+			IO::State* _ioState, Display::State* _displayState);
 
 		using DebugReqHandlingFunc = std::function<nlohmann::json(Req _req, nlohmann::json _reqDataJ,
 			CpuI8080::State* _cpuState, Memory::State* _memState,
 			IO::State* _ioState, Display::State* _displayState)>;
 
+		using ExportFunc = std::function<void(const Display::FrameBuffer& _frame, const std::vector<float>& _samples)>;
+
 		enum class ExecSpeed : int { _1PERCENT = 0, _20PERCENT, HALF, NORMAL, X2, MAX, LEN };
 
+		// typed commands sent to the Hardware thread.
+		// CmdJson adapts the Req requests that don't have a typed form
+		struct CmdJson { Req req = Req::NONE; nlohmann::json dataJ; };
+		struct CmdGetCC {};
+		struct CmdGetCpuState {};
+		struct CmdGetByte { Addr addr = 0; Memory::AddrSpace addrSpace = Memory::AddrSpace::RAM; };
+		struct CmdGet3Bytes { Addr addr = 0; Memory::AddrSpace addrSpace = Memory::AddrSpace::RAM; };
+		struct CmdGetWord { Addr addr = 0; Memory::AddrSpace addrSpace = Memory::AddrSpace::RAM; };
+		struct CmdGetGlobalAddr { Addr addr = 0; Memory::AddrSpace addrSpace = Memory::AddrSpace::RAM; };
+		struct CmdGetByteGlobal { GlobalAddr globalAddr = 0; };
+		struct CmdGetMemRange { uint8_t* dstP = nullptr; Addr addr = 0; size_t len = 0; Memory::AddrSpace addrSpace = Memory::AddrSpace::RAM; };
+		struct CmdGetMemRangeGlobal { uint8_t* dstP = nullptr; GlobalAddr globalAddr = 0; size_t len = 0; };
+		struct CmdSetAudioSink { AudioSink* sinkP = nullptr; };
+		struct CmdSaveState { std::vector<uint8_t>* dstP = nullptr; bool compress = true; };
+		struct CmdLoadState { const std::vector<uint8_t>* srcP = nullptr; };
+		using Cmd = std::variant<CmdGetCC, CmdJson, CmdGetCpuState, CmdGetByte, CmdGet3Bytes,
+			CmdGetWord, CmdGetGlobalAddr, CmdGetByteGlobal, CmdGetMemRange, CmdGetMemRangeGlobal,
+			CmdSetAudioSink, CmdSaveState, CmdLoadState>;
+
+		// the reply is preallocated and reused by every command
+		struct Reply
+		{
+			nlohmann::json dataJ;		// CmdJson result
+			uint64_t data = 0;			// the result of the commands returning a number
+			CpuI8080::State cpuState;	// CmdGetCpuState result
+			Memory::Update memUpdate;	// the mapping at the moment the memory range was copied
+		};
+
+		// the hardware state published by the Hardware thread every frame, on a stop, and after
+		// the requests handled while stopped. The UI reads it without a round-trip to the Hardware thread
+		static constexpr int STACK_SAMPLE_LEN = 11;	// words from sp-10 to sp+10
+		static constexpr int FDD_PATH_LEN = 260;
+		struct FddSnapshot
+		{
+			char path[FDD_PATH_LEN] = {};	// truncated if longer
+			uint64_t reads = 0;
+			uint64_t writes = 0;
+			bool updated = false;
+			bool mounted = false;
+		};
+		struct Snapshot
+		{
+			CpuI8080::State cpuState;
+			uint16_t stack[STACK_SAMPLE_LEN] = {};
+			uint64_t frameNum = 0;
+			int rasterLine = 0;
+			int rasterPixel = 0;
+			uint8_t scrollVert = 0;
+			bool displayMode = false;
+			Memory::Mapping mapping;
+			uint8_t ramdiskIdx = 0;
+			IO::Palette palette;
+			IO::PortsData portsInData;
+			IO::PortsData portsOutData;
+			Fdc1793::Info fdcInfo = {};
+			FddSnapshot fddInfo[Fdc1793::DRIVES_MAX];
+		};
+
+		// the machine state to branch the execution. It is trivially copyable,
+		// so a clone is a flat copy. The disk images aren't included.
+		// The scheduler, the timer, and the AY have no pointers and are copied as a whole
+		struct MachineState
+		{
+			CpuI8080::State cpu;
+			Memory::SaveState memory;
+			IO::State io;
+			Display::SaveState display;
+			Scheduler scheduler;
+			TimerI8253 timer;
+			SoundAY8910 ay;
+			AYWrapper::SaveState aywrapper;
+			Keyboard::SaveState keyboard;
+			Fdc1793::SaveState fdc;
+		};
+		static_assert(std::is_trivially_copyable_v<MachineState>, "MachineState has to be trivially copyable");
+
 
         Hardware(const std::string& _pathBootData, const std::string& _pathRamDiskData, 
-			const bool _ramDiskClearAfterRestart);
+			const bool _ramDiskClearAfterRestart, const bool _threaded = true);
 		~Hardware();
 		auto Request(const Req _req, const nlohmann::json& _dataJ = {}) -> Result <nlohmann::json>;
+		auto RequestCC() -> uint64_t;
+		auto RequestCpuState() -> CpuI8080::State;
+		auto RequestByte(const Addr _addr, const Memory::AddrSpace _addrSpace = Memory::AddrSpace::RAM) -> uint8_t;
+		auto Request3Bytes(const Addr _addr, const Memory::AddrSpace _addrSpace = Memory::AddrSpace::RAM) -> uint32_t;
+		auto RequestWord(const Addr _addr, const Memory::AddrSpace _addrSpace = Memory::AddrSpace::RAM) -> uint16_t;
+		auto RequestGlobalAddr(const Addr _addr, const Memory::AddrSpace _addrSpace = Memory::AddrSpace::RAM) -> GlobalAddr;
+		auto RequestByteGlobal(const GlobalAddr _globalAddr) -> uint8_t;
+		auto RequestMemRange(uint8_t* _dstP, const Addr _addr, const size_t _len,
+			const Memory::AddrSpace _addrSpace = Memory::AddrSpace::RAM) -> Memory::Update;
+		auto RequestMemRangeGlobal(uint8_t* _dstP, const GlobalAddr _globalAddr, const size_t _len) -> Memory::Update;
+		auto RequestSaveState(const bool _compress = true) -> std::vector<uint8_t>;
+		auto RequestLoadState(const std::vector<uint8_t>& _data) -> bool;
 		auto GetFrame(const bool _vsync) -> const Display::FrameBuffer*;
+		auto GetSnapshot() const -> Snapshot { return m_snapshot.load(); }
+		auto GetSnapshotVer() const -> uint32_t { return m_snapshot.version(); }
 		auto GetRam() const -> const Memory::Ram*;
 		auto GetCpuState() -> const CpuI8080::State& { return m_cpu.GetState(); }
 		auto GetMemState() -> const Memory::State& { return m_memory.GetState(); }
 		auto GetIoState() -> const IO::State& { return m_io.GetState(); }
 
-		void AttachDebugFuncs(DebugFunc _debugFunc, DebugReqHandlingFunc _debugReqHandlingFunc);
+		void AttachDebugFuncs(DebugFunc _debugFunc, void* _debugContextP, DebugReqHandlingFunc _debugReqHandlingFunc);
+		// replaces the per-instruction debug func. Only from the Hardware thread, between the instructions
+		void AttachDebugFunc(DebugFunc _debugFunc) { Debug = _debugFunc; }
+		void AttachExportFunc(ExportFunc _exportFunc);
+		void AttachAudioSink(AudioSink* _sinkP);
+
+		// the direct synchronous access without the requests.
+		// only for the Hardware created without the execution thread
+		void ExecuteFrames(const uint64_t _frames);
+		void SetKeys(const uint8_t* _matrix, const bool _keySS, const bool _keyUS, const bool _keyRus);
+		void StoreState(MachineState& _state);
+		void RestoreState(const MachineState& _state);
+		auto GetBackBuffer() const -> const Display::FrameBuffer* { return m_display.GetBackBuffer(); }
+		auto GetFrameNum() const -> uint64_t { return m_display.GetFrameNum(); }
 
 
 	private:
 		DebugFunc Debug = nullptr;
+		void* m_debugContextP = nullptr;
 		DebugReqHandlingFunc DebugReqHandling = nullptr;
 		bool m_debugAttached = false;
+		ExportFunc Export = nullptr;
 
 		std::thread m_executionThread;
-		std::thread m_reqHandlingThread;
 		std::atomic<Status> m_status;
-		TQueue <std::pair<Req, nlohmann::json>> m_reqs; // request
-		TQueue <nlohmann::json> m_reqRes;				// request's result sent back 
+		static constexpr size_t CMDS_MAX = 16;
+		SpscRing<Cmd, CMDS_MAX> m_cmds;		// commands from the UI thread
+		std::atomic_uint32_t m_cmdsPending = 0;	// checked by the Hardware thread after every instruction
+		std::atomic_uint64_t m_replySeq = 0;	// incremented when the reply is ready
+		Reply m_reply;
+		std::mutex m_requestMutex;		// serializes the callers, so the ring stays single producer
+		SeqLock<Snapshot> m_snapshot;
+		std::unique_ptr<MachineState> m_stateTmpP; // allocated on the first save state use
+		InputLog m_inputLog;
+		uint64_t m_inputLogNextCC = InputLog::CC_NONE; // checked after every instruction
+		BranchRing m_branches; // always on, dumped on the exception
+		// the cpu runs ahead of the display and the audio until a scheduler event is due.
+		// the machine cycles not rasterized and not clocked yet
+		int m_rasterLag = 0;
+		int m_audioLag = 0;
+
+		// the save state sections. Each one is versioned separately
+		enum class StateSection : uint32_t { CPU = 0, MEMORY, IO, DISPLAY, SCHEDULER, TIMER, AY, AY_WRAPPER,
+			KEYBOARD, FDC, FDD0, FDD1, FDD2, FDD3 };
 
 		ExecSpeed m_execSpeed = ExecSpeed::NORMAL;
 		std::chrono::microseconds m_execDelays[static_cast<int>(ExecSpeed::LEN)] = { 1996800us, 99840us, 39936us, 19968us, 9984us, 10us };
 
 		void Init();
+		void ScheduleEvents();
 		void Execution();
 		bool ExecuteInstruction();
+		void SyncDevices();
 		void ExecuteFrameNoBreaks();
+		auto ExportFrames(const uint64_t _frames) -> uint64_t;
+		auto ExecuteUntil(const uint64_t _frames, const int _pc, const uint64_t _cc) -> nlohmann::json;
 		void ReqHandling(const bool _waitReq = false);
+		void PublishSnapshot();
+		void Call(Cmd&& _cmd);
+		void CmdHandling(CmdJson& _cmd);
+		void CmdHandling(const CmdGetCC& _cmd);
+		void CmdHandling(const CmdGetCpuState& _cmd);
+		void CmdHandling(const CmdGetByte& _cmd);
+		void CmdHandling(const CmdGet3Bytes& _cmd);
+		void CmdHandling(const CmdGetWord& _cmd);
+		void CmdHandling(const CmdGetGlobalAddr& _cmd);
+		void CmdHandling(const CmdGetByteGlobal& _cmd);
+		void CmdHandling(const CmdGetMemRange& _cmd);
+		void CmdHandling(const CmdGetMemRangeGlobal& _cmd);
+		void CmdHandling(const CmdSetAudioSink& _cmd);
+		void CmdHandling(const CmdSaveState& _cmd);
+		void CmdHandling(const CmdLoadState& _cmd);
+		auto SerializeState(const bool _compress) -> std::vector<uint8_t>;
+		auto GetStateHash() const -> uint64_t;
+		void InputLogUpdate();
+		void InputHandling(const InputLog::Event& _event);
+		void KeyHandling(const int _scancode, const int _action);
+		bool DeserializeState(const std::vector<uint8_t>& _data);
+		auto ReqJsonHandling(const Req _req, const nlohmann::json& _dataJ) -> nlohmann::json;
 		void Reset();
 		void Restart();
 		void Stop();
@@ -10,6 +10,8 @@ enum class Req: int {
 	EXECUTE_INSTR,
 	EXECUTE_FRAME,
 	EXECUTE_FRAME_NO_BREAKS,
+	EXPORT_FRAMES,	// executes frames without the pacing passing them with the audio to the attached ExportFunc
+	EXECUTE_UNTIL,	// executes without the pacing until the frames are done, the pc is reached, or the cc is passed
 	GET_CC,
 	GET_REGS,
 	GET_REG_PC,
@@ -43,20 +45,44 @@ enum class Req: int {
 	SET_BYTE_GLOBAL,
 	SET_CPU_SPEED,
 	GET_HW_MAIN_STATS,
+	GET_BRANCHES,	// the last taken branches, the oldest first
 	IS_MEMROM_ENABLED,
 	KEY_HANDLING,
 	LOAD_FDD,
 	RESET_UPDATE_FDD,
+	INPUT_LOG_RECORD,	// saves the state and starts recording the inputs
+	INPUT_LOG_STOP,		// stops recording or replaying. Outputs the recorded log
+	INPUT_LOG_PLAY,		// restores the state of the log and replays the inputs
+	INPUT_LOG_GET_STATUS,
 	DEBUG_ATTACH,
 	DEBUG_RESET,
+	DEBUG_SET_FEATURES,	// the mask of the Debugger::FEATURE_* checked every instruction
+	DEBUG_GET_FEATURES,
+	DEBUG_PUBLISH_LAST_RW,	// the hardware sends it after a request executed the instructions while stopped
 
 	DEBUG_RECORDER_RESET,
 	DEBUG_RECORDER_PLAY_FORWARD,
 	DEBUG_RECORDER_PLAY_REVERSE,
+	DEBUG_RECORDER_SEEK_TO_FRAME,
 	DEBUG_RECORDER_GET_STATE_RECORDED,
 	DEBUG_RECORDER_GET_STATE_CURRENT,
-	DEBUG_RECORDER_SERIALIZE,
+	DEBUG_RECORDER_SAVE,
+	DEBUG_RECORDER_LOAD,
 	DEBUG_RECORDER_DESERIALIZE,
+	DEBUG_RECORDER_SET_SPILL,
+	DEBUG_RECORDER_GET_MEM_STATS,
+
+	DEBUG_PROFILER_RESET,
+	DEBUG_PROFILER_GET,			// {"hotSpots": len} -> the cycles per function and the hot spots
+	DEBUG_PROFILER_GET_STACKS,	// the call paths and their cycles for the flame graph
+	DEBUG_PROFILER_ADD_REGION,	// {"type", "addr", "addrEnd", "color", "name"} a code region of the raster mode
+	DEBUG_PROFILER_DEL_REGION,	// {"idx"}
+	DEBUG_PROFILER_GET_RASTER,	// {"frames": len} -> the regions and the beam positions they ran at in the last frames
+
+	DEBUG_TRACE_CAPTURE_START,	// {"path"} -> {"result"} streams the executed instructions to the file
+	DEBUG_TRACE_CAPTURE_STOP,
+	DEBUG_TRACE_CAPTURE_OPEN,	// {"path"} -> {"result"} opens a finished capture for the queries
+	DEBUG_TRACE_CAPTURE_GET_STATS,
 
 	DEBUG_BREAKPOINT_ADD,
 	DEBUG_BREAKPOINT_DEL,
@@ -0,0 +1,216 @@
+#include <cstring>
+#include <algorithm>
+#include <type_traits>
+
+#include "core/input_log.h"
+#include "core/save_state.h"
+#include "utils/utils.h"
+
+// the input log is stored in the save state container
+enum class Section : uint32_t { INFO = 0x100, STATE, EVENTS, PAYLOADS, HASHES };
+static constexpr uint16_t INPUT_LOG_VER = 1;
+
+#pragma pack(push, 1)
+struct Info
+{
+	uint64_t startCC;
+	uint64_t endCC;
+};
+
+// a payload is stored as the header, the data, and the path
+struct PayloadHeader
+{
+	uint32_t dataLen;
+	uint32_t pathLen;
+};
+#pragma pack(pop)
+
+bool dev::InputLog::IsInputLog(const std::vector<uint8_t>& _data)
+{
+	if (!SaveStateReader::IsSaveState(_data)) return false;
+
+	SaveStateReader reader(_data);
+	return reader.IsValid() && reader.Has(static_cast<uint32_t>(Section::INFO));
+}
+
+auto dev::InputLog::GetNextCC() const
+-> uint64_t
+{
+	switch (m_mode)
+	{
+	case Mode::RECORD:
+		return m_nextHashCC;
+
+	case Mode::PLAY:
+	{
+		uint64_t cc = m_endCC;
+		if (m_eventIdx < m_events.size()) cc = dev::Min(cc, m_events[m_eventIdx].cc);
+		if (m_hashIdx < m_hashes.size()) cc = dev::Min(cc, m_hashes[m_hashIdx].cc);
+		return cc;
+	}
+	case Mode::NONE:
+		break;
+	}
+	return CC_NONE;
+}
+
+void dev::InputLog::Stop()
+{
+	m_mode = Mode::NONE;
+}
+
+void dev::InputLog::StartRecording(std::vector<uint8_t>&& _state, const uint64_t _cc)
+{
+	m_mode = Mode::RECORD;
+	m_state = std::move(_state);
+	m_events.clear();
+	m_payloads.clear();
+	m_hashes.clear();
+	m_startCC = m_endCC = _cc;
+	m_nextHashCC = _cc + HASH_PERIOD;
+	m_divergedCC = CC_NONE;
+}
+
+void dev::InputLog::StopRecording(const uint64_t _cc)
+{
+	if (m_mode != Mode::RECORD) return;
+	m_endCC = _cc;
+	m_mode = Mode::NONE;
+}
+
+void dev::InputLog::AddKey(const uint64_t _cc, const int _scancode, const int _action)
+{
+	if (m_mode != Mode::RECORD) return;
+	m_events.push_back({ _cc, EventType::KEY, _scancode, _action });
+}
+
+void dev::InputLog::AddEvent(const uint64_t _cc, const EventType _type)
+{
+	if (m_mode == Mode::PLAY) Stop();
+	if (m_mode != Mode::RECORD) return;
+	m_events.push_back({ _cc, _type });
+}
+
+void dev::InputLog::AddPayloadEvent(const uint64_t _cc, const EventType _type, const int _arg,
+	const std::vector<uint8_t>& _data, const std::string& _path)
+{
+	if (m_mode == Mode::PLAY) Stop();
+	if (m_mode != Mode::RECORD) return;
+	m_events.push_back({ _cc, _type, _arg, static_cast<int32_t>(m_payloads.size()) });
+	m_payloads.push_back({ _data, _path });
+}
+
+void dev::InputLog::AddHash(const uint64_t _cc, const uint64_t _hash)
+{
+	m_hashes.push_back({ _cc, _hash });
+	m_nextHashCC = _cc + HASH_PERIOD;
+}
+
+auto dev::InputLog::Serialize() const
+-> std::vector<uint8_t>
+{
+	SaveStateWriter writer(true);
+	auto Add = [&writer](const Section _section, const void* _dataP, const size_t _len) {
+		writer.Add(static_cast<uint32_t>(_section), INPUT_LOG_VER, _dataP, _len);
+	};
+
+	Info info{ m_startCC, m_endCC };
+	Add(Section::INFO, &info, sizeof(info));
+	Add(Section::STATE, m_state.data(), m_state.size());
+	Add(Section::EVENTS, m_events.data(), m_events.size() * sizeof(Event));
+	Add(Section::HASHES, m_hashes.data(), m_hashes.size() * sizeof(StateHash));
+
+	std::vector<uint8_t> payloads;
+	for (const auto& payload : m_payloads)
+	{
+		PayloadHeader header{ static_cast<uint32_t>(payload.data.size()), static_cast<uint32_t>(payload.path.size()) };
+		auto headerP = reinterpret_cast<const uint8_t*>(&header);
+		payloads.insert(payloads.end(), headerP, headerP + sizeof(header));
+		payloads.insert(payloads.end(), payload.data.begin(), payload.data.end());
+		payloads.insert(payloads.end(), payload.path.begin(), payload.path.end());
+	}
+	Add(Section::PAYLOADS, payloads.data(), payloads.size());
+
+	return writer.Finish();
+}
+
+bool dev::InputLog::StartPlaying(const std::vector<uint8_t>& _data)
+{
+	Stop();
+
+	SaveStateReader reader(_data);
+	if (!reader.IsValid()) return false;
+
+	auto Read = [&reader](const Section _section, auto& _vec) {
+		auto id = static_cast<uint32_t>(_section);
+		size_t len = reader.GetLen(id);
+		using T = typename std::remove_reference_t<decltype(_vec)>::value_type;
+		if (len % sizeof(T)) return false;
+		_vec.resize(len / sizeof(T));
+		return reader.Read(id, INPUT_LOG_VER, _vec.data(), len);
+	};
+
+	Info info;
+	std::vector<uint8_t> payloads;
+	bool valid = reader.Read(static_cast<uint32_t>(Section::INFO), INPUT_LOG_VER, &info, sizeof(info)) &&
+		Read(Section::STATE, m_state) &&
+		Read(Section::EVENTS, m_events) &&
+		Read(Section::HASHES, m_hashes) &&
+		Read(Section::PAYLOADS, payloads);
+	if (!valid) return false;
+
+	m_payloads.clear();
+	for (size_t offset = 0; offset < payloads.size();)
+	{
+		PayloadHeader header;
+		if (payloads.size() - offset < sizeof(header)) return false;
+		memcpy(&header, payloads.data() + offset, sizeof(header));
+		offset += sizeof(header);
+		if (payloads.size() - offset < size_t(header.dataLen) + header.pathLen) return false;
+
+		auto dataP = payloads.data() + offset;
+		m_payloads.push_back({ { dataP, dataP + header.dataLen },
+			{ reinterpret_cast<const char*>(dataP + header.dataLen), header.pathLen } });
+		offset += size_t(header.dataLen) + header.pathLen;
+	}
+
+	for (const auto& event : m_events)
+	{
+		bool hasPayload = event.type == EventType::SET_MEM || event.type == EventType::LOAD_FDD;
+		if (hasPayload && (event.arg1 < 0 || size_t(event.arg1) >= m_payloads.size())) return false;
+	}
+
+	m_startCC = info.startCC;
+	m_endCC = info.endCC;
+	m_eventIdx = 0;
+	m_hashIdx = 0;
+	m_divergedCC = CC_NONE;
+	m_mode = Mode::PLAY;
+	return true;
+}
+
+auto dev::InputLog::PopEvent(const uint64_t _cc)
+-> const Event*
+{
+	if (m_eventIdx >= m_events.size() || m_events[m_eventIdx].cc > _cc) return nullptr;
+	return &m_events[m_eventIdx++];
+}
+
+bool dev::InputLog::IsHashDue(const uint64_t _cc) const
+{
+	return m_hashIdx < m_hashes.size() && m_hashes[m_hashIdx].cc <= _cc;
+}
+
+bool dev::InputLog::CheckHash(const uint64_t _cc, const uint64_t _hash)
+{
+	auto& stateHash = m_hashes[m_hashIdx++];
+	if (stateHash.cc == _cc && stateHash.hash == _hash) return true;
+
+	if (m_divergedCC == CC_NONE) m_divergedCC = _cc;
+	return false;
+}
+
+bool dev::InputLog::IsPlayed(const uint64_t _cc) const
+{
+	return m_eventIdx >= m_events.size() && m_hashIdx >= m_hashes.size() && _cc >= m_endCC;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace dev
+{
+	// The deterministic recording of a session. It is the machine state at the start and
+	// the external inputs stamped with the cpu cycle they were applied at.
+	// The replay restores the state and applies the inputs at the same cycles, so the emulation repeats exactly
+	// regardless of the execution speed. The state hashes stored every HASH_PERIOD cycles detect a divergence.
+	// The log grows by a few bytes per input, so an hour long session takes kilobytes plus the initial state
+	class InputLog
+	{
+	public:
+		enum class Mode : int { NONE = 0, RECORD, PLAY };
+		enum class EventType : uint8_t { KEY = 0, RESET, RESTART, SET_MEM, LOAD_FDD };
+
+		static constexpr uint64_t CC_NONE = std::numeric_limits<uint64_t>::max();
+		// about a second
+		static constexpr uint64_t HASH_PERIOD = 59904 * 50;
+
+#pragma pack(push, 1)
+		struct Event
+		{
+			uint64_t cc;
+			EventType type;
+			int32_t arg0 = 0;	// KEY: scancode, SET_MEM: addr, LOAD_FDD: driveIdx
+			int32_t arg1 = 0;	// KEY: action, SET_MEM and LOAD_FDD: the payload idx
+		};
+
+		struct StateHash
+		{
+			uint64_t cc;
+			uint64_t hash;
+		};
+#pragma pack(pop)
+
+		// the data of SET_MEM and LOAD_FDD
+		struct Payload
+		{
+			std::vector<uint8_t> data;
+			std::string path;
+		};
+
+		static bool IsInputLog(const std::vector<uint8_t>& _data);
+
+		auto GetMode() const -> Mode { return m_mode; }
+		// the cc of the next event or the hash to handle, CC_NONE if there is nothing to do
+		auto GetNextCC() const -> uint64_t;
+		auto GetEventsLen() const -> size_t { return m_events.size(); }
+		auto GetHashesLen() const -> size_t { return m_hashes.size(); }
+		// the cc of the first hash mismatch of the replay, CC_NONE if there was no divergence
+		auto GetDivergedCC() const -> uint64_t { return m_divergedCC; }
+		void Stop();
+
+		// recording. _state is a save state
+		void StartRecording(std::vector<uint8_t>&& _state, const uint64_t _cc);
+		void StopRecording(const uint64_t _cc);
+		// the live inputs are stored while recording. Any live input except the keys ends the replay
+		void AddKey(const uint64_t _cc, const int _scancode, const int _action);
+		void AddEvent(const uint64_t _cc, const EventType _type);
+		void AddPayloadEvent(const uint64_t _cc, const EventType _type, const int _arg,
+			const std::vector<uint8_t>& _data, const std::string& _path = "");
+		void AddHash(const uint64_t _cc, const uint64_t _hash);
+		auto Serialize() const -> std::vector<uint8_t>;
+
+		// replay. Outputs false if the data is corrupted
+		bool StartPlaying(const std::vector<uint8_t>& _data);
+		// the save state to restore before the replay
+		auto GetState() const -> const std::vector<uint8_t>& { return m_state; }
+		// returns the next event due at _cc, nullptr if there is none
+		auto PopEvent(const uint64_t _cc) -> const Event*;
+		auto GetPayload(const Event& _event) const -> const Payload& { return m_payloads[_event.arg1]; }
+		bool IsHashDue(const uint64_t _cc) const;
+		// outputs false on the first mismatch
+		bool CheckHash(const uint64_t _cc, const uint64_t _hash);
+		// all the events were applied, and the end of the recording is reached
+		bool IsPlayed(const uint64_t _cc) const;
+
+	private:
+		Mode m_mode = Mode::NONE;
+		std::vector<uint8_t> m_state;
+		std::vector<Event> m_events;
+		std::vector<Payload> m_payloads;
+		std::vector<StateHash> m_hashes;
+		uint64_t m_startCC = 0;
+		uint64_t m_endCC = 0;
+
+		uint64_t m_nextHashCC = CC_NONE; // recording
+		size_t m_eventIdx = 0; // replay
+		size_t m_hashIdx = 0; // replay
+		uint64_t m_divergedCC = CC_NONE;
+	};
+}
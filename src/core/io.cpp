@@ -34,10 +34,10 @@
 #define PALLETE_HI		m_state.palette.hi
 
 dev::IO::IO(Keyboard& _keyboard, Memory& _memory, TimerI8253& _timer,
-	SoundAY8910& _ay, Fdc1793& _fdc)
+	SoundAY8910& _ay, Fdc1793& _fdc, Scheduler& _scheduler)
 	:
 	m_keyboard(_keyboard), m_memory(_memory), m_timer(_timer),
-	m_ay(_ay), m_fdc(_fdc)
+	m_ay(_ay), m_fdc(_fdc), m_scheduler(_scheduler)
 {
 	Init();
 }
@@ -53,6 +53,23 @@ void dev::IO::Init()
 
 	OUT_COMMIT_TIMER = PALLETE_COMMIT_TIMER = DISPLAY_MODE_COMMIT_TIMER = 0;
 	m_state.ruslatHistory = 0;
+	ScheduleEvents();
+}
+
+// the commit timers count down every pixel, so a pending commit
+// keeps its event due from now until the commit happens.
+// has to be called when the state is restored
+void dev::IO::ScheduleEvents()
+{
+	auto now = m_scheduler.GetTime();
+	if (OUT_COMMIT_TIMER > 0) m_scheduler.Schedule(Scheduler::Event::IO_OUT_COMMIT, now);
+	else m_scheduler.Cancel(Scheduler::Event::IO_OUT_COMMIT);
+
+	if (PALLETE_COMMIT_TIMER > 0) m_scheduler.Schedule(Scheduler::Event::IO_PALETTE_COMMIT, now);
+	else m_scheduler.Cancel(Scheduler::Event::IO_PALETTE_COMMIT);
+
+	if (DISPLAY_MODE_COMMIT_TIMER > 0) m_scheduler.Schedule(Scheduler::Event::IO_DISPLAY_MODE_COMMIT, now);
+	else m_scheduler.Cancel(Scheduler::Event::IO_DISPLAY_MODE_COMMIT);
 }
 
 // I8080 IN NN
@@ -306,6 +323,8 @@ void dev::IO::PortOut(uint8_t _port, uint8_t _value)
 
 	// set the commit time for port output
 	OUT_COMMIT_TIMER = m_outCommitTime;
+	auto now = m_scheduler.GetTime();
+	if (OUT_COMMIT_TIMER > 0) m_scheduler.Schedule(Scheduler::Event::IO_OUT_COMMIT, now);
 
 	// set the palette commit time
 	switch (_port) {
@@ -314,9 +333,11 @@ void dev::IO::PortOut(uint8_t _port, uint8_t _value)
 	case PORT_OUT_BORDER_COLOR2: [[fallthrough]];
 	case PORT_OUT_BORDER_COLOR3:
 		PALLETE_COMMIT_TIMER = m_paletteCommitTime;
+		if (PALLETE_COMMIT_TIMER > 0) m_scheduler.Schedule(Scheduler::Event::IO_PALETTE_COMMIT, now);
 		break;
 	case PORT_OUT_DISPLAY_MODE:
 		DISPLAY_MODE_COMMIT_TIMER = m_displayModeTime;
+		if (DISPLAY_MODE_COMMIT_TIMER > 0) m_scheduler.Schedule(Scheduler::Event::IO_DISPLAY_MODE_COMMIT, now);
 		break;
 	}
 }
@@ -326,6 +347,7 @@ void dev::IO::TryToCommit(const uint8_t _colorIdx)
 	if (OUT_COMMIT_TIMER > 0){
 		if (--OUT_COMMIT_TIMER == 0)
 		{
+			m_scheduler.Cancel(Scheduler::Event::IO_OUT_COMMIT);
 			PortOutCommit();
 		}
 	}
@@ -333,6 +355,7 @@ void dev::IO::TryToCommit(const uint8_t _colorIdx)
 	if (PALLETE_COMMIT_TIMER > 0) {
 		if (--PALLETE_COMMIT_TIMER == 0)
 		{
+			m_scheduler.Cancel(Scheduler::Event::IO_PALETTE_COMMIT);
 			SetColor(_colorIdx);
 		}
 	}
@@ -340,6 +363,7 @@ void dev::IO::TryToCommit(const uint8_t _colorIdx)
 	if (DISPLAY_MODE_COMMIT_TIMER > 0) {
 		if (--DISPLAY_MODE_COMMIT_TIMER == 0)
 		{
+			m_scheduler.Cancel(Scheduler::Event::IO_DISPLAY_MODE_COMMIT);
 			DISPLAY_MODE = REQ_DISPLAY_MODE;
 		}
 	}
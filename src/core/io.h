@@ -10,6 +10,7 @@
 #include "core/timer_i8253.h"
 #include "core/sound_ay8910.h"
 #include "core/fdc_wd1793.h"
+#include "core/scheduler.h"
 
 namespace dev
 {
@@ -123,6 +124,7 @@ namespace dev
 		TimerI8253& m_timer;
 		SoundAY8910& m_ay;
 		Fdc1793& m_fdc;
+		Scheduler& m_scheduler;
 
 		int m_outCommitTime = OUT_COMMIT_TIME;
 		int m_paletteCommitTime = PALETTE_COMMIT_TIME;
@@ -132,8 +134,9 @@ namespace dev
 		auto PortInHandling(uint8_t _port) -> uint8_t;
 
 	public:
-		IO(Keyboard& _keyboard, Memory& _memory, TimerI8253& _timer, SoundAY8910& _ay, Fdc1793& _fdc);
+		IO(Keyboard& _keyboard, Memory& _memory, TimerI8253& _timer, SoundAY8910& _ay, Fdc1793& _fdc, Scheduler& _scheduler);
 		void Init();
+		void ScheduleEvents();
 		auto PortIn(uint8_t _port) -> uint8_t;
 		void PortOut(uint8_t _port, uint8_t _value);
 		void PortOutCommit();
@@ -85,6 +85,27 @@ auto dev::Keyboard::Read(int _rows)
 	return ~result;
 }
 
+void dev::Keyboard::SetKeys(const uint8_t* _matrix, const bool _keySS, const bool _keyUS, const bool _keyRus)
+{
+	memcpy(m_encodingMatrix, _matrix, sizeof(m_encodingMatrix));
+	m_keySS = _keySS;
+	m_keyUS = _keyUS;
+	m_keyRus = _keyRus;
+}
+
+void dev::Keyboard::StoreState(SaveState& _state) const
+{
+	memcpy(_state.encodingMatrix, m_encodingMatrix, sizeof(m_encodingMatrix));
+	_state.keySS = m_keySS;
+	_state.keyUS = m_keyUS;
+	_state.keyRus = m_keyRus;
+}
+
+void dev::Keyboard::RestoreState(const SaveState& _state)
+{
+	SetKeys(_state.encodingMatrix, _state.keySS, _state.keyUS, _state.keyRus);
+}
+
 void dev::Keyboard::InitMapping()
 {
 	// Keyboard encoding matrix:
@@ -13,8 +13,11 @@ namespace dev
 {
 	class Keyboard
 	{
+	public:
+		static constexpr int ROWS = 8;
+
 	private:
-		uint8_t m_encodingMatrix[8];
+		uint8_t m_encodingMatrix[ROWS];
 		using KeyCode = int;
 		using RowColumnCode = int;
 		std::unordered_map<KeyCode, RowColumnCode> m_keymap;
@@ -30,10 +33,23 @@ namespace dev
 		bool m_keyRus = false;
 		Operation m_rebootType = Operation::NONE;
 
+		// the keyboard part of the machine state to clone it
+		struct SaveState
+		{
+			uint8_t encodingMatrix[ROWS];
+			bool keySS;
+			bool keyUS;
+			bool keyRus;
+		};
+
 		Keyboard();
 		
 		auto KeyHandling(int _scancode, int _action) -> Operation;
 		auto Read(int _rows) -> uint8_t;
+		// sets the pressed keys bypassing the scancodes. a set bit in _matrix[row] is a pressed key
+		void SetKeys(const uint8_t* _matrix, const bool _keySS, const bool _keyUS, const bool _keyRus);
+		void StoreState(SaveState& _state) const;
+		void RestoreState(const SaveState& _state);
 
 	private:
 		void InitMapping();
@@ -0,0 +1,47 @@
+#include "core/loader.h"
+#include "core/fdd_consts.h"
+#include "utils/utils.h"
+#include "utils/str_utils.h"
+
+auto dev::LoadRomFddRec(Hardware& _hardware, const std::string& _path)
+-> bool
+{
+	auto result = dev::LoadFile(_path);
+	if (!result || result->empty()) {
+		dev::Log("Failed to load the file: {}", _path);
+		return false;
+	}
+
+	_hardware.Request(Hardware::Req::STOP);
+	_hardware.Request(Hardware::Req::RESET);
+
+	auto ext = dev::StrToUpper(dev::GetExt(_path));
+	if (ext == ".ROM")
+	{
+		_hardware.Request(Hardware::Req::RESTART);
+		_hardware.Request(Hardware::Req::SET_MEM, { {"data", *result}, {"addr", Memory::ROM_LOAD_ADDR} });
+	}
+	else if (ext == ".FDD")
+	{
+		if (result->size() > FDD_SIZE) result->resize(FDD_SIZE);
+		_hardware.Request(Hardware::Req::LOAD_FDD, { {"data", *result}, {"driveIdx", 0}, {"path", _path} });
+		_hardware.Request(Hardware::Req::RESET);
+	}
+	else if (ext == ".REC" && InputLog::IsInputLog(*result))
+	{
+		auto resJ = _hardware.Request(Hardware::Req::INPUT_LOG_PLAY, { {"data", nlohmann::json::binary(*result)} });
+		if (!resJ || !resJ->at("result")) return false;
+	}
+	else if (ext == ".REC")
+	{
+		_hardware.Request(Hardware::Req::RESTART);
+		auto resJ = _hardware.Request(Hardware::Req::DEBUG_RECORDER_LOAD, { {"path", _path} });
+		if (!resJ || !resJ->at("result")) return false;
+	}
+	else {
+		dev::Log("Unsupported file type: {}", _path);
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <string>
+
+#include "core/hardware.h"
+
+namespace dev
+{
+	// loads the rom, the fdd, or the recording into the stopped hardware, and prepares it to run.
+	// a .rec is either an input log replayed by the hardware, or the recorder history
+	// that requires the debugger to be attached.
+	// outputs false if the file can't be loaded
+	auto LoadRomFddRec(Hardware& _hardware, const std::string& _path) -> bool;
+}
@@ -0,0 +1,69 @@
+#include <cstring>
+
+#include "core/mem_counters.h"
+
+dev::MemCounters::~MemCounters()
+{
+	for (auto& pageA : m_pages)
+	{
+		auto pageP = pageA.load(std::memory_order_relaxed);
+		if (!pageP) continue;
+
+		delete pageP->highP.load(std::memory_order_relaxed);
+		delete pageP;
+	}
+}
+
+// Hardware thread
+auto dev::MemCounters::AllocPage(const size_t _page)
+-> Page*
+{
+	auto pageP = new Page();
+	// the readers see the zeroed counters before the page
+	m_pages[_page].store(pageP, std::memory_order_release);
+	m_pagesLen.fetch_add(1, std::memory_order_relaxed);
+	return pageP;
+}
+
+// Hardware thread
+void dev::MemCounters::Carry(Page& _page, const GlobalAddr _idx)
+{
+	auto highP = _page.highP.load(std::memory_order_relaxed);
+	if (!highP)
+	{
+		highP = new Counters();
+		_page.highP.store(highP, std::memory_order_release);
+	}
+	(*highP)[_idx]++;
+}
+
+// Hardware thread
+void dev::MemCounters::Reset()
+{
+	for (auto& pageA : m_pages)
+	{
+		auto pageP = pageA.load(std::memory_order_relaxed);
+		if (!pageP) continue;
+
+		pageP->low.fill(0);
+		auto highP = pageP->highP.load(std::memory_order_relaxed);
+		if (highP) highP->fill(0);
+	}
+}
+
+// any thread
+auto dev::MemCounters::Get(const GlobalAddr _globalAddr) const
+-> uint64_t
+{
+	if ((_globalAddr >> PAGE_BITS) >= PAGES) return 0;
+
+	auto pageP = m_pages[_globalAddr >> PAGE_BITS].load(std::memory_order_acquire);
+	if (!pageP) return 0;
+
+	auto idx = _globalAddr & PAGE_MASK;
+	uint64_t counter = pageP->low[idx];
+	auto highP = pageP->highP.load(std::memory_order_acquire);
+	if (highP) counter |= uint64_t((*highP)[idx]) << 32;
+
+	return counter;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "utils/types.h"
+#include "core/memory.h"
+
+namespace dev
+{
+	// the access counters of every global memory address.
+	// Only the touched 256-byte pages are allocated, so the counters of a typical program take kilobytes.
+	// A counter is 32-bit, its carry goes to a 32-bit high word that is allocated on the first overflow in the page.
+	// The Hardware thread increments the counters, the other threads only read them
+	class MemCounters
+	{
+	public:
+		MemCounters() = default;
+		~MemCounters();
+		MemCounters(const MemCounters&) = delete;
+		MemCounters& operator=(const MemCounters&) = delete;
+
+		// Hardware thread
+		inline void Add(const GlobalAddr _globalAddr, const uint32_t _val)
+		{
+			auto pageP = m_pages[_globalAddr >> PAGE_BITS].load(std::memory_order_relaxed);
+			if (!pageP) [[unlikely]] pageP = AllocPage(_globalAddr >> PAGE_BITS);
+
+			auto idx = _globalAddr & PAGE_MASK;
+			auto& low = pageP->low[idx];
+			low += _val;
+			if (low < _val) [[unlikely]] Carry(*pageP, idx);
+		}
+		inline void Inc(const GlobalAddr _globalAddr) { Add(_globalAddr, 1); }
+		// Hardware thread. Zeroes the counters, keeps the pages allocated
+		void Reset();
+
+		// any thread
+		auto Get(const GlobalAddr _globalAddr) const -> uint64_t;
+		auto GetPagesLen() const -> size_t { return m_pagesLen.load(std::memory_order_relaxed); }
+		// any thread. Calls _func(globalAddr, counter) for every non-zero counter
+		template <typename Func>
+		void ForEach(Func&& _func) const
+		{
+			for (size_t page = 0; page < PAGES; page++)
+			{
+				auto pageP = m_pages[page].load(std::memory_order_acquire);
+				if (!pageP) continue;
+
+				auto highP = pageP->highP.load(std::memory_order_acquire);
+				for (GlobalAddr idx = 0; idx < PAGE_LEN; idx++)
+				{
+					uint64_t counter = pageP->low[idx];
+					if (highP) counter |= uint64_t((*highP)[idx]) << 32;
+					if (counter) _func(GlobalAddr(page << PAGE_BITS) | idx, counter);
+				}
+			}
+		}
+
+	private:
+		static constexpr int PAGE_BITS = 8;
+		static constexpr GlobalAddr PAGE_LEN = 1 << PAGE_BITS;
+		static constexpr GlobalAddr PAGE_MASK = PAGE_LEN - 1;
+		static constexpr size_t PAGES = Memory::MEMORY_GLOBAL_LEN >> PAGE_BITS;
+
+		using Counters = std::array<uint32_t, PAGE_LEN>;
+		struct Page
+		{
+			Counters low = {};
+			std::atomic<Counters*> highP = nullptr;
+		};
+
+		auto AllocPage(const size_t _page) -> Page*;
+		void Carry(Page& _page, const GlobalAddr _idx);
+
+		std::array<std::atomic<Page*>, PAGES> m_pages = {};
+		std::atomic<size_t> m_pagesLen = 0;
+	};
+}
@@ -11,6 +11,9 @@ dev::Memory::Memory(const std::string& _pathBootData, const std::string& _pathRa
 	auto res = dev::LoadFile(dev::GetExecutableDir() + _pathBootData);
 	if (res) m_rom = *res;
 
+	// an empty path keeps the RamDisk in memory only
+	if (_pathRamDiskData.empty()) return;
+
 	res = dev::LoadFile(dev::GetExecutableDir() + _pathRamDiskData);
 	if (res) {
 		RamDiskData ramDiskData = *res;
@@ -22,6 +25,7 @@ dev::Memory::Memory(const std::string& _pathBootData, const std::string& _pathRa
 dev::Memory::~Memory()
 {
 	// store RamDisk
+	if (m_pathRamDiskData.empty()) return;
 	RamDiskData ramDiskData(m_ram.begin() + MEMORY_MAIN_LEN, m_ram.end());
 	dev::SaveFile(m_pathRamDiskData, ramDiskData, true);
 }
@@ -77,6 +81,7 @@ auto dev::Memory::CpuReadInstr(const Addr _addr, const AddrSpace _addrSpace,
 
 	m_state.debug.instrGlobalAddr = _byteNum == 0 ? globalAddr : m_state.debug.instrGlobalAddr;
 	m_state.debug.instr[_byteNum] = val;
+	m_state.debug.instrLen = _byteNum + 1;
 
 	return val;
 }
@@ -111,6 +116,10 @@ void dev::Memory::CpuWrite(const Addr _addr, uint8_t _value,
 
 	m_state.debug.write[_byteNum] = _value;
 
+	if (ScreenWrite && globalAddr >= SCREEN_ADDR && globalAddr < MEMORY_MAIN_LEN) {
+		ScreenWrite(m_screenWriteContextP);
+	}
+
 	// store byte
 	m_ram[globalAddr] = _value;
 }
@@ -133,21 +142,28 @@ auto dev::Memory::GetRam() const -> const Ram* { return &m_ram; }
 // converts the addr to a global addr depending on the ram/stack mapping modes
 auto dev::Memory::GetGlobalAddr(const Addr _addr, const AddrSpace _addrSpace) const
 -> GlobalAddr
+{
+	return GetGlobalAddr(_addr, _addrSpace, m_state.update);
+}
+
+// the same conversion using the mapping captured along with a copy of the memory
+auto dev::Memory::GetGlobalAddr(const Addr _addr, const AddrSpace _addrSpace, const Update& _update)
+-> GlobalAddr
 {
 	// if no mapping enabled, return _addr
-	if (!(m_state.update.mapping.data & MAPPING_MODE_MASK)) return _addr;
+	if (!(_update.mapping.data & MAPPING_MODE_MASK)) return _addr;
 
 	// check the STACK mapping
-	if (m_state.update.mapping.modeStack && _addrSpace == AddrSpace::STACK)
+	if (_update.mapping.modeStack && _addrSpace == AddrSpace::STACK)
 	{
-		return _addr + (m_state.update.mapping.pageStack + 1 + m_state.update.ramdiskIdx * 4) * RAM_DISK_PAGE_LEN;
+		return _addr + (_update.mapping.pageStack + 1 + _update.ramdiskIdx * 4) * RAM_DISK_PAGE_LEN;
 	}
 	// the ram mapping can be applied to a stack operation as well if the addr falls into the ram-mapping range
-	if ((m_state.update.mapping.modeRamA && _addr >= 0xA000 && _addr < 0xE000) ||
-		(m_state.update.mapping.modeRam8 && _addr >= 0x8000 && _addr < 0xA000) ||
-		(m_state.update.mapping.modeRamE && _addr >= 0xE000))
+	if ((_update.mapping.modeRamA && _addr >= 0xA000 && _addr < 0xE000) ||
+		(_update.mapping.modeRam8 && _addr >= 0x8000 && _addr < 0xA000) ||
+		(_update.mapping.modeRamE && _addr >= 0xE000))
 	{
-		return _addr + (m_state.update.mapping.pageRam + 1 + m_state.update.ramdiskIdx * 4) * RAM_DISK_PAGE_LEN;
+		return _addr + (_update.mapping.pageRam + 1 + _update.ramdiskIdx * 4) * RAM_DISK_PAGE_LEN;
 	}
 
 	return _addr;
@@ -183,4 +199,20 @@ bool dev::Memory::IsException()
 	return out;
 }
 
-bool dev::Memory::IsRomEnabled() const { return m_state.update.memType == MemType::ROM; };
\ No newline at end of file
+bool dev::Memory::IsRomEnabled() const { return m_state.update.memType == MemType::ROM; };
+
+void dev::Memory::StoreState(SaveState& _state) const
+{
+	_state.ram = m_ram;
+	std::copy(std::begin(m_mappings), std::end(m_mappings), _state.mappings);
+	_state.update = m_state.update;
+	_state.mappingsEnabled = m_mappingsEnabled;
+}
+
+void dev::Memory::RestoreState(const SaveState& _state)
+{
+	m_ram = _state.ram;
+	std::copy(std::begin(_state.mappings), std::end(_state.mappings), m_mappings);
+	m_state.update = _state.update;
+	m_mappingsEnabled = _state.mappingsEnabled;
+}
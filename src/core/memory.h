@@ -20,6 +20,10 @@ namespace dev
 		using Rom = std::vector<uint8_t>;
 		using Ram = std::array<uint8_t, MEMORY_GLOBAL_LEN>;
 		using RamDiskData = std::vector<uint8_t>;
+		// called before the cpu writes the screen memory. A plain pointer keeps the write path cheap
+		using ScreenWriteFunc = void(*)(void* _contextP);
+
+		static constexpr GlobalAddr SCREEN_ADDR = 0x8000; // the screen buffers occupy the main ram from here to its end
 
 #pragma pack(push, 1)
 		// RAM-mapping is applied if the RAM-mapping is enabled, the ram accesssed via non-stack instructions, and the addr falls into the RAM-mapping range associated with that particular RAM mapping
@@ -97,6 +101,15 @@ namespace dev
 		};
 #pragma pack(pop)
 
+		// the memory part of the machine state to clone it
+		struct SaveState
+		{
+			Ram ram;
+			Mapping mappings[RAM_DISK_MAX];
+			Update update;
+			int mappingsEnabled = 0;
+		};
+
 		Memory(const std::string& _pathBootData, const std::string& _pathRamDiskData, const bool _ramDiskClearAfterRestart);
 		~Memory();
 		void Init();
@@ -114,6 +127,7 @@ namespace dev
 		auto GetScreenBytes(Addr _screenAddrOffset) const -> uint32_t;
 		auto GetRam() const -> const Ram*;
 		auto GetGlobalAddr(const Addr _addr, const AddrSpace _addrSpace) const -> GlobalAddr;
+		static auto GetGlobalAddr(const Addr _addr, const AddrSpace _addrSpace, const Update& _update) -> GlobalAddr;
 		auto GetState() const -> const State& { return m_state; };
 		auto GetStateP() -> State* { return &m_state; };
 		auto GetMappingsP() const -> const Mapping* { return m_mappings; };
@@ -124,8 +138,13 @@ namespace dev
 		bool IsException();
 		bool IsRomEnabled() const;
 		inline void DebugInit() { m_state.debug.Init(); };
+		void StoreState(SaveState& _state) const;
+		void RestoreState(const SaveState& _state);
+		void SetScreenWriteFunc(ScreenWriteFunc _func, void* _contextP) { ScreenWrite = _func; m_screenWriteContextP = _contextP; };
 
 	private:
+		ScreenWriteFunc ScreenWrite = nullptr;
+		void* m_screenWriteContextP = nullptr;
 
 		Ram m_ram;
 		Rom m_rom;
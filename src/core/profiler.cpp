@@ -0,0 +1,356 @@
+#include <algorithm>
+#include <format>
+
+#include "core/profiler.h"
+
+dev::Profiler::Profiler()
+{
+	m_nodes.reserve(NODES_MAX);
+	m_stack.reserve(DEPTH_MAX);
+	m_regions.push_back({ RegionType::IRQ, 0x38, 0x38, 0xFF404080, "interrupt" });
+	Reset(CpuI8080::State{});
+}
+
+// Hardware thread
+void dev::Profiler::Reset(const CpuI8080::State& _cpuState)
+{
+	m_nodes.clear();
+	m_nodes.push_back({});
+	m_children.clear();
+	m_stack.clear();
+	m_stack.push_back({});
+	m_hotSpots.Reset();
+	m_lastCC = _cpuState.cc;
+	m_lastSP = _cpuState.regs.sp.word;
+	m_lastInte = _cpuState.ints.inte;
+	RasterReset();
+}
+
+// Hardware thread
+void dev::Profiler::Update(const CpuI8080::State& _cpuState, const Memory::State& _memState,
+	const Display::State& _displayState)
+{
+	// the cycles of the instruction belong to the caller of CALL and to the callee of RET
+	// the recorder playback moves the time back
+	uint64_t cc = _cpuState.cc >= m_lastCC ? _cpuState.cc - m_lastCC : 0;
+	m_lastCC = _cpuState.cc;
+	m_nodes[m_stack.back().node].exclusiveCC += cc;
+	m_hotSpots.Add(_memState.debug.instrGlobalAddr, static_cast<uint32_t>(cc));
+
+	m_beam = _displayState.update.framebufferIdx;
+	if (_displayState.update.frameNum != m_frameNum) RasterNewFrame(_displayState.update.frameNum);
+
+	// the interrupt executes RST7 and disables the interrupts
+	uint8_t opcode = _cpuState.regs.ir;
+	bool irq = opcode == CpuI8080::OPCODE_RST7 && m_lastInte && !_cpuState.ints.inte;
+	m_lastInte = _cpuState.ints.inte;
+
+	if (opcode == CpuI8080::OPCODE_HLT) m_hlt = true;
+	if (irq)
+	{
+		m_rasterFrames[m_rasterFrameIdx].overrun |= !m_hlt;
+		m_hlt = false;
+	}
+
+	Addr pc = _cpuState.regs.pc.word;
+	Addr sp = _cpuState.regs.sp.word;
+	Addr lastSP = m_lastSP;
+	m_lastSP = sp;
+
+	for (size_t i = 0; m_rangesLen && i < m_regions.size(); i++)
+	{
+		const auto& region = m_regions[i];
+		if (region.type != RegionType::RANGE) continue;
+
+		auto& span = m_rangeSpans[i];
+		bool inside = pc >= region.addr && pc <= region.addrEnd;
+		if (inside && span.region < 0) SpanOpen(span, static_cast<int>(i));
+		else if (!inside && span.region >= 0) SpanClose(span);
+	}
+
+	bool call = opcode == 0xCD || opcode == 0xDD || opcode == 0xED || opcode == 0xFD || // CALL and its aliases
+		(opcode & 0xC7) == 0xC4 || // Ccc
+		(opcode & 0xC7) == 0xC7; // RST
+	bool ret = opcode == 0xC9 || opcode == 0xD9 || // RET and its alias
+		(opcode & 0xC7) == 0xC0; // Rcc
+
+	// the conditional ones are taken if they moved the stack
+	if (call && sp == Addr(lastSP - 2))
+	{
+		int region = -1;
+		if (irq) region = REGION_IRQ;
+		else
+		{
+			for (size_t i = 0; i < m_regions.size() && region < 0; i++)
+			{
+				if (m_regions[i].type == RegionType::FUNC && m_regions[i].addr == pc) region = static_cast<int>(i);
+			}
+		}
+		Call(pc, sp, region);
+	}
+	else if (ret && sp == Addr(lastSP + 2)) Return(lastSP);
+}
+
+void dev::Profiler::Call(const Addr _func, const Addr _retSP, const int _region)
+{
+	// the frames above the new return address were discarded without returning
+	auto len = m_stack.size();
+	while (len > 1 && m_stack[len - 1].retSP <= _retSP) len--;
+	PopFrames(len);
+
+	if (m_stack.size() >= DEPTH_MAX) return;
+
+	uint32_t parent = m_stack.back().node;
+	uint64_t key = uint64_t(parent) << 32 | _func;
+	uint32_t node;
+
+	auto it = m_children.find(key);
+	if (it != m_children.end()) {
+		node = it->second;
+	}
+	else {
+		if (m_nodes.size() >= NODES_MAX) return;
+
+		node = static_cast<uint32_t>(m_nodes.size());
+		m_nodes.push_back({ _func, parent, 0, 0 });
+		m_children.emplace(key, node);
+	}
+
+	m_nodes[node].calls++;
+	m_stack.push_back({ node, _retSP, {} });
+	if (_region >= 0) SpanOpen(m_stack.back().span, _region);
+}
+
+void dev::Profiler::Return(const Addr _retSP)
+{
+	// a return address not pushed by a tracked call is a jump
+	for (size_t i = m_stack.size() - 1; i > 0; i--)
+	{
+		if (m_stack[i].retSP != _retSP) continue;
+		PopFrames(i);
+		return;
+	}
+}
+
+void dev::Profiler::PopFrames(const size_t _len)
+{
+	for (size_t i = m_stack.size(); i-- > _len;)
+	{
+		if (m_stack[i].span.region >= 0) SpanClose(m_stack[i].span);
+	}
+	m_stack.resize(_len);
+}
+
+//////////////////////////////////////////////////////////////
+//
+// Raster mode
+//
+//////////////////////////////////////////////////////////////
+
+void dev::Profiler::SpanOpen(OpenSpan& _span, const int _region)
+{
+	_span = { _region, m_beam, m_lastCC };
+}
+
+void dev::Profiler::SpanClose(OpenSpan& _span)
+{
+	AddSpan(_span.region, _span.start, m_beam, m_lastCC - _span.cc);
+	_span.region = -1;
+}
+
+void dev::Profiler::AddSpan(const int _region, const uint32_t _start, const uint32_t _end, const uint64_t _cc)
+{
+	auto& rasterFrame = m_rasterFrames[m_rasterFrameIdx];
+	if (rasterFrame.spansLen >= SPANS_MAX) return;
+
+	rasterFrame.spans[rasterFrame.spansLen++] = { static_cast<uint8_t>(_region), _start, _end, _cc };
+}
+
+// the unfinished regions are split at the frame end
+void dev::Profiler::RasterNewFrame(const uint64_t _frameNum)
+{
+	if (m_frameNum != FRAME_NONE)
+	{
+		auto Split = [this](OpenSpan& _span) {
+			if (_span.region < 0) return;
+			AddSpan(_span.region, _span.start, Display::FRAME_LEN, m_lastCC - _span.cc);
+			_span.start = 0;
+			_span.cc = m_lastCC;
+		};
+		for (auto& frame : m_stack) Split(frame.span);
+		for (auto& span : m_rangeSpans) Split(span);
+
+		m_rasterFrameIdx = (m_rasterFrameIdx + 1) % RASTER_FRAMES_MAX;
+		m_rasterFramesLen = std::min(m_rasterFramesLen + 1, RASTER_FRAMES_MAX);
+	}
+
+	m_frameNum = _frameNum;
+	auto& rasterFrame = m_rasterFrames[m_rasterFrameIdx];
+	rasterFrame.frameNum = _frameNum;
+	rasterFrame.overrun = false;
+	rasterFrame.spansLen = 0;
+}
+
+void dev::Profiler::RasterReset()
+{
+	for (auto& frame : m_stack) frame.span.region = -1;
+	for (auto& span : m_rangeSpans) span.region = -1;
+
+	m_rasterFrameIdx = 0;
+	m_rasterFramesLen = 0;
+	m_frameNum = FRAME_NONE;
+	m_hlt = true;
+}
+
+// Hardware thread
+bool dev::Profiler::AddRegion(const Region& _region)
+{
+	if (m_regions.size() >= REGIONS_MAX || _region.type == RegionType::IRQ) return false;
+
+	m_regions.push_back(_region);
+	if (_region.type == RegionType::RANGE) m_rangesLen++;
+	RasterReset();
+	return true;
+}
+
+// Hardware thread
+void dev::Profiler::DelRegion(const size_t _idx)
+{
+	if (_idx == REGION_IRQ || _idx >= m_regions.size()) return;
+
+	if (m_regions[_idx].type == RegionType::RANGE) m_rangesLen--;
+	m_regions.erase(m_regions.begin() + _idx);
+	RasterReset();
+}
+
+auto dev::Profiler::GetRasterFrames(const size_t _len) const
+-> std::vector<RasterFrame>
+{
+	auto len = std::min(_len, m_rasterFramesLen);
+	std::vector<RasterFrame> out;
+	out.reserve(len);
+	for (size_t i = 0; i < len; i++)
+	{
+		out.push_back(m_rasterFrames[(m_rasterFrameIdx + RASTER_FRAMES_MAX - len + i) % RASTER_FRAMES_MAX]);
+	}
+	return out;
+}
+
+auto dev::Profiler::GetTotalCC() const
+-> uint64_t
+{
+	uint64_t totalCC = 0;
+	for (const auto& node : m_nodes) totalCC += node.exclusiveCC;
+	return totalCC;
+}
+
+auto dev::Profiler::GetFuncs() const
+-> std::vector<FuncStats>
+{
+	// a child node is always added after its parent, so the reverse order sums up the callees first
+	std::vector<uint64_t> inclusiveCCs(m_nodes.size());
+	for (size_t i = m_nodes.size(); i-- > 0;)
+	{
+		inclusiveCCs[i] += m_nodes[i].exclusiveCC;
+		if (i != NODE_ROOT) inclusiveCCs[m_nodes[i].parent] += inclusiveCCs[i];
+	}
+
+	std::unordered_map<uint32_t, FuncStats> funcs;
+	for (uint32_t i = 0; i < m_nodes.size(); i++)
+	{
+		const auto& node = m_nodes[i];
+		auto& func = funcs[node.func];
+		func.func = node.func;
+		func.calls += node.calls;
+		func.exclusiveCC += node.exclusiveCC;
+
+		// the recursive calls are already included into the outer call
+		bool recursive = false;
+		for (auto parent = i; parent != NODE_ROOT && !recursive;)
+		{
+			parent = m_nodes[parent].parent;
+			recursive = m_nodes[parent].func == node.func;
+		}
+		if (!recursive) func.inclusiveCC += inclusiveCCs[i];
+	}
+
+	std::vector<FuncStats> out;
+	out.reserve(funcs.size());
+	for (const auto& [func, stats] : funcs) out.push_back(stats);
+
+	std::sort(out.begin(), out.end(), [](const FuncStats& _a, const FuncStats& _b) {
+		return _a.exclusiveCC > _b.exclusiveCC; });
+
+	return out;
+}
+
+auto dev::Profiler::GetHotSpots(const size_t _len) const
+-> std::vector<HotSpot>
+{
+	std::vector<HotSpot> out;
+	m_hotSpots.ForEach([&out](const GlobalAddr _globalAddr, const uint64_t _cc) {
+		out.push_back({ _globalAddr, _cc });
+	});
+
+	auto len = std::min(_len, out.size());
+	std::partial_sort(out.begin(), out.begin() + len, out.end(), [](const HotSpot& _a, const HotSpot& _b) {
+		return _a.cc > _b.cc; });
+	out.resize(len);
+
+	return out;
+}
+
+auto dev::Profiler::GetStacks() const
+-> std::vector<Stack>
+{
+	std::vector<Stack> out;
+	for (uint32_t i = 0; i < m_nodes.size(); i++)
+	{
+		if (m_nodes[i].exclusiveCC == 0) continue;
+
+		Stack stack{ {}, m_nodes[i].exclusiveCC };
+		for (auto node = i; ; node = m_nodes[node].parent)
+		{
+			stack.funcs.push_back(m_nodes[node].func);
+			if (node == NODE_ROOT) break;
+		}
+		std::reverse(stack.funcs.begin(), stack.funcs.end());
+		out.push_back(std::move(stack));
+	}
+	return out;
+}
+
+auto dev::Profiler::GetFuncName(const DebugData& _debugData, const uint32_t _func)
+-> std::string
+{
+	if (_func == FUNC_ROOT) return "root";
+
+	auto labelsP = _debugData.GetLabels(static_cast<Addr>(_func));
+	if (labelsP && !labelsP->empty()) return labelsP->front();
+
+	return std::format("0x{:04X}", _func);
+}
+
+auto dev::Profiler::GetCollapsedStacks(const DebugData& _debugData, const std::vector<Stack>& _stacks)
+-> std::string
+{
+	std::unordered_map<uint32_t, std::string> names;
+	std::string out;
+
+	for (const auto& stack : _stacks)
+	{
+		for (size_t i = 0; i < stack.funcs.size(); i++)
+		{
+			auto func = stack.funcs[i];
+			auto it = names.find(func);
+			if (it == names.end()) it = names.emplace(func, GetFuncName(_debugData, func)).first;
+
+			if (i) out += ';';
+			out += it->second;
+		}
+		out += ' ';
+		out += std::to_string(stack.cc);
+		out += '\n';
+	}
+	return out;
+}
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "utils/types.h"
+#include "core/cpu_i8080.h"
+#include "core/memory.h"
+#include "core/display.h"
+#include "core/mem_counters.h"
+#include "core/debug_data.h"
+
+namespace dev
+{
+	// Attributes the cpu cycles to the functions. The call tree is rebuilt from the executed
+	// CALL, RST, RET instructions and the interrupt entries, a function is identified by its entry address.
+	// A RET returns to the frame its return address was pushed by, so the code that discards
+	// the return addresses or switches the stack doesn't break the tree.
+	// The raster mode records the beam positions the marked code regions start and end at every frame,
+	// the way the border color changes show it on the real hardware
+	class Profiler
+	{
+	public:
+		static constexpr uint32_t FUNC_ROOT = 0x10000; // the code executed outside of any call
+		static constexpr size_t DEPTH_MAX = 64; // the deeper calls are attributed to the deepest frame
+		static constexpr size_t NODES_MAX = 1 << 16; // the call tree size limit
+
+		struct FuncStats
+		{
+			uint32_t func = FUNC_ROOT;
+			uint64_t calls = 0;
+			uint64_t inclusiveCC = 0; // the function and its callees. The recursive calls are counted once
+			uint64_t exclusiveCC = 0; // the function itself
+		};
+
+		struct HotSpot
+		{
+			GlobalAddr globalAddr = 0;
+			uint64_t cc = 0;
+		};
+
+		// a call path from the root, and the cycles spent in its last function
+		struct Stack
+		{
+			std::vector<uint32_t> funcs;
+			uint64_t cc = 0;
+		};
+
+		static constexpr size_t REGIONS_MAX = 16;
+		static constexpr size_t RASTER_FRAMES_MAX = 64; // the frames stored
+		static constexpr size_t SPANS_MAX = 128; // per frame. The rest is dropped
+		static constexpr uint8_t REGION_IRQ = 0; // the interrupt handler, it is always tracked
+
+		// IRQ - from the interrupt to its RET, FUNC - from a call of addr to its RET,
+		// RANGE - while the pc is in [addr, addrEnd]
+		enum class RegionType : uint8_t { IRQ = 0, FUNC, RANGE };
+
+		struct Region
+		{
+			RegionType type = RegionType::RANGE;
+			Addr addr = 0;
+			Addr addrEnd = 0;
+			uint32_t color = 0xFF0000FF; // 0xRRGGBBAA
+			std::string name;
+		};
+
+		// a region execution within a frame
+		struct Span
+		{
+			uint8_t region = REGION_IRQ;
+			uint32_t start = 0; // the beam positions, the frame buffer idxs
+			uint32_t end = 0;
+			uint64_t cc = 0;
+		};
+
+		struct RasterFrame
+		{
+			uint64_t frameNum = 0;
+			bool overrun = false; // the main loop didn't reach HLT before the interrupt
+			size_t spansLen = 0;
+			std::array<Span, SPANS_MAX> spans;
+		};
+
+		Profiler();
+		// Hardware thread. Called after every instruction
+		void Update(const CpuI8080::State& _cpuState, const Memory::State& _memState,
+			const Display::State& _displayState);
+		void Reset(const CpuI8080::State& _cpuState);
+
+		auto GetTotalCC() const -> uint64_t;
+		// sorted by the exclusive cycles
+		auto GetFuncs() const -> std::vector<FuncStats>;
+		// the addresses of the most expensive instructions
+		auto GetHotSpots(const size_t _len) const -> std::vector<HotSpot>;
+		auto GetStacks() const -> std::vector<Stack>;
+
+		// the raster mode. Changing the regions restarts the recording
+		bool AddRegion(const Region& _region);
+		void DelRegion(const size_t _idx);
+		auto GetRegions() const -> const std::vector<Region>& { return m_regions; }
+		// the last recorded frames, the oldest first. The current frame isn't included
+		auto GetRasterFrames(const size_t _len) const -> std::vector<RasterFrame>;
+
+		// the first label of the function or its address
+		static auto GetFuncName(const DebugData& _debugData, const uint32_t _func) -> std::string;
+		// the text format of the flame graph tools. A line per call path: "func0;func1;func2 cycles"
+		static auto GetCollapsedStacks(const DebugData& _debugData, const std::vector<Stack>& _stacks) -> std::string;
+
+	private:
+		static constexpr uint32_t NODE_ROOT = 0;
+
+		struct Node
+		{
+			uint32_t func = FUNC_ROOT;
+			uint32_t parent = NODE_ROOT;
+			uint64_t calls = 0;
+			uint64_t exclusiveCC = 0;
+		};
+
+		// the execution of a region that is not finished yet
+		struct OpenSpan
+		{
+			int region = -1;
+			uint32_t start = 0;
+			uint64_t cc = 0;
+		};
+
+		struct Frame
+		{
+			uint32_t node = NODE_ROOT;
+			Addr retSP = 0; // the stack address of the return address
+			OpenSpan span; // the IRQ and FUNC regions
+		};
+
+		void Call(const Addr _func, const Addr _retSP, const int _region);
+		void Return(const Addr _retSP);
+		void PopFrames(const size_t _len);
+		void RasterNewFrame(const uint64_t _frameNum);
+		void RasterReset();
+		void SpanOpen(OpenSpan& _span, const int _region);
+		void SpanClose(OpenSpan& _span);
+		void AddSpan(const int _region, const uint32_t _start, const uint32_t _end, const uint64_t _cc);
+
+		std::vector<Node> m_nodes;
+		std::unordered_map<uint64_t, uint32_t> m_children; // (parent node << 32 | func) -> node
+		std::vector<Frame> m_stack;
+		MemCounters m_hotSpots; // cycles per instruction address
+		uint64_t m_lastCC = 0;
+		Addr m_lastSP = 0;
+		bool m_lastInte = false;
+
+		static constexpr uint64_t FRAME_NONE = UINT64_MAX;
+
+		std::vector<Region> m_regions;
+		size_t m_rangesLen = 0; // the RANGE regions checked every instruction
+		std::array<OpenSpan, REGIONS_MAX> m_rangeSpans; // the RANGE regions
+		std::array<RasterFrame, RASTER_FRAMES_MAX> m_rasterFrames; // circular buffer
+		size_t m_rasterFrameIdx = 0; // the frame being recorded
+		size_t m_rasterFramesLen = 0; // the recorded frames
+		uint64_t m_frameNum = FRAME_NONE;
+		uint32_t m_beam = 0; // the current frame buffer idx
+		bool m_hlt = false; // HLT was executed since the last interrupt
+	};
+}
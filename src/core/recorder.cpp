@@ -1,10 +1,50 @@
+#include <cstring>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
 #include "core/recorder.h"
 #include "utils/utils.h"
+#include "utils/lz.h"
+
+// the VERSION file is the spill file layout followed by the ram and the index:
+// SpillHeader, the states, each is HwState + MemWrite[writesLen], the keyframes,
+// the ram at the start of the last state, uint64_t offsets[states], SpillKeyframe[keyframes], SpillFooter
+#pragma pack(push, 1)
+struct SpillHeader
+{
+	uint32_t version;
+	uint32_t stateLen; // sizeof(HwState), it guards the layout
+};
+
+struct SpillFooter
+{
+	uint64_t states;
+	uint64_t keyframes;
+	uint64_t ramOffset;
+	uint64_t indexOffset;
+	uint32_t version;
+};
+#pragma pack(pop)
+
+dev::Recorder::~Recorder()
+{
+	m_spillFile.Close();
+	if (!m_spillPath.empty())
+	{
+		std::error_code ec;
+		std::filesystem::remove(m_spillPath, ec);
+	}
+}
 
 void dev::Recorder::Reset(CpuI8080::State* _cpuStateP, Memory::State* _memStateP,
 	IO::State* _ioStateP, Display::State* _displayStateP)
 {
 	m_stateIdx = m_stateRecorded = m_stateCurrent = 0;
+	m_writesEnd = 0;
+	m_keyframes.clear();
+	ResetSpill();
 	m_lastRecord = true;
 	m_frameNum = _displayStateP->update.frameNum; 
 	StoreState(*_cpuStateP, *_memStateP, *_ioStateP, *_displayStateP);
@@ -13,13 +53,17 @@ void dev::Recorder::Reset(CpuI8080::State* _cpuStateP, Memory::State* _memStateP
 // continue HW execution
 void dev::Recorder::CleanMemUpdates(Display::State* _displayStateP)
 {
+	if (m_spillCurrent) TruncateSpill();
+
 	m_lastRecord = true;
 	m_stateRecorded = m_stateCurrent;
 	auto& state = m_states[m_stateIdx];
 
-	state.memBeforeWrites.clear();
-	state.memWrites.clear();
-	state.globalAddrs.clear();
+	// the frame is executed again from its start, the later records are discarded
+	m_writesEnd = state.writesStart;
+	state.writesLen = 0;
+	// the display state was restored with the frame
+	m_frameNum = _displayStateP->update.frameNum;
 
 	_displayStateP->BuffUpdate(Display::Buffer::BACK_BUFFER);
 }
@@ -43,18 +87,37 @@ void dev::Recorder::StoreMemoryDiff(const Memory::State& _memState)
 	
 	for (int i = 0; i < _memState.debug.writeLen; i++)
 	{
-		state.memBeforeWrites.push_back(_memState.debug.beforeWrite[i]);
-		state.memWrites.push_back(_memState.debug.write[i]);
-		state.globalAddrs.push_back(_memState.debug.writeGlobalAddr[i]);
+		// the oldest frame records are about to be overwritten
+		while (m_stateRecorded > 1 && 
+			m_writesEnd - m_states[GetFirstStateIdx()].writesStart >= WRITES_MAX)
+		{
+			DropOldestState();
+		}
+
+		GetWrite(m_writesEnd++) = { _memState.debug.writeGlobalAddr[i],
+			_memState.debug.beforeWrite[i], _memState.debug.write[i] };
+		state.writesLen++;
 	}
 }
 
+void dev::Recorder::DropOldestState()
+{
+	SpillOldestState();
+	m_stateRecorded--;
+	m_stateCurrent = dev::Max(m_stateCurrent - 1, size_t(1));
+}
+
 void dev::Recorder::StoreState(const CpuI8080::State& _cpuState, const Memory::State& _memState, 
 	const IO::State& _ioState, const Display::State& _displayState)
 {
+	uint64_t serial = m_stateRecorded ? m_states[m_stateIdx].serial + 1 : 0;
+
+	// the ring is full, the oldest state is overwritten
+	if (m_stateRecorded == STATES_LEN) DropOldestState();
+
 	// prepare for the next state
 	m_stateIdx = (m_stateIdx + 1) % STATES_LEN;
-	m_stateCurrent = dev::Min(m_stateCurrent + 1, STATES_LEN);
+	m_stateCurrent++;
 	m_stateRecorded = m_stateCurrent;
 
 	auto& nextState = m_states[m_stateIdx];
@@ -63,26 +126,101 @@ void dev::Recorder::StoreState(const CpuI8080::State& _cpuState, const Memory::S
 	nextState.memState = _memState.update;
 	nextState.ioState = _ioState;
 	nextState.displayState = _displayState.update;
-	nextState.memBeforeWrites.clear();
-	nextState.memWrites.clear();
-	nextState.globalAddrs.clear();
+	nextState.serial = serial;
+	nextState.writesStart = m_writesEnd;
+	nextState.writesLen = 0;
+
+	// the ram isn't copied every frame. The write log of the states is enough to restore it.
+	// The keyframes only speed up the seek
+
+	// the keyframes of the discarded and the dropped states
+	while (!m_keyframes.empty() && m_keyframes.back().serial >= serial) m_keyframes.pop_back();
+	while (!m_keyframes.empty() && GetStateNum(m_keyframes.front().serial) < 1) m_keyframes.pop_front();
+
+	if (serial % KEYFRAME_PERIOD == 0)
+	{
+		m_keyframes.push_back({ serial, {} });
+		LzCompress(_memState.ramP->data(), _memState.ramP->size(), m_keyframes.back().ram);
+		DropKeyframesOverBudget();
+	}
+}
 
-	// store the ram
-	m_ram = *_memState.ramP;
+// the keyframe of the newest state stays
+void dev::Recorder::DropKeyframesOverBudget()
+{
+	while (m_keyframes.size() > 1 && GetKeyframesLen() > KEYFRAMES_MEM_MAX)
+	{
+		auto serial = m_keyframes.front().serial;
+		while (m_stateRecorded > 1 && GetStateNum(serial) >= 1) DropOldestState();
+		// the spill takes the keyframe with its state
+		if (!m_keyframes.empty() && m_keyframes.front().serial == serial) m_keyframes.pop_front();
+	}
+}
+
+auto dev::Recorder::GetKeyframesLen() const
+-> size_t
+{
+	size_t len = 0;
+	for (const auto& keyframe : m_keyframes) len += keyframe.ram.size();
+	return len;
 }
 
 void dev::Recorder::RestoreState(CpuI8080::State* _cpuStateP, Memory::State* _memStateP,
 	IO::State* _ioStateP, Display::State* _displayStateP)
 {
-	auto& state = m_states[m_stateIdx];
+	RestoreState(m_states[m_stateIdx], _cpuStateP, _memStateP, _ioStateP, _displayStateP);
+}
+
+void dev::Recorder::RestoreState(const HwState& _state, CpuI8080::State* _cpuStateP, Memory::State* _memStateP,
+	IO::State* _ioStateP, Display::State* _displayStateP)
+{
+	*_cpuStateP = _state.cpuState;
+	_memStateP->update = _state.memState;
+	*_ioStateP = _state.ioState;
+	_displayStateP->update = _state.displayState;
+}
+
+void dev::Recorder::ApplyWrites(const HwState& _state, const MemWrite* _spillWritesP, uint8_t* _ramP, 
+	const bool _forward) const
+{
+	auto GetStateWrite = [&](const uint32_t _i) -> const MemWrite& {
+		return _spillWritesP ? _spillWritesP[_i] : GetWrite(_state.writesStart + _i);
+	};
+
+	if (_forward)
+	{
+		for (uint32_t i = 0; i < _state.writesLen; i++)
+		{
+			const auto& write = GetStateWrite(i);
+			_ramP[write.GetGlobalAddr()] = write.after;
+		}
+		return;
+	}
 
-	*_cpuStateP = state.cpuState;
-	_memStateP->update = state.memState;
-	*_ioStateP = state.ioState;
-	_displayStateP->update = state.displayState;
+	for (uint32_t i = _state.writesLen; i > 0; i--)
+	{
+		const auto& write = GetStateWrite(i - 1);
+		_ramP[write.GetGlobalAddr()] = write.before;
+	}
+}
+
+void dev::Recorder::RedoWrites(const size_t _stateNum, const size_t _stateNumEnd, uint8_t* _ramP) const
+{
+	for (size_t stateNum = _stateNum; stateNum < _stateNumEnd; stateNum++)
+	{
+		if (stateNum <= GetSpilled()) {
+			ApplyWrites(GetSpillState(stateNum), GetSpillWrites(stateNum), _ramP, true);
+		}
+		else {
+			ApplyWrites(GetRingState(stateNum - GetSpilled()), nullptr, _ramP, true);
+		}
+	}
+}
 
-	// store the ram
-	m_ram = *_memStateP->ramP;
+auto dev::Recorder::GetRingState(const size_t _stateNum) const
+-> const HwState&
+{
+	return m_states[(GetFirstStateIdx() + _stateNum - 1) % STATES_LEN];
 }
 
 void dev::Recorder::PlayForward(const int _frames, CpuI8080::State* _cpuStateP, Memory::State* _memStateP,
@@ -90,7 +228,23 @@ void dev::Recorder::PlayForward(const int _frames, CpuI8080::State* _cpuStateP,
 {
 	for (int i = 0; i < _frames; i++)
 	{
-		
+		// the spilled states go first, the ring stays at its first state
+		if (m_spillCurrent)
+		{
+			ApplyWrites(GetSpillState(m_spillCurrent), GetSpillWrites(m_spillCurrent), _memStateP->ramP->data(), true);
+
+			if (m_spillCurrent == GetSpilled())
+			{
+				m_spillCurrent = 0;
+				RestoreState(_cpuStateP, _memStateP, _ioStateP, _displayStateP);
+			}
+			else {
+				m_spillCurrent++;
+				RestoreState(GetSpillState(m_spillCurrent), _cpuStateP, _memStateP, _ioStateP, _displayStateP);
+			}
+			continue;
+		}
+
 		if (m_stateCurrent == m_stateRecorded)
 		{
 			m_lastRecord = false; // we play forward only to the start of the frame
@@ -98,25 +252,13 @@ void dev::Recorder::PlayForward(const int _frames, CpuI8080::State* _cpuStateP,
 		}
 
 		// restore the memory of the current state
-		auto& state = m_states[m_stateIdx];
-		auto& ram = *(_memStateP->ramP);
-
-		for (int i = 0; i < state.globalAddrs.size(); i++)
-		{
-			GlobalAddr globalAddr = state.globalAddrs[i];
-			uint8_t val = state.memWrites[i];
-			ram[globalAddr] = val;
-		}
+		ApplyWrites(m_states[m_stateIdx], nullptr, _memStateP->ramP->data(), true);
 
 		m_stateIdx = (m_stateIdx + 1) % STATES_LEN;
 		m_stateCurrent++;
 
 		// restore the HW state of the next frame (+ one executed intruction)
-		auto& stateNext = m_states[m_stateIdx];
-		*_cpuStateP = stateNext.cpuState;
-		_memStateP->update = stateNext.memState;
-		*_ioStateP = stateNext.ioState;
-		_displayStateP->update = stateNext.displayState;
+		RestoreState(_cpuStateP, _memStateP, _ioStateP, _displayStateP);
 	}
 
 	_displayStateP->BuffUpdate(Display::Buffer::FRAME_BUFFER);
@@ -127,8 +269,18 @@ void dev::Recorder::PlayReverse(const int _frames, CpuI8080::State* _cpuStateP,
 {
 	for (int i = 0; i < _frames; i++)
 	{
-		if (m_stateCurrent == 1 && !m_lastRecord) {
-			break;
+		if (m_spillCurrent == 1) break;
+
+		if (m_spillCurrent || (m_stateCurrent == 1 && !m_lastRecord))
+		{
+			if (!GetSpilled()) break;
+
+			// the previous state is spilled
+			m_spillCurrent = m_spillCurrent ? m_spillCurrent - 1 : GetSpilled();
+			auto state = GetSpillState(m_spillCurrent);
+			RestoreState(state, _cpuStateP, _memStateP, _ioStateP, _displayStateP);
+			ApplyWrites(state, GetSpillWrites(m_spillCurrent), _memStateP->ramP->data(), false);
+			continue;
 		}
 
 		if (m_lastRecord)
@@ -136,77 +288,187 @@ void dev::Recorder::PlayReverse(const int _frames, CpuI8080::State* _cpuStateP,
 			m_lastRecord = false;
 		}
 		else {
-			m_stateIdx = (m_stateIdx - 1) % STATES_LEN;
+			m_stateIdx = (m_stateIdx + STATES_LEN - 1) % STATES_LEN;
 			m_stateCurrent--;
 		}
 
 		// restore the HW state to the start of the frame + one executed intruction
-		auto& state = m_states[m_stateIdx];
-		*_cpuStateP = state.cpuState;
-		_memStateP->update = state.memState;
-		*_ioStateP = state.ioState;
-		_displayStateP->update = state.displayState;
-		auto& ram = *(_memStateP->ramP);
-
-		for (int i = state.globalAddrs.size() - 1; i >= 0; i--)
-		{
-			GlobalAddr globalAddr = state.globalAddrs[i];
-			uint8_t val = state.memBeforeWrites[i];
-			ram[globalAddr] = val;
-		}
+		RestoreState(_cpuStateP, _memStateP, _ioStateP, _displayStateP);
+		ApplyWrites(m_states[m_stateIdx], nullptr, _memStateP->ramP->data(), false);
 	}
 
 	_displayStateP->BuffUpdate(Display::Buffer::FRAME_BUFFER);
 }
 
-void dev::Recorder::GetStatesSize()
+void dev::Recorder::SeekToFrame(const size_t _stateNum, CpuI8080::State* _cpuStateP, 
+	Memory::State* _memStateP, IO::State* _ioStateP, Display::State* _displayStateP)
 {
-	m_statesMemSize = 0;
-	for (int i = 0; i < m_stateRecorded; i++)
+	if (m_stateRecorded == 0) return;
+	size_t stateNum = std::clamp(_stateNum, size_t(1), GetStateRecorded());
+
+	// to the start of the live frame
+	if (m_lastRecord) PlayReverse(1, _cpuStateP, _memStateP, _ioStateP, _displayStateP);
+
+	// the nearest keyframe if it's cheaper than replaying from the current state
+	size_t stateCurrent = GetStateCurrent();
+	size_t distance = stateNum > stateCurrent ? stateNum - stateCurrent : stateCurrent - stateNum;
+	const uint8_t* keyframeP = nullptr;
+	size_t keyframeLen = 0;
+	int64_t keyStateNum = 0;
+
+	auto CheckKeyframe = [&](const int64_t _num, const uint8_t* _dataP, const size_t _len)
+	{
+		size_t keyDistance = std::abs(_num - int64_t(stateNum)) + KEYFRAME_SEEK_COST;
+		if (keyDistance >= distance) return;
+
+		distance = keyDistance;
+		keyframeP = _dataP;
+		keyframeLen = _len;
+		keyStateNum = _num;
+	};
+
+	for (const auto& keyframe : m_spillKeyframes)
+	{
+		CheckKeyframe(keyframe.stateNum, m_spillFile.GetData() + keyframe.offset, keyframe.len);
+	}
+
+	for (const auto& keyframe : m_keyframes)
+	{
+		int64_t num = GetStateNum(keyframe.serial);
+		if (num < 1 || num > int64_t(m_stateRecorded)) continue;
+
+		CheckKeyframe(GetSpilled() + num, keyframe.ram.data(), keyframe.ram.size());
+	}
+
+	if (keyframeP)
 	{
-		auto& state = m_states[(m_stateIdx - i) % STATES_LEN];
-		m_statesMemSize += sizeof(state);
-		m_statesMemSize += state.memBeforeWrites.size();
-		m_statesMemSize += state.globalAddrs.size() * sizeof(GlobalAddr);
+		auto& ram = *_memStateP->ramP;
+		if (!LzDecompress(keyframeP, keyframeLen, ram.data(), ram.size()))
+		{
+			dev::Log("Recorder: the keyframe of the state {} is corrupted", keyStateNum);
+			return;
+		}
+
+		if (keyStateNum > int64_t(GetSpilled()))
+		{
+			int64_t ringNum = keyStateNum - GetSpilled();
+			m_stateIdx = (int64_t(m_stateIdx) + STATES_LEN + ringNum - int64_t(m_stateCurrent)) % STATES_LEN;
+			m_stateCurrent = ringNum;
+			m_spillCurrent = 0;
+			RestoreState(_cpuStateP, _memStateP, _ioStateP, _displayStateP);
+		}
+		else {
+			// the ring waits at its first state
+			m_stateIdx = GetFirstStateIdx();
+			m_stateCurrent = 1;
+			m_spillCurrent = keyStateNum;
+			RestoreState(GetSpillState(m_spillCurrent), _cpuStateP, _memStateP, _ioStateP, _displayStateP);
+		}
+	}
+
+	stateCurrent = GetStateCurrent();
+	if (stateNum > stateCurrent) {
+		PlayForward(stateNum - stateCurrent, _cpuStateP, _memStateP, _ioStateP, _displayStateP);
 	}
+	else if (stateNum < stateCurrent) {
+		PlayReverse(stateCurrent - stateNum, _cpuStateP, _memStateP, _ioStateP, _displayStateP);
+	}
+
+	_displayStateP->BuffUpdate(Display::Buffer::FRAME_BUFFER);
+}
+
+auto dev::Recorder::GetMemUsed() const
+-> size_t
+{
+	if (m_stateRecorded == 0) return 0;
+
+	auto& firstState = m_states[GetFirstStateIdx()];
+	size_t memUsed = m_stateRecorded * sizeof(HwState) + (m_writesEnd - firstState.writesStart) * sizeof(MemWrite);
+	memUsed += GetKeyframesLen();
+	// the spill index stays in the ram
+	memUsed += m_spillOffsets.size() * sizeof(uint64_t) + m_spillKeyframes.size() * sizeof(SpillKeyframe);
+
+	return memUsed;
+}
+
+auto dev::Recorder::GetBytesPerFrame() const
+-> size_t
+{
+	return GetStateRecorded() ? (GetMemUsed() + m_spillLen) / GetStateRecorded() : 0;
 }
 
 // on loads
-// requires Reset() after calling it
-void dev::Recorder::Deserialize(const std::vector<uint8_t>& _data, 
+// requires Reset() after calling it. Returns false if the data is corrupted
+bool dev::Recorder::Deserialize(const std::vector<uint8_t>& _data, 
 	CpuI8080::State* _cpuStateP, Memory::State* _memStateP, 
 	IO::State* _ioStateP, Display::State* _displayStateP)
 {
+	SpillHeader header;
+	if (_data.size() < sizeof(header)) return false;
+	memcpy(&header, _data.data(), sizeof(header));
+
+	// the VERSION file is used as the spill as is
+	if (header.version == VERSION)
+	{
+		if (!OpenSpill() || !m_spillFile.Reserve(_data.size())) return false;
+		memcpy(m_spillFile.GetData(), _data.data(), _data.size());
+		m_spillLen = _data.size();
+		return LoadSpill(_cpuStateP, _memStateP, _ioStateP, _displayStateP);
+	}
+
 	size_t dataOffset = 0;
 	// format version
-	m_version = *(size_t*)(&_data[dataOffset]);
+	m_version = header.version;
 	dataOffset += sizeof(m_version);
-	if ((m_version & VERSION_MASK) != VERSION) return;
+	if ((m_version & VERSION_MASK) != VERSION_LEGACY) return false;
+
+	// the legacy file has no index, every read is checked against the data left
+	auto Fits = [&](const size_t _len) { return _len <= _data.size() - dataOffset; };
+	auto Corrupted = [&]()
+	{
+		dev::Log("Recorder: the recording is corrupted");
+		Reset(_cpuStateP, _memStateP, _ioStateP, _displayStateP);
+		return false;
+	};
+
+	ResetSpill();
 
 	// ram
-	std::copy(_data.begin() + dataOffset, _data.begin() + Memory::MEMORY_GLOBAL_LEN, m_ram.begin());
+	if (!Fits(Memory::MEMORY_GLOBAL_LEN + sizeof(m_stateRecorded) + sizeof(m_stateCurrent) + sizeof(m_lastRecord))) {
+		return Corrupted();
+	}
+	std::copy(_data.begin() + dataOffset, _data.begin() + dataOffset + Memory::MEMORY_GLOBAL_LEN, _memStateP->ramP->begin());
 	dataOffset += Memory::MEMORY_GLOBAL_LEN;
-	*_memStateP->ramP = m_ram;
 
 	// m_stateRecorded
 	m_stateRecorded = *(size_t*)(&_data[dataOffset]);
 	dataOffset += sizeof(m_stateRecorded);
+	if (m_stateRecorded < 1 || m_stateRecorded > STATES_LEN) return Corrupted();
 	
 	// m_stateIdx
 	m_stateIdx = m_stateRecorded - 1;
 	
-	// m_stateCurrent
-	m_stateCurrent = *(size_t*)(&_data[dataOffset]);
+	// m_stateCurrent, m_lastRecord. The stored ram is at the start of the last state,
+	// so the playback starts there
+	m_stateCurrent = m_stateRecorded;
 	dataOffset += sizeof(m_stateCurrent);
-
-	// m_lastRecord
-	m_lastRecord = *(size_t*)(&_data[dataOffset]);
+	m_lastRecord = false;
 	dataOffset += sizeof(m_lastRecord);
 
 	// states
+	m_writesEnd = 0;
 	for (int stateIdx = 0; stateIdx < m_stateRecorded; stateIdx++)
 	{
 		auto& state = m_states[stateIdx % STATES_LEN];
+		state.serial = stateIdx;
+		state.writesStart = m_writesEnd;
+		state.writesLen = 0;
+
+		if (!Fits(sizeof(CpuI8080::State) + sizeof(Memory::Update) + sizeof(IO::State) +
+			sizeof(Display::Update) + sizeof(int)))
+		{
+			return Corrupted();
+		}
 
 		state.cpuState = *(CpuI8080::State*)(&_data[dataOffset]);
 		dataOffset += sizeof(CpuI8080::State);
@@ -224,86 +486,387 @@ void dev::Recorder::Deserialize(const std::vector<uint8_t>& _data,
 		int memUpdates = *(int*)(&_data[dataOffset]);
 		dataOffset += sizeof(memUpdates);
 		if (memUpdates == 0) continue;
+		if (memUpdates < 0 || !Fits(size_t(memUpdates) * (2 + sizeof(GlobalAddr)))) return Corrupted();
 
-		// mem updates
-		
-		state.memWrites.assign(_data.begin() + dataOffset, _data.begin() + dataOffset + memUpdates);
-		dataOffset += memUpdates;
+		if (m_writesEnd + memUpdates > WRITES_MAX)
+		{
+			dev::Log("Recorder: the recording exceeds the write log budget of {} writes", WRITES_MAX);
+			Reset(_cpuStateP, _memStateP, _ioStateP, _displayStateP);
+			return false;
+		}
 
-		state.memBeforeWrites.assign(_data.begin() + dataOffset, _data.begin() + dataOffset + memUpdates);
-		dataOffset += memUpdates;
+		// mem updates. Stored as the writes, the before writes, and the global addrs
+		auto writesP = _data.data() + dataOffset;
+		auto beforeWritesP = writesP + memUpdates;
+		auto globalAddrsP = reinterpret_cast<const GlobalAddr*>(beforeWritesP + memUpdates);
+		for (int i = 0; i < memUpdates; i++)
+		{
+			GlobalAddr globalAddr;
+			memcpy(&globalAddr, globalAddrsP + i, sizeof(globalAddr));
+			// the playback writes the ram at the addr
+			if (globalAddr >= Memory::MEMORY_GLOBAL_LEN) return Corrupted();
+			GetWrite(m_writesEnd++) = { globalAddr, beforeWritesP[i], writesP[i] };
+		}
+		state.writesLen = memUpdates;
+		dataOffset += memUpdates * (2 + sizeof(GlobalAddr));
+	}
+
+	// the keyframes. The ram is at the start of the last state, it goes back undoing the writes
+	m_keyframes.clear();
+	std::vector<uint8_t> ram(_memStateP->ramP->begin(), _memStateP->ramP->end());
+	for (int64_t stateIdx = m_stateRecorded - 1; stateIdx >= 0; stateIdx--)
+	{
+		const auto& state = m_states[stateIdx % STATES_LEN];
+		if (state.serial % KEYFRAME_PERIOD == 0)
+		{
+			m_keyframes.push_front({ state.serial, {} });
+			LzCompress(ram.data(), ram.size(), m_keyframes.front().ram);
+		}
+		if (stateIdx == 0) break;
 
-		state.globalAddrs.assign(
-			reinterpret_cast<const GlobalAddr*>(_data.data() + dataOffset),
-			reinterpret_cast<const GlobalAddr*>(_data.data() + dataOffset + memUpdates * sizeof(GlobalAddr)));
-		dataOffset += memUpdates * sizeof(GlobalAddr);
+		const auto& prevState = m_states[(stateIdx - 1) % STATES_LEN];
+		for (uint64_t writeIdx = prevState.writesStart + prevState.writesLen; writeIdx > prevState.writesStart; writeIdx--)
+		{
+			const auto& write = GetWrite(writeIdx - 1);
+			ram[write.GetGlobalAddr()] = write.before;
+		}
 	}
+	DropKeyframesOverBudget();
 
 	RestoreState(_cpuStateP, _memStateP, _ioStateP, _displayStateP);
 
 	_displayStateP->BuffUpdate(Display::Buffer::FRAME_BUFFER);
 	//_displayStateP->BuffUpdate(Display::Buffer::BACK_BUFFER);
+	return true;
+}
+
+
+bool dev::Recorder::Load(const std::string& _path,
+	CpuI8080::State* _cpuStateP, Memory::State* _memStateP,
+	IO::State* _ioStateP, Display::State* _displayStateP)
+{
+	std::ifstream file(_path, std::ios::binary | std::ios::ate);
+	if (!file)
+	{
+		dev::Log("Recorder: can't open {}", _path);
+		return false;
+	}
+	size_t len = file.tellg();
+	file.seekg(0);
+
+	SpillHeader header{};
+	if (len < sizeof(header) || !file.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+
+	if (header.version != VERSION)
+	{
+		auto result = dev::LoadFile(_path);
+		if (!result || result->empty()) return false;
+
+		return Deserialize(*result, _cpuStateP, _memStateP, _ioStateP, _displayStateP);
+	}
+
+	// the file is read straight into the spill
+	if (!OpenSpill() || !m_spillFile.Reserve(len)) return false;
+	file.seekg(0);
+	if (!file.read(reinterpret_cast<char*>(m_spillFile.GetData()), len))
+	{
+		Reset(_cpuStateP, _memStateP, _ioStateP, _displayStateP);
+		return false;
+	}
+	m_spillLen = len;
+
+	return LoadSpill(_cpuStateP, _memStateP, _ioStateP, _displayStateP);
 }
 
 // on save
-auto dev::Recorder::Serialize() const
--> const std::vector<uint8_t>
+// the ram is stored at the start of the last recorded frame. It's reconstructed from the current ram and the write log
+bool dev::Recorder::Save(const std::string& _path, const Memory::State& _memState) const
 {
-	if (m_stateRecorded == 0) return {};
+	if (m_stateRecorded == 0) return false;
+
+	std::ofstream file(_path, std::ios::binary);
+	if (!file)
+	{
+		dev::Log("Recorder: can't save {}", _path);
+		return false;
+	}
 
-	std::vector<uint8_t> result;
+	uint64_t offset = 0;
+	auto Write = [&](const void* _dataP, const size_t _len) {
+		file.write(reinterpret_cast<const char*>(_dataP), _len);
+		offset += _len;
+	};
+
+	// the spilled states and their keyframes are already in the file layout
+	std::vector<uint64_t> stateOffsets = m_spillOffsets;
+	std::vector<SpillKeyframe> keyframes = m_spillKeyframes;
+	if (m_spillLen) {
+		Write(m_spillFile.GetData(), m_spillLen);
+	}
+	else {
+		SpillHeader header{ VERSION, sizeof(HwState) };
+		Write(&header, sizeof(header));
+	}
 
-	// format version
-	result.insert(result.end(), reinterpret_cast<const uint8_t*>(&m_version),
-		reinterpret_cast<const uint8_t*>(&m_version + 1));
+	// the ring states
+	for (size_t stateNum = 1; stateNum <= m_stateRecorded; stateNum++)
+	{
+		const auto& state = GetRingState(stateNum);
+		stateOffsets.push_back(offset);
+		Write(&state, sizeof(state));
+		for (uint64_t writeIdx = state.writesStart; writeIdx < state.writesStart + state.writesLen; writeIdx++)
+		{
+			Write(&GetWrite(writeIdx), sizeof(MemWrite));
+		}
+	}
 
-	// ram
-	result.insert(result.end(), m_ram.begin(), m_ram.end());
+	for (const auto& keyframe : m_keyframes)
+	{
+		int64_t num = GetStateNum(keyframe.serial);
+		if (num < 1 || num > int64_t(m_stateRecorded)) continue;
 
-	// m_stateRecorded
-	result.insert(result.end(), reinterpret_cast<const uint8_t*>(&m_stateRecorded),
-		reinterpret_cast<const uint8_t*>(&m_stateRecorded + 1));
+		keyframes.push_back({ GetSpilled() + num, offset, keyframe.ram.size() });
+		Write(keyframe.ram.data(), keyframe.ram.size());
+	}
+
+	// the ram
+	std::vector<uint8_t> ram(_memState.ramP->begin(), _memState.ramP->end());
+	if (m_lastRecord) {
+		// the live frame, undo its writes
+		ApplyWrites(m_states[m_stateIdx], nullptr, ram.data(), false);
+	}
+	else {
+		// rewound to the start of the current frame, redo the writes up to the last recorded frame
+		RedoWrites(GetStateCurrent(), GetStateRecorded(), ram.data());
+	}
+	SpillFooter footer{ stateOffsets.size(), keyframes.size(), offset, 0, VERSION };
+	Write(ram.data(), ram.size());
 
-	// m_stateCurrent
-	result.insert(result.end(), reinterpret_cast<const uint8_t*>(&m_stateCurrent),
-		reinterpret_cast<const uint8_t*>(&m_stateCurrent + 1));
+	// the index
+	footer.indexOffset = offset;
+	Write(stateOffsets.data(), stateOffsets.size() * sizeof(uint64_t));
+	Write(keyframes.data(), keyframes.size() * sizeof(SpillKeyframe));
+	Write(&footer, sizeof(footer));
 
-	// m_lastRecord
-	result.insert(result.end(), reinterpret_cast<const uint8_t*>(&m_lastRecord),
-		reinterpret_cast<const uint8_t*>(&m_lastRecord + 1));
+	return file.good();
+}
 
-	// states
-	int firstStateIdx = (m_stateIdx - m_stateRecorded + 1) % STATES_LEN;
+void dev::Recorder::SetSpill(const bool _enabled, CpuI8080::State* _cpuStateP, Memory::State* _memStateP,
+	IO::State* _ioStateP, Display::State* _displayStateP)
+{
+	if (_enabled == m_spillEnabled) return;
 
-	for (int stateIdx = firstStateIdx; stateIdx < firstStateIdx + m_stateRecorded; stateIdx++)
+	if (_enabled)
 	{
-		const auto& state = m_states[stateIdx % STATES_LEN];
+		m_spillEnabled = OpenSpill();
+		return;
+	}
 
-		result.insert(result.end(), reinterpret_cast<const uint8_t*>(&state.cpuState),
-		 	reinterpret_cast<const uint8_t*>(&state.cpuState + 1));
+	// leave the spilled history before discarding it
+	if (m_spillCurrent) {
+		PlayForward(GetSpilled() - m_spillCurrent + 1, _cpuStateP, _memStateP, _ioStateP, _displayStateP);
+	}
+	m_spillEnabled = false;
+	m_spillFile.Close();
+	ResetSpill();
+}
 
-		result.insert(result.end(), reinterpret_cast<const uint8_t*>(&state.memState),
-			reinterpret_cast<const uint8_t*>(&state.memState + 1));
+bool dev::Recorder::OpenSpill()
+{
+	if (m_spillFile.IsOpen()) return true;
 
-		result.insert(result.end(), reinterpret_cast<const uint8_t*>(&state.ioState),
-			reinterpret_cast<const uint8_t*>(&state.ioState + 1));
+	if (m_spillPath.empty())
+	{
+		std::error_code ec;
+		auto dir = std::filesystem::temp_directory_path(ec);
+		if (ec) return false;
 
-		result.insert(result.end(), reinterpret_cast<const uint8_t*>(&state.displayState),
-			reinterpret_cast<const uint8_t*>(&state.displayState + 1));
+		auto time = std::chrono::steady_clock::now().time_since_epoch().count();
+		auto name = "devector_history_" + std::to_string(time) + "_" + std::to_string(reinterpret_cast<uintptr_t>(this)) + ".rec";
+		m_spillPath = (dir / name).string();
+	}
 
-		// amount of mem updates
-		int memUpdates = state.memWrites.size();
-		result.insert(result.end(), reinterpret_cast<const uint8_t*>(&memUpdates),
-		reinterpret_cast<const uint8_t*>(&memUpdates + 1));
+	if (!m_spillFile.Open(m_spillPath)) return false;
 
-		// mem updates
-		result.insert(result.end(), state.memWrites.begin(), state.memWrites.end());
-		result.insert(result.end(), state.memBeforeWrites.begin(), state.memBeforeWrites.end());
-		result.insert(result.end(),
-			reinterpret_cast<const uint8_t*>(state.globalAddrs.data()),
-			reinterpret_cast<const uint8_t*>(state.globalAddrs.data() + state.globalAddrs.size())
-		);
+	SpillHeader header{ VERSION, sizeof(HwState) };
+	memcpy(m_spillFile.GetData(), &header, sizeof(header));
+	ResetSpill();
+	return true;
+}
+
+void dev::Recorder::ResetSpill()
+{
+	m_spillOffsets.clear();
+	m_spillKeyframes.clear();
+	m_spillCurrent = 0;
+	// the header stays in the file
+	m_spillLen = m_spillFile.IsOpen() ? sizeof(SpillHeader) : 0;
+}
+
+auto dev::Recorder::GetSpillState(const size_t _stateNum) const
+-> HwState
+{
+	HwState state;
+	memcpy(&state, m_spillFile.GetData() + m_spillOffsets[_stateNum - 1], sizeof(state));
+	return state;
+}
+
+auto dev::Recorder::GetSpillWrites(const size_t _stateNum) const
+-> const MemWrite*
+{
+	return reinterpret_cast<const MemWrite*>(m_spillFile.GetData() + m_spillOffsets[_stateNum - 1] + sizeof(HwState));
+}
+
+bool dev::Recorder::SpillAppend(const void* _dataP, const size_t _len)
+{
+	if (!m_spillFile.Reserve(m_spillLen + _len)) return false;
+
+	memcpy(m_spillFile.GetData() + m_spillLen, _dataP, _len);
+	m_spillLen += _len;
+	return true;
+}
+
+// the oldest ring state with its writes and its keyframe is moved to the spill
+void dev::Recorder::SpillOldestState()
+{
+	if (!m_spillEnabled) return;
+
+	const auto& state = m_states[GetFirstStateIdx()];
+	const Keyframe* keyframeP = !m_keyframes.empty() && m_keyframes.front().serial == state.serial ? 
+		&m_keyframes.front() : nullptr;
+
+	size_t len = sizeof(HwState) + state.writesLen * sizeof(MemWrite) + (keyframeP ? keyframeP->ram.size() : 0);
+	if (len > SPILL_MAX - m_spillLen)
+	{
+		dev::Log("Recorder: the spilled history reached {} bytes, it's discarded", SPILL_MAX);
+		ResetSpill();
+	}
+
+	if (!m_spillFile.Reserve(m_spillLen + len))
+	{
+		dev::Log("Recorder: the spill is disabled, the spilled history is discarded");
+		m_spillEnabled = false;
+		m_spillFile.Close();
+		ResetSpill();
+		return;
+	}
+
+	m_spillOffsets.push_back(m_spillLen);
+	SpillAppend(&state, sizeof(state));
+	for (uint64_t writeIdx = state.writesStart; writeIdx < state.writesStart + state.writesLen; writeIdx++)
+	{
+		SpillAppend(&GetWrite(writeIdx), sizeof(MemWrite));
+	}
+
+	if (keyframeP)
+	{
+		m_spillKeyframes.push_back({ GetSpilled(), m_spillLen, keyframeP->ram.size() });
+		SpillAppend(keyframeP->ram.data(), keyframeP->ram.size());
+		m_keyframes.pop_front();
 	}
+}
+
+// on resuming the execution in the spilled history
+void dev::Recorder::TruncateSpill()
+{
+	auto state = GetSpillState(m_spillCurrent);
+
+	// the keyframe of the state moves to the ring
+	m_keyframes.clear();
+	if (!m_spillKeyframes.empty() && m_spillKeyframes.back().stateNum == m_spillCurrent)
+	{
+		const auto& keyframe = m_spillKeyframes.back();
+		auto dataP = m_spillFile.GetData() + keyframe.offset;
+		m_keyframes.push_back({ state.serial, { dataP, dataP + keyframe.len } });
+	}
+	while (!m_spillKeyframes.empty() && m_spillKeyframes.back().stateNum >= m_spillCurrent) m_spillKeyframes.pop_back();
+
+	m_spillLen = m_spillOffsets[m_spillCurrent - 1];
+	m_spillOffsets.resize(m_spillCurrent - 1);
+	m_spillCurrent = 0;
+
+	// the state is the only one in the ring
+	m_writesEnd = 0;
+	state.writesStart = 0;
+	state.writesLen = 0;
+	m_states[m_stateIdx] = state;
+	m_stateRecorded = m_stateCurrent = 1;
+}
+
+bool dev::Recorder::LoadSpill(CpuI8080::State* _cpuStateP, Memory::State* _memStateP,
+	IO::State* _ioStateP, Display::State* _displayStateP)
+{
+	auto dataP = m_spillFile.GetData();
+	SpillHeader header{};
+	SpillFooter footer{};
+	bool valid = m_spillLen >= sizeof(header) + sizeof(HwState) + Memory::MEMORY_GLOBAL_LEN + sizeof(footer);
+	if (valid)
+	{
+		memcpy(&header, dataP, sizeof(header));
+		memcpy(&footer, dataP + m_spillLen - sizeof(footer), sizeof(footer));
+
+		// every field is checked against the file alone, so the sums below can't wrap
+		uint64_t indexEnd = m_spillLen - sizeof(footer);
+		valid = header.version == VERSION && header.stateLen == sizeof(HwState) && footer.version == VERSION &&
+			footer.ramOffset >= sizeof(header) + sizeof(HwState) &&
+			footer.ramOffset <= indexEnd - Memory::MEMORY_GLOBAL_LEN &&
+			footer.indexOffset <= indexEnd &&
+			footer.ramOffset + Memory::MEMORY_GLOBAL_LEN == footer.indexOffset &&
+			footer.states > 0 && footer.states <= (indexEnd - footer.indexOffset) / sizeof(uint64_t) &&
+			footer.keyframes <= (indexEnd - footer.indexOffset - footer.states * sizeof(uint64_t)) / sizeof(SpillKeyframe) &&
+			footer.indexOffset + footer.states * sizeof(uint64_t) + footer.keyframes * sizeof(SpillKeyframe) == indexEnd;
+	}
+
+	// the states and the keyframes precede the ram
+	if (valid)
+	{
+		m_spillOffsets.resize(footer.states);
+		memcpy(m_spillOffsets.data(), dataP + footer.indexOffset, footer.states * sizeof(uint64_t));
+		m_spillKeyframes.resize(footer.keyframes);
+		memcpy(m_spillKeyframes.data(), dataP + footer.indexOffset + footer.states * sizeof(uint64_t),
+			footer.keyframes * sizeof(SpillKeyframe));
 
-	return result;
+		for (size_t stateNum = 1; valid && stateNum <= footer.states; stateNum++)
+		{
+			uint64_t offset = m_spillOffsets[stateNum - 1];
+			auto writesLen = GetSpillState(stateNum).writesLen;
+			valid = offset >= sizeof(header) && offset <= footer.ramOffset - sizeof(HwState) &&
+				uint64_t(writesLen) * sizeof(MemWrite) <= footer.ramOffset - sizeof(HwState) - offset;
+
+			// the playback writes the ram at the addrs
+			auto writesP = GetSpillWrites(stateNum);
+			for (uint32_t i = 0; valid && i < writesLen; i++)
+			{
+				valid = writesP[i].GetGlobalAddr() < Memory::MEMORY_GLOBAL_LEN;
+			}
+		}
+		for (const auto& keyframe : m_spillKeyframes)
+		{
+			valid &= keyframe.stateNum >= 1 && keyframe.stateNum <= footer.states &&
+				keyframe.offset <= footer.ramOffset && keyframe.len <= footer.ramOffset - keyframe.offset;
+		}
+	}
+
+	if (!valid)
+	{
+		dev::Log("Recorder: the recording is corrupted");
+		Reset(_cpuStateP, _memStateP, _ioStateP, _displayStateP);
+		return false;
+	}
+
+	memcpy(_memStateP->ramP->data(), dataP + footer.ramOffset, Memory::MEMORY_GLOBAL_LEN);
+
+	// the last state goes to the ring, the ram is at its start
+	m_stateIdx = 0;
+	m_stateRecorded = m_stateCurrent = 1;
+	m_lastRecord = false;
+	m_spillCurrent = footer.states;
+	TruncateSpill();
+
+	// the later states append to the spill
+	m_spillEnabled = true;
+
+	RestoreState(_cpuStateP, _memStateP, _ioStateP, _displayStateP);
+	_displayStateP->BuffUpdate(Display::Buffer::FRAME_BUFFER);
+	return true;
 }
@@ -2,7 +2,12 @@
 
 #include <cstdint>
 #include <atomic>
+#include <array>
+#include <deque>
+#include <string>
+#include <vector>
 #include "utils/types.h"
+#include "utils/mapped_file.h"
 #include "core/cpu_i8080.h"
 #include "core/memory.h"
 #include "core/io.h"
@@ -16,25 +21,57 @@ namespace dev
 	public:
 		static constexpr int FRAMES_PER_SEC = 50;
 		static constexpr int STATES_LEN = FRAMES_PER_SEC * 60;
-		using MemUpdates = std::vector<uint8_t>;
-		using GlobalAddrs = std::vector<GlobalAddr>;
+		// the write log budget in records. A frame makes at most one write per machine cycle,
+		// 14976 writes, so the budget always holds several frames. The oldest frames are dropped
+		// when the log is full. 8M records take 40 MB
+		static constexpr size_t WRITES_MAX = 1 << 23;
+		// a compressed copy of the ram is stored every KEYFRAME_PERIOD frames.
+		// A seek restores the nearest keyframe and replays at most KEYFRAME_PERIOD / 2 frames
+		static constexpr uint64_t KEYFRAME_PERIOD = 100;
+		// the keyframe decompression costs about as much as replaying that many frames
+		static constexpr size_t KEYFRAME_SEEK_COST = 8;
+		// the compressed keyframes budget. A keyframe of the ram barely compressing takes 2.1 MB.
+		// The oldest frames are dropped with their keyframes when the keyframes exceed it
+		static constexpr size_t KEYFRAMES_MEM_MAX = size_t(32) << 20;
+		// the frames dropped from the memory ring are appended to the spill file when the spill is enabled.
+		// The spill is reached through a memory mapping, so an hours long history costs the disk space.
+		// The spilled history is discarded when the file reaches SPILL_MAX
+		static constexpr uint64_t SPILL_MAX = (uint64_t(1) << 34) < SIZE_MAX ? uint64_t(1) << 34 : SIZE_MAX;
 
 		static constexpr int STATUS_RESET = 0;	// erase the data, stores the first state
 		static constexpr int STATUS_UPDATE = 1;	// enables updating
 		static constexpr int STATUS_RESTORE = 2; // restore the last state
-		// file format version 
-		static constexpr uint32_t VERSION = 1;
+		// file format version. VERSION_LEGACY files store the ram and the states in one blob.
+		// VERSION files are the spill file layout followed by the ram and the index
+		static constexpr uint32_t VERSION_LEGACY = 1;
+		static constexpr uint32_t VERSION = 2;
 		// it checks only first 8 bits of a version
 		static constexpr uint32_t VERSION_MASK = 0xff;
 
+#pragma pack(push, 1)
+		// a memory write record in the write log
+		struct MemWrite
+		{
+			uint8_t addr[3];	// 24-bit little-endian GlobalAddr
+			uint8_t before;		// what was in memory before the write
+			uint8_t after;		// memory after the write
+
+			MemWrite() = default;
+			MemWrite(const GlobalAddr _globalAddr, const uint8_t _before, const uint8_t _after)
+				: addr{ uint8_t(_globalAddr), uint8_t(_globalAddr >> 8), uint8_t(_globalAddr >> 16) },
+				before(_before), after(_after) {}
+			inline auto GetGlobalAddr() const -> GlobalAddr { return addr[0] | addr[1] << 8 | addr[2] << 16; }
+		};
+#pragma pack(pop)
+
 #pragma pack(push, 1)
 		struct HwState
 		{
 			CpuI8080::State cpuState;
 			Memory::Update memState;
-			MemUpdates memBeforeWrites; // what was in memory before writes
-			MemUpdates memWrites; // memory after writes
-			GlobalAddrs globalAddrs; // the global addresses where to restore memory
+			uint64_t serial; // the frame number in the history. It grows by one per state
+			uint64_t writesStart; // the idx of the first write of the frame in the write log, it never wraps
+			uint32_t writesLen;
 			IO::State ioState;
 			Display::Update displayState;
 		};
@@ -42,6 +79,25 @@ namespace dev
 
 		using HwStates = std::array<HwState, STATES_LEN>; // one state per frame
 
+		struct Keyframe
+		{
+			uint64_t serial; // the state it belongs to
+			std::vector<uint8_t> ram; // the lz compressed ram at the start of the frame
+		};
+
+		// a keyframe stored in the spill file
+		struct SpillKeyframe
+		{
+			uint64_t stateNum; // the state it belongs to, from 1 to the amount of the spilled states
+			uint64_t offset;
+			uint64_t len;
+		};
+
+		Recorder() = default;
+		~Recorder();
+		Recorder(const Recorder&) = delete;
+		Recorder& operator=(const Recorder&) = delete;
+
 		void Update(CpuI8080::State* _cpuStateP, Memory::State* _memStateP,
 			IO::State* _ioStateP, Display::State* _displayStateP);
 		void Reset(CpuI8080::State* _cpuStateP, Memory::State* _memStateP,
@@ -50,13 +106,35 @@ namespace dev
 			IO::State* _ioStateP, Display::State* _displayStateP);
 		void PlayReverse(const int _frames, CpuI8080::State* _cpuStateP, Memory::State* _memStateP,
 			IO::State* _ioStateP, Display::State* _displayStateP);
+		// moves to the start of the _stateNum frame, from 1 to GetStateRecorded() included
+		void SeekToFrame(const size_t _stateNum, CpuI8080::State* _cpuStateP, Memory::State* _memStateP,
+			IO::State* _ioStateP, Display::State* _displayStateP);
 		void CleanMemUpdates(Display::State* _displayStateP);
-		auto GetStateRecorded() const -> size_t { return m_stateRecorded; };
-		auto GetStateCurrent() const -> size_t { return m_stateCurrent; };
-		void Deserialize(const std::vector<uint8_t>& _data, 
+		// the states are numbered through the spilled and the ring states
+		auto GetStateRecorded() const -> size_t { return GetSpilled() + m_stateRecorded; };
+		auto GetStateCurrent() const -> size_t { return m_spillCurrent ? m_spillCurrent : GetSpilled() + m_stateCurrent; };
+		// the memory used by the recorded history: the states, their write records, and the keyframes
+		auto GetMemUsed() const -> size_t;
+		// the average history cost of a frame. Mostly sizeof(HwState) plus 5 bytes per memory write
+		auto GetBytesPerFrame() const -> size_t;
+		auto GetMemBudget() const -> size_t { return sizeof(HwStates) + WRITES_MAX * sizeof(MemWrite) + KEYFRAMES_MEM_MAX; }
+		// the bytes in the spill file
+		auto GetSpillSize() const -> size_t { return m_spillLen; }
+		auto GetSpillEnabled() const -> bool { return m_spillEnabled; }
+		// disabling the spill discards the spilled history
+		void SetSpill(const bool _enabled, CpuI8080::State* _cpuStateP, Memory::State* _memStateP,
+			IO::State* _ioStateP, Display::State* _displayStateP);
+		// returns false if the data is corrupted
+		bool Deserialize(const std::vector<uint8_t>& _data, 
+			CpuI8080::State* _cpuStateP, Memory::State* _memStateP,
+			IO::State* _ioStateP, Display::State* _displayStateP);
+		// loads a recording of any version. Returns false if the file is corrupted
+		bool Load(const std::string& _path,
 			CpuI8080::State* _cpuStateP, Memory::State* _memStateP,
 			IO::State* _ioStateP, Display::State* _displayStateP);
-		auto Serialize() const -> const std::vector<uint8_t>;
+		// writes the spill file content, the ring states, the ram, and the index.
+		// The file isn't built in memory, the spilled history is copied as is
+		bool Save(const std::string& _path, const Memory::State& _memState) const;
 
 	private:
 		void StoreState(const CpuI8080::State& _cpuState, const Memory::State& _memState, 
@@ -64,16 +142,56 @@ namespace dev
 		void StoreMemoryDiff(const Memory::State& _memState);
 		void RestoreState(CpuI8080::State* _cpuStateP, Memory::State* _memStateP,
 			IO::State* _ioStateP, Display::State* _displayStateP);
-		void GetStatesSize();
+		void DropOldestState();
+		// drops the oldest frames with their keyframes until the keyframes fit KEYFRAMES_MEM_MAX
+		void DropKeyframesOverBudget();
+		auto GetKeyframesLen() const -> size_t;
+		void RestoreState(const HwState& _state, CpuI8080::State* _cpuStateP, Memory::State* _memStateP,
+			IO::State* _ioStateP, Display::State* _displayStateP);
+		// _forward applies the writes of the frame, otherwise reverts them
+		void ApplyWrites(const HwState& _state, const MemWrite* _spillWritesP, uint8_t* _ramP, const bool _forward) const;
+		// replays the writes of the states from _stateNum to _stateNumEnd excluded, in the global numbering
+		void RedoWrites(const size_t _stateNum, const size_t _stateNumEnd, uint8_t* _ramP) const;
+		auto GetRingState(const size_t _stateNum) const -> const HwState&;
+
+		// spill
+		inline auto GetSpilled() const -> size_t { return m_spillOffsets.size(); }
+		auto GetSpillState(const size_t _stateNum) const -> HwState;
+		auto GetSpillWrites(const size_t _stateNum) const -> const MemWrite*;
+		bool SpillAppend(const void* _dataP, const size_t _len);
+		void SpillOldestState();
+		void ResetSpill();
+		// discards the spilled states after the current one, and moves it to the ring
+		void TruncateSpill();
+		bool OpenSpill();
+		// parses the index of the VERSION file copied into the spill
+		bool LoadSpill(CpuI8080::State* _cpuStateP, Memory::State* _memStateP,
+			IO::State* _ioStateP, Display::State* _displayStateP);
+		// the idx of the oldest recorded state. m_stateIdx is the idx of the current state
+		inline auto GetFirstStateIdx() const -> size_t { return (m_stateIdx + STATES_LEN + 1 - m_stateCurrent) % STATES_LEN; }
+		// the state number of the serial. It's out of [1, m_stateRecorded] if the state isn't recorded
+		inline auto GetStateNum(const uint64_t _serial) const -> int64_t 
+		{ return int64_t(m_stateCurrent) + int64_t(_serial - m_states[m_stateIdx].serial); }
+		inline auto GetWrite(const uint64_t _idx) -> MemWrite& { return m_writes[_idx % WRITES_MAX]; }
+		inline auto GetWrite(const uint64_t _idx) const -> const MemWrite& { return m_writes[_idx % WRITES_MAX]; }
 
 		size_t m_stateIdx = 0; // idx of the last stored state in a circular buffer
 		size_t m_stateRecorded = 0; // the amount of recorded states from 1 to STATES_LEN
 		size_t m_stateCurrent = 0; // the number of current state from 1 to m_stateRecorded included
 		bool m_lastRecord = true; // false means we at the end of recorded state + memory writes
 		HwStates m_states;
-		size_t m_statesMemSize = 0; // m_states memory consumption
+		std::vector<MemWrite> m_writes = std::vector<MemWrite>(WRITES_MAX); // the write log ring, allocated once
+		uint64_t m_writesEnd = 0; // the idx after the last write in the write log
+		std::deque<Keyframe> m_keyframes; // ordered by the serial
 		size_t m_frameNum = 0;
-		Memory::Ram m_ram;
+
+		bool m_spillEnabled = false;
+		MappedFile m_spillFile;
+		std::string m_spillPath;
+		size_t m_spillLen = 0; // the used bytes of the spill file
+		std::vector<uint64_t> m_spillOffsets; // the offset of every spilled state
+		std::vector<SpillKeyframe> m_spillKeyframes; // ordered by the stateNum
+		size_t m_spillCurrent = 0; // the number of the current spilled state, 0 if the current state is in the ring
 		uint32_t m_version = VERSION;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,172 @@
+#include <cstring>
+#include <cstddef>
+
+#include "core/save_state.h"
+#include "utils/lz.h"
+#include "utils/utils.h"
+
+static constexpr uint32_t MAGIC = 0x53535644; // "DVSS"
+static constexpr uint32_t FORMAT_VERSION = 2;
+static constexpr uint16_t FLAG_LZ = 1;
+
+#pragma pack(push, 1)
+struct FileHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t sections;
+};
+
+struct SectionHeader
+{
+	uint32_t id;
+	uint16_t version;
+	uint16_t flags;
+	uint64_t rawLen;
+	uint64_t len;		// the len of the data stored in the file
+	uint64_t checksum;	// the fields above and the stored data
+};
+#pragma pack(pop)
+
+static auto GetChecksum(const SectionHeader& _header, const uint8_t* _dataP)
+-> uint64_t
+{
+	auto hash = dev::Hash64(reinterpret_cast<const uint8_t*>(&_header), offsetof(SectionHeader, checksum));
+	return dev::Hash64(_dataP, _header.len, hash);
+}
+
+dev::SaveStateWriter::SaveStateWriter(const bool _compress)
+	: m_compress(_compress)
+{
+	m_data.resize(sizeof(FileHeader));
+}
+
+void dev::SaveStateWriter::Add(const uint32_t _id, const uint16_t _version, const void* _dataP, const size_t _len)
+{
+	auto dataP = static_cast<const uint8_t*>(_dataP);
+	size_t headerPos = m_data.size();
+	m_data.resize(headerPos + sizeof(SectionHeader));
+	size_t dataPos = m_data.size();
+
+	SectionHeader header{ _id, _version, 0, _len, _len, 0 };
+
+	if (m_compress)
+	{
+		LzCompress(dataP, _len, m_data);
+		size_t len = m_data.size() - dataPos;
+
+		// incompressible data is stored as is
+		if (len < _len) {
+			header.flags = FLAG_LZ;
+			header.len = len;
+		}
+		else {
+			m_data.resize(dataPos);
+		}
+	}
+	if (!(header.flags & FLAG_LZ)) {
+		m_data.insert(m_data.end(), dataP, dataP + _len);
+	}
+	header.checksum = GetChecksum(header, m_data.data() + dataPos);
+
+	memcpy(m_data.data() + headerPos, &header, sizeof(header));
+	m_sections++;
+}
+
+auto dev::SaveStateWriter::Finish()
+-> std::vector<uint8_t>
+{
+	FileHeader header{ MAGIC, FORMAT_VERSION, m_sections };
+	memcpy(m_data.data(), &header, sizeof(header));
+	m_sections = 0;
+
+	auto out = std::move(m_data);
+	m_data.resize(sizeof(FileHeader));
+	return out;
+}
+
+dev::SaveStateReader::SaveStateReader(const std::vector<uint8_t>& _data)
+{
+	FileHeader header;
+	if (_data.size() < sizeof(header)) return;
+	memcpy(&header, _data.data(), sizeof(header));
+
+	if (header.magic != MAGIC) {
+		dev::Log("Save state: wrong format");
+		return;
+	}
+	if (header.version != FORMAT_VERSION) {
+		dev::Log("Save state: unsupported format version {}", header.version);
+		return;
+	}
+
+	size_t pos = sizeof(header);
+	for (uint32_t i = 0; i < header.sections; i++)
+	{
+		SectionHeader sectionHeader;
+		if (_data.size() - pos < sizeof(sectionHeader)) return;
+		memcpy(&sectionHeader, _data.data() + pos, sizeof(sectionHeader));
+		pos += sizeof(sectionHeader);
+
+		if (_data.size() - pos < sectionHeader.len) return;
+		if (sectionHeader.checksum != GetChecksum(sectionHeader, _data.data() + pos)) {
+			dev::Log("Save state: section {} is corrupted", sectionHeader.id);
+			return;
+		}
+
+		m_sections.push_back({ sectionHeader.id, sectionHeader.version, sectionHeader.flags,
+			sectionHeader.rawLen, sectionHeader.len, _data.data() + pos });
+		pos += sectionHeader.len;
+	}
+
+	m_valid = true;
+}
+
+bool dev::SaveStateReader::IsSaveState(const std::vector<uint8_t>& _data)
+{
+	uint32_t magic;
+	if (_data.size() < sizeof(FileHeader)) return false;
+	memcpy(&magic, _data.data(), sizeof(magic));
+	return magic == MAGIC;
+}
+
+auto dev::SaveStateReader::Find(const uint32_t _id) const
+-> const Section*
+{
+	for (const auto& section : m_sections) {
+		if (section.id == _id) return &section;
+	}
+	return nullptr;
+}
+
+auto dev::SaveStateReader::GetLen(const uint32_t _id) const
+-> size_t
+{
+	auto sectionP = Find(_id);
+	return sectionP ? sectionP->rawLen : 0;
+}
+
+bool dev::SaveStateReader::Read(const uint32_t _id, const uint16_t _version, void* _dstP, const size_t _len) const
+{
+	auto sectionP = Find(_id);
+	if (!sectionP) {
+		dev::Log("Save state: section {} is missing", _id);
+		return false;
+	}
+	if (sectionP->version != _version || sectionP->rawLen != _len) {
+		dev::Log("Save state: section {} is incompatible", _id);
+		return false;
+	}
+
+	if (sectionP->flags & FLAG_LZ) {
+		if (!LzDecompress(sectionP->dataP, sectionP->len, static_cast<uint8_t*>(_dstP), _len)) {
+			dev::Log("Save state: section {} is corrupted", _id);
+			return false;
+		}
+	}
+	else {
+		if (sectionP->len != _len) return false;
+		memcpy(_dstP, sectionP->dataP, _len);
+	}
+	return true;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dev
+{
+	// The binary save state container. A header followed by the sections.
+	// A section is an id, a layout version, and a plain-old-data blob, optionally lz compressed.
+	// The reader rejects the state if a section doesn't match its checksum.
+	// A reader skips the sections it doesn't know, and rejects a section with a different version or size,
+	// so a layout change requires bumping the section version
+
+	class SaveStateWriter
+	{
+		std::vector<uint8_t> m_data;
+		uint32_t m_sections = 0;
+		bool m_compress = false;
+
+	public:
+		SaveStateWriter(const bool _compress);
+		void Add(const uint32_t _id, const uint16_t _version, const void* _dataP, const size_t _len);
+		// returns the state. The writer is empty after it
+		auto Finish() -> std::vector<uint8_t>;
+	};
+
+	class SaveStateReader
+	{
+		struct Section
+		{
+			uint32_t id = 0;
+			uint16_t version = 0;
+			uint16_t flags = 0;
+			uint64_t rawLen = 0;
+			uint64_t len = 0;
+			const uint8_t* dataP = nullptr;
+		};
+
+		std::vector<Section> m_sections;
+		bool m_valid = false;
+
+		auto Find(const uint32_t _id) const -> const Section*;
+
+	public:
+		// _data has to outlive the reader
+		SaveStateReader(const std::vector<uint8_t>& _data);
+		// checks only the header magic
+		static bool IsSaveState(const std::vector<uint8_t>& _data);
+		bool IsValid() const { return m_valid; }
+		bool Has(const uint32_t _id) const { return Find(_id) != nullptr; }
+		// the uncompressed len, 0 if there is no such section
+		auto GetLen(const uint32_t _id) const -> size_t;
+		// copies the section into _dstP. Fails if the section is missing, the version or the len differ,
+		// or the data is corrupted
+		bool Read(const uint32_t _id, const uint16_t _version, void* _dstP, const size_t _len) const;
+	};
+}
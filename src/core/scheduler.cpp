@@ -0,0 +1,37 @@
+#include "core/scheduler.h"
+
+void dev::Scheduler::Reset()
+{
+	m_deadlines.fill(NEVER);
+	m_next = NEVER;
+}
+
+void dev::Scheduler::Schedule(const Event _event, const Time _time)
+{
+	m_deadlines[static_cast<int>(_event)] = _time;
+	if (_time < m_next) {
+		m_next = _time;
+	}
+	else {
+		UpdateNext();
+	}
+}
+
+void dev::Scheduler::Cancel(const Event _event)
+{
+	auto& deadline = m_deadlines[static_cast<int>(_event)];
+	if (deadline == NEVER) return;
+
+	bool wasNext = deadline == m_next;
+	deadline = NEVER;
+	if (wasNext) UpdateNext();
+}
+
+// the amount of events is small and fixed, a linear scan beats a heap here
+void dev::Scheduler::UpdateNext()
+{
+	m_next = NEVER;
+	for (auto deadline : m_deadlines) {
+		if (deadline < m_next) m_next = deadline;
+	}
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <array>
+
+namespace dev
+{
+	// Keeps the next deadlines of the devices timed events.
+	// The time is counted by the 12 MHz clock (equals amount of pixels in 512 mode), four ticks per cpu cycle.
+	// The devices register the deadlines. The cpu runs ahead of the display and the audio until a deadline
+	// is within reach, then they catch up and run in lockstep with it.
+	// The rasterizer asks if anything is due in the upcoming block of ticks and takes the per-pixel path only then.
+	// An event stays due until its owner cancels or reschedules it.
+	class Scheduler
+	{
+	public:
+		using Time = uint64_t;
+		static constexpr Time NEVER = UINT64_MAX;
+
+		enum class Event : int {
+			DISPLAY_IRQ = 0,		// the interrupt request pixel
+			DISPLAY_SCROLL,			// the vertical scroll commit pixel
+			DISPLAY_FRAME_END,		// the last pixel of the frame
+			IO_OUT_COMMIT,			// pending OUT commit
+			IO_PALETTE_COMMIT,		// pending palette commit
+			IO_DISPLAY_MODE_COMMIT,	// pending display mode commit
+			LEN
+		};
+
+	private:
+		std::array<Time, static_cast<int>(Event::LEN)> m_deadlines;
+		Time m_next = NEVER;	// the earliest deadline
+		Time m_time = 0;		// the current time
+
+		void UpdateNext();
+
+	public:
+		Scheduler() { Reset(); };
+		void Reset();
+		void Schedule(const Event _event, const Time _time);
+		void Cancel(const Event _event);
+
+		inline void SetTime(const Time _time) { m_time = _time; };
+		inline auto GetTime() const -> Time { return m_time; };
+		inline auto GetNext() const -> Time { return m_next; };
+		inline auto GetDeadline(const Event _event) const -> Time { return m_deadlines[static_cast<int>(_event)]; };
+		// true if any event is due before _ticks from now
+		inline bool IsDue(const Time _ticks) const { return m_next < m_time + _ticks; };
+	};
+}
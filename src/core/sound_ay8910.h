@@ -161,6 +161,14 @@ private:
     int instr_accu;
 
 public:
+    // the wrapper part of the machine state to clone it
+    struct SaveState
+    {
+        float last;
+        int ayAccu;
+        int instr_accu;
+    };
+
     AYWrapper(SoundAY8910& _ay) : ay(_ay)
     {
         Init();
@@ -189,6 +197,18 @@ public:
         this->last = avg > 0 ? aysamp / avg : this->last;
         return this->last;
     }
+
+    void StoreState(SaveState& _state) const
+    {
+        _state = { this->last, this->ayAccu, this->instr_accu };
+    }
+
+    void RestoreState(const SaveState& _state)
+    {
+        this->last = _state.last;
+        this->ayAccu = _state.ayAccu;
+        this->instr_accu = _state.instr_accu;
+    }
 };
 
 
@@ -0,0 +1,568 @@
+#include <cstring>
+#include <algorithm>
+
+#include "core/trace_capture.h"
+#include "core/disasm.h"
+#include "utils/lz.h"
+#include "utils/utils.h"
+
+// the record encoding flags. A record is the flags, the opcode, the immediates, the cycles delta,
+// and the fields that differ from the previous record
+static constexpr uint8_t ENC_PSW = 1 << 0;
+static constexpr uint8_t ENC_BC = 1 << 1;
+static constexpr uint8_t ENC_DE = 1 << 2;
+static constexpr uint8_t ENC_HL = 1 << 3;
+static constexpr uint8_t ENC_SP = 1 << 4;
+static constexpr uint8_t ENC_ADDR = 1 << 5; // not the instruction following the previous one
+static constexpr uint8_t ENC_FRAME = 1 << 6;
+// the flags, the opcode, the immediates, the cycles and the frame varints, the addr varint, and the registers
+static constexpr size_t RECORD_ENC_MAX = 1 + 1 + 2 + 10 + 10 + 5 + 5 * 2;
+
+#pragma pack(push, 1)
+struct FileHeader
+{
+	uint32_t magic;
+	uint32_t version;
+};
+#pragma pack(pop)
+
+static void PutVarInt(std::vector<uint8_t>& _out, uint64_t _val)
+{
+	for (; _val >= 0x80; _val >>= 7) _out.push_back(uint8_t(_val) | 0x80);
+	_out.push_back(uint8_t(_val));
+}
+
+static bool GetVarInt(const uint8_t*& _dataP, const uint8_t* const _endP, uint64_t& _val)
+{
+	_val = 0;
+	for (int shift = 0; _dataP < _endP && shift < 64; shift += 7)
+	{
+		uint8_t byte = *_dataP++;
+		_val |= uint64_t(byte & 0x7F) << shift;
+		if (!(byte & 0x80)) return true;
+	}
+	return false;
+}
+
+dev::TraceCapture::~TraceCapture()
+{
+	StopFinding();
+	Stop();
+}
+
+// Hardware thread
+bool dev::TraceCapture::Start(const std::string& _path)
+{
+	Stop();
+
+	m_file.open(_path, std::ios::binary | std::ios::trunc);
+	FileHeader fileHeader{ MAGIC, VERSION };
+	m_file.write(reinterpret_cast<const char*>(&fileHeader), sizeof(fileHeader));
+	if (!m_file)
+	{
+		dev::Log("TraceCapture: can't create {}", _path);
+		m_file.close();
+		return false;
+	}
+
+	// all the blocks are in the free ring when the writer isn't running
+	if (m_blocks.empty())
+	{
+		for (size_t i = 0; i < BLOCKS_MAX; i++)
+		{
+			m_blocks.push_back(std::make_unique<Block>());
+			m_free.push(m_blocks.back().get());
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_indexMutex);
+		m_index.clear();
+		m_monotonic = true;
+		m_indexId++;
+		m_path = _path;
+	}
+	m_fileLen = sizeof(fileHeader);
+	m_records = 0;
+	m_bytes = sizeof(fileHeader);
+	m_rawBytes = 0;
+	m_stop = false;
+	m_failed = false;
+	m_capturing = true;
+	m_writerThread = std::thread(&TraceCapture::Writing, this);
+	return true;
+}
+
+// Hardware thread
+void dev::TraceCapture::Stop()
+{
+	if (!m_capturing) return;
+
+	if (m_blockP && m_blockP->len)
+	{
+		m_full.push(std::move(m_blockP));
+		m_blockP = nullptr;
+	}
+	m_stop.store(true, std::memory_order_release);
+	m_wake.fetch_add(1, std::memory_order_release);
+	m_wake.notify_one();
+	m_writerThread.join();
+
+	// the writer is done, the free ring has the only producer left
+	if (m_blockP)
+	{
+		m_free.push(std::move(m_blockP));
+		m_blockP = nullptr;
+	}
+	m_file.close();
+	m_capturing = false;
+}
+
+// Hardware thread
+void dev::TraceCapture::Add(const CpuI8080::State& _cpuState, const Memory::State& _memState,
+	const uint64_t _frameNum)
+{
+	if (!m_blockP)
+	{
+		if (m_failed)
+		{
+			dev::Log("TraceCapture: the capture is stopped, can't write {}", m_path);
+			Stop();
+			return;
+		}
+		// the emulation waits for the disk rather than drops the records
+		while (!m_free.pop(m_blockP)) std::this_thread::yield();
+		m_blockP->len = 0;
+	}
+
+	uint8_t opcode = _memState.debug.instr[0];
+
+	// skip repetitive HLT, the cycles of the next record cover them
+	auto& block = *m_blockP;
+	if (opcode == CpuI8080::OPCODE_HLT && block.len &&
+		block.records[block.len - 1].opcode == CpuI8080::OPCODE_HLT)
+	{
+		return;
+	}
+
+	auto& record = block.records[block.len++];
+	record.cc = _cpuState.cc;
+	record.frameNum = _frameNum;
+	record.globalAddr = _memState.debug.instrGlobalAddr;
+	record.opcode = opcode;
+	record.imm = _memState.debug.instr[1] | _memState.debug.instr[2] << 8;
+	record.psw = _cpuState.regs.psw.af.word;
+	record.bc = _cpuState.regs.bc.word;
+	record.de = _cpuState.regs.de.word;
+	record.hl = _cpuState.regs.hl.word;
+	record.sp = _cpuState.regs.sp.word;
+
+	if (block.len < BLOCK_LEN) return;
+
+	m_full.push(std::move(m_blockP));
+	m_blockP = nullptr;
+	m_wake.fetch_add(1, std::memory_order_release);
+	m_wake.notify_one();
+}
+
+auto dev::TraceCapture::GetPath() const
+-> std::string
+{
+	std::lock_guard<std::mutex> lock(m_indexMutex);
+	return m_path;
+}
+
+auto dev::TraceCapture::GetStats() const
+-> Stats
+{
+	std::lock_guard<std::mutex> lock(m_indexMutex);
+	return { m_capturing, m_records, m_index.size(), m_bytes, m_rawBytes };
+}
+
+//////////////////////////////////////////////////////////////
+//
+// Writer thread
+//
+//////////////////////////////////////////////////////////////
+
+void dev::TraceCapture::Writing()
+{
+	for (;;)
+	{
+		// read before the pop, so a block pushed after the pop wakes the wait
+		auto wake = m_wake.load(std::memory_order_acquire);
+
+		Block* blockP;
+		if (m_full.pop(blockP))
+		{
+			if (!m_failed) WriteBlock(*blockP);
+			m_free.push(std::move(blockP));
+			continue;
+		}
+
+		// the last block is pushed before the stop
+		if (m_stop.load(std::memory_order_acquire))
+		{
+			if (m_full.empty()) break;
+			continue;
+		}
+		m_wake.wait(wake, std::memory_order_acquire);
+	}
+}
+
+void dev::TraceCapture::WriteBlock(const Block& _block)
+{
+	BlockHeader header;
+	const auto& first = _block.records[0];
+	const auto& last = _block.records[_block.len - 1];
+	header.recordsLen = static_cast<uint32_t>(_block.len);
+	header.ccFirst = first.cc;
+	header.ccLast = last.cc;
+	header.frameFirst = first.frameNum;
+	header.frameLast = last.frameNum;
+	for (size_t i = 0; i < _block.len; i++)
+	{
+		const auto& record = _block.records[i];
+		header.SetPage(Addr(record.globalAddr));
+		if (i && (record.cc < _block.records[i - 1].cc || record.frameNum < _block.records[i - 1].frameNum))
+		{
+			header.rewound = 1;
+		}
+	}
+
+	Encode(_block, m_raw);
+	m_compressed.clear();
+	LzCompress(m_raw.data(), m_raw.size(), m_compressed);
+	header.rawLen = static_cast<uint32_t>(m_raw.size());
+	header.len = static_cast<uint32_t>(m_compressed.size());
+
+	m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	m_file.write(reinterpret_cast<const char*>(m_compressed.data()), m_compressed.size());
+	// the queries read the file while capturing
+	m_file.flush();
+	if (!m_file)
+	{
+		m_failed = true;
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(m_indexMutex);
+	if (m_index.empty() ? header.rewound : !header.Follows(m_index.back().header)) m_monotonic = false;
+	m_index.push_back({ header, m_fileLen + sizeof(header) });
+	m_fileLen += sizeof(header) + header.len;
+	m_records += _block.len;
+	m_bytes = m_fileLen;
+	m_rawBytes += _block.len * sizeof(Record);
+}
+
+// the first record is encoded against the empty one at the first cycle and frame of the block
+void dev::TraceCapture::Encode(const Block& _block, std::vector<uint8_t>& _out)
+{
+	_out.clear();
+	Record prev{ _block.records[0].cc, _block.records[0].frameNum };
+	bool sequential = false;
+
+	for (size_t i = 0; i < _block.len; i++)
+	{
+		const auto& record = _block.records[i];
+		auto cmdLen = GetCmdLen(record.opcode);
+
+		uint8_t flags = 0;
+		if (record.psw != prev.psw) flags |= ENC_PSW;
+		if (record.bc != prev.bc) flags |= ENC_BC;
+		if (record.de != prev.de) flags |= ENC_DE;
+		if (record.hl != prev.hl) flags |= ENC_HL;
+		if (record.sp != prev.sp) flags |= ENC_SP;
+		if (!sequential || record.globalAddr != prev.globalAddr + GetCmdLen(prev.opcode)) flags |= ENC_ADDR;
+		if (record.frameNum != prev.frameNum) flags |= ENC_FRAME;
+
+		_out.push_back(flags);
+		_out.push_back(record.opcode);
+		if (cmdLen > 1) _out.push_back(uint8_t(record.imm));
+		if (cmdLen > 2) _out.push_back(uint8_t(record.imm >> 8));
+		PutVarInt(_out, record.cc - prev.cc);
+		if (flags & ENC_FRAME) PutVarInt(_out, record.frameNum - prev.frameNum);
+		if (flags & ENC_ADDR) PutVarInt(_out, record.globalAddr);
+
+		auto PutWord = [&_out](const uint16_t _val) {
+			_out.push_back(uint8_t(_val));
+			_out.push_back(uint8_t(_val >> 8));
+		};
+		if (flags & ENC_PSW) PutWord(record.psw);
+		if (flags & ENC_BC) PutWord(record.bc);
+		if (flags & ENC_DE) PutWord(record.de);
+		if (flags & ENC_HL) PutWord(record.hl);
+		if (flags & ENC_SP) PutWord(record.sp);
+
+		prev = record;
+		sequential = true;
+	}
+}
+
+// outputs false if the data is corrupted
+bool dev::TraceCapture::Decode(const BlockHeader& _header, const uint8_t* _dataP, std::vector<Record>& _out)
+{
+	_out.clear();
+	const uint8_t* const endP = _dataP + _header.rawLen;
+	Record prev{ _header.ccFirst, _header.frameFirst };
+
+	for (size_t i = 0; i < _header.recordsLen; i++)
+	{
+		if (endP - _dataP < 2) return false;
+		uint8_t flags = *_dataP++;
+		Record record = prev;
+		record.opcode = *_dataP++;
+
+		auto cmdLen = GetCmdLen(record.opcode);
+		if (endP - _dataP < cmdLen - 1) return false;
+		record.imm = 0;
+		if (cmdLen > 1) record.imm = *_dataP++;
+		if (cmdLen > 2) record.imm |= *_dataP++ << 8;
+
+		uint64_t val;
+		if (!GetVarInt(_dataP, endP, val)) return false;
+		record.cc += val;
+		if (flags & ENC_FRAME)
+		{
+			if (!GetVarInt(_dataP, endP, val)) return false;
+			record.frameNum += val;
+		}
+		if (flags & ENC_ADDR)
+		{
+			if (!GetVarInt(_dataP, endP, val)) return false;
+			record.globalAddr = static_cast<GlobalAddr>(val);
+		}
+		else {
+			record.globalAddr = prev.globalAddr + GetCmdLen(prev.opcode);
+		}
+
+		auto GetWord = [&](uint16_t& _val) {
+			if (endP - _dataP < 2) return false;
+			_val = _dataP[0] | _dataP[1] << 8;
+			_dataP += 2;
+			return true;
+		};
+		if ((flags & ENC_PSW) && !GetWord(record.psw)) return false;
+		if ((flags & ENC_BC) && !GetWord(record.bc)) return false;
+		if ((flags & ENC_DE) && !GetWord(record.de)) return false;
+		if ((flags & ENC_HL) && !GetWord(record.hl)) return false;
+		if ((flags & ENC_SP) && !GetWord(record.sp)) return false;
+
+		_out.push_back(record);
+		prev = record;
+	}
+	return true;
+}
+
+//////////////////////////////////////////////////////////////
+//
+// Queries
+//
+//////////////////////////////////////////////////////////////
+
+bool dev::TraceCapture::Open(const std::string& _path)
+{
+	if (m_capturing) return false;
+
+	std::ifstream file(_path, std::ios::binary);
+	FileHeader fileHeader;
+	if (!file.read(reinterpret_cast<char*>(&fileHeader), sizeof(fileHeader)) ||
+		fileHeader.magic != MAGIC || fileHeader.version != VERSION)
+	{
+		dev::Log("TraceCapture: {} isn't a trace capture", _path);
+		return false;
+	}
+
+	file.seekg(0, std::ios::end);
+	uint64_t fileLen = file.tellg();
+	file.seekg(sizeof(fileHeader));
+
+	// an unfinished block at the end of a crashed capture is dropped
+	std::vector<BlockIdx> index;
+	uint64_t offset = sizeof(fileHeader);
+	uint64_t records = 0;
+	uint64_t rawBytes = 0;
+	bool monotonic = true;
+	BlockHeader header;
+	while (file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+	{
+		offset += sizeof(header);
+		if (offset + header.len > fileLen) break;
+		// a corrupted header stops the index before it's trusted with the allocations
+		if (header.recordsLen == 0 || header.recordsLen > BLOCK_LEN ||
+			header.rawLen > header.recordsLen * RECORD_ENC_MAX)
+		{
+			dev::Log("TraceCapture: the block {} of {} is corrupted", index.size(), _path);
+			offset -= sizeof(header);
+			break;
+		}
+		file.seekg(header.len, std::ios::cur);
+		if (index.empty() ? header.rewound : !header.Follows(index.back().header)) monotonic = false;
+		index.push_back({ header, offset });
+		offset += header.len;
+		records += header.recordsLen;
+		rawBytes += header.recordsLen * sizeof(Record);
+	}
+
+	std::lock_guard<std::mutex> lock(m_indexMutex);
+	m_index = std::move(index);
+	m_monotonic = monotonic;
+	m_indexId++;
+	m_path = _path;
+	m_records = records;
+	m_bytes = offset;
+	m_rawBytes = rawBytes;
+	return true;
+}
+
+template <typename Key>
+auto dev::TraceCapture::LowerBound(const uint64_t _val, Key&& _key) const
+-> size_t
+{
+	std::lock_guard<std::mutex> lock(m_indexMutex);
+	// the search filters the records of every block then
+	if (!m_monotonic) return 0;
+
+	auto it = std::partition_point(m_index.begin(), m_index.end(),
+		[&](const BlockIdx& _blockIdx) { return _key(_blockIdx.header) < _val; });
+	return it - m_index.begin();
+}
+
+template <typename Match, typename Func>
+void dev::TraceCapture::Search(const size_t _blockFirst, Match&& _match, Func&& _func)
+{
+	std::string path;
+	uint64_t indexId;
+	{
+		std::lock_guard<std::mutex> lock(m_indexMutex);
+		path = m_path;
+		indexId = m_indexId;
+	}
+	std::ifstream file(path, std::ios::binary);
+	if (!file) return;
+
+	std::vector<uint8_t> compressed;
+	std::vector<uint8_t> raw;
+	std::vector<Record> records;
+
+	for (size_t i = _blockFirst;; i++)
+	{
+		BlockIdx blockIdx;
+		{
+			// the writer appends the blocks meanwhile
+			std::lock_guard<std::mutex> lock(m_indexMutex);
+			if (m_findCancel || indexId != m_indexId || i >= m_index.size()) return;
+			blockIdx = m_index[i];
+		}
+		const auto& header = blockIdx.header;
+		if (!_match(header)) continue;
+
+		compressed.resize(header.len);
+		raw.resize(header.rawLen);
+		file.seekg(blockIdx.offset);
+		if (!file.read(reinterpret_cast<char*>(compressed.data()), header.len) ||
+			!LzDecompress(compressed.data(), compressed.size(), raw.data(), raw.size()) ||
+			!Decode(header, raw.data(), records))
+		{
+			dev::Log("TraceCapture: the block {} of {} is corrupted", i, path);
+			return;
+		}
+
+		for (const auto& record : records)
+		{
+			if (!_func(record)) return;
+		}
+	}
+}
+
+auto dev::TraceCapture::FindByCC(const uint64_t _cc, const size_t _len)
+-> std::vector<Record>
+{
+	std::vector<Record> out;
+	if (!_len) return out;
+
+	auto blockFirst = LowerBound(_cc, [](const BlockHeader& _header) { return _header.ccLast; });
+	Search(blockFirst, [](const BlockHeader&) { return true; },
+		[&](const Record& _record) {
+			if (_record.cc >= _cc) out.push_back(_record);
+			return out.size() < _len;
+		});
+	return out;
+}
+
+auto dev::TraceCapture::FindByFrame(const uint64_t _frameNum, const size_t _len)
+-> std::vector<Record>
+{
+	std::vector<Record> out;
+	if (!_len) return out;
+
+	auto blockFirst = LowerBound(_frameNum, [](const BlockHeader& _header) { return _header.frameLast; });
+	Search(blockFirst, [](const BlockHeader&) { return true; },
+		[&](const Record& _record) {
+			if (_record.frameNum >= _frameNum) out.push_back(_record);
+			return out.size() < _len;
+		});
+	return out;
+}
+
+auto dev::TraceCapture::FindByPC(const Addr _pc, const uint64_t _ccFrom, const size_t _len)
+-> std::vector<Record>
+{
+	std::vector<Record> out;
+	if (!_len) return out;
+
+	auto blockFirst = LowerBound(_ccFrom, [](const BlockHeader& _header) { return _header.ccLast; });
+	Search(blockFirst, [&](const BlockHeader& _header) { return _header.HasPage(_pc); },
+		[&](const Record& _record) {
+			if (_record.cc >= _ccFrom && Addr(_record.globalAddr) == _pc) out.push_back(_record);
+			return out.size() < _len;
+		});
+	return out;
+}
+
+// UI thread
+void dev::TraceCapture::Find(const Query& _query)
+{
+	StopFinding();
+	m_findCancel = false;
+	m_found = false;
+	m_findingThread = std::thread(&TraceCapture::Finding, this, _query);
+}
+
+// UI thread
+bool dev::TraceCapture::GetFound(std::vector<Record>& _out)
+{
+	if (!m_findingThread.joinable() || !m_found.load(std::memory_order_acquire)) return false;
+
+	m_findingThread.join();
+	_out = std::move(m_foundRecords);
+	m_foundRecords.clear();
+	return true;
+}
+
+void dev::TraceCapture::StopFinding()
+{
+	if (!m_findingThread.joinable()) return;
+
+	m_findCancel = true;
+	m_findingThread.join();
+	m_foundRecords.clear();
+}
+
+// query thread
+void dev::TraceCapture::Finding(const Query _query)
+{
+	switch (_query.by)
+	{
+	case Query::By::PC:
+		m_foundRecords = FindByPC(Addr(_query.val), _query.ccFrom, _query.len);
+		break;
+	case Query::By::CC:
+		m_foundRecords = FindByCC(_query.val, _query.len);
+		break;
+	case Query::By::FRAME:
+		m_foundRecords = FindByFrame(_query.val, _query.len);
+		break;
+	}
+	m_found.store(true, std::memory_order_release);
+}
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <cstdint>
+#include <array>
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "utils/types.h"
+#include "utils/spsc_ring.h"
+#include "core/cpu_i8080.h"
+#include "core/memory.h"
+
+namespace dev
+{
+	// Streams every executed instruction to a file, so the trace covers minutes instead of
+	// the fraction of a second of the TraceLog ring.
+	// The Hardware thread fills the blocks of the raw records and passes them to the writer thread
+	// through a lock-free ring. The writer delta-encodes a block against its previous record,
+	// lz compresses it, and appends it to the file. A block starts from scratch,
+	// so it is decoded alone. The block headers are the sparse index: the cycles, the frames,
+	// and the 256-byte pages of the executed code, so a query decodes only the blocks that match.
+	// The UI runs the queries on the query thread, so the decoding stalls neither the emulation nor the UI.
+	// The file is a list of the blocks, an unfinished capture is readable up to its last written block
+	class TraceCapture
+	{
+	public:
+		static constexpr size_t BLOCK_LEN = 1 << 14; // the records per block
+		static constexpr size_t BLOCKS_MAX = 16; // the blocks in flight between the threads
+		static constexpr int PC_PAGE_BITS = 8;
+		static constexpr size_t PC_PAGES = Memory::MEM_64K >> PC_PAGE_BITS;
+		static constexpr uint32_t MAGIC = 0x43545644; // "DVTC"
+		static constexpr uint32_t VERSION = 2;
+
+		// an executed instruction and the registers after it
+		struct Record
+		{
+			uint64_t cc = 0;
+			uint64_t frameNum = 0;
+			GlobalAddr globalAddr = 0;
+			uint8_t opcode = 0;
+			uint16_t imm = 0; // the bytes after the opcode
+			uint16_t psw = 0;
+			uint16_t bc = 0;
+			uint16_t de = 0;
+			uint16_t hl = 0;
+			uint16_t sp = 0;
+		};
+
+#pragma pack(push, 1)
+		// the index entry, it precedes the compressed block in the file
+		struct BlockHeader
+		{
+			uint32_t len = 0; // compressed
+			uint32_t rawLen = 0;
+			uint32_t recordsLen = 0;
+			uint64_t ccFirst = 0;
+			uint64_t ccLast = 0;
+			uint64_t frameFirst = 0;
+			uint64_t frameLast = 0;
+			uint8_t rewound = 0; // the cycles or the frames go back within the block, i.e. a rewind or a load
+			uint8_t pages[PC_PAGES / 8] = {}; // the bits of the executed code pages
+
+			bool HasPage(const Addr _addr) const { return pages[_addr >> (PC_PAGE_BITS + 3)] & (1 << ((_addr >> PC_PAGE_BITS) & 7)); }
+			void SetPage(const Addr _addr) { pages[_addr >> (PC_PAGE_BITS + 3)] |= 1 << ((_addr >> PC_PAGE_BITS) & 7); }
+			// the cycles and the frames keep growing from the _prev block to this one
+			bool Follows(const BlockHeader& _prev) const {
+				return !rewound && ccFirst >= _prev.ccLast && frameFirst >= _prev.frameLast; }
+		};
+#pragma pack(pop)
+
+		struct Query
+		{
+			enum class By : uint8_t { PC = 0, CC, FRAME };
+			By by = By::PC;
+			uint64_t val = 0;
+			uint64_t ccFrom = 0; // the pc search starts at the cycle
+			size_t len = 0;
+		};
+
+		struct Stats
+		{
+			bool capturing = false;
+			uint64_t records = 0;
+			uint64_t blocks = 0;
+			uint64_t bytes = 0; // written to the file
+			uint64_t rawBytes = 0; // the records
+		};
+
+		TraceCapture() = default;
+		~TraceCapture();
+
+		// Hardware thread. Creates or truncates the file
+		bool Start(const std::string& _path);
+		// Hardware thread. Writes the unfinished block and waits for the writer
+		void Stop();
+		bool IsCapturing() const { return m_capturing; }
+		// Hardware thread. Called after every instruction. Waits for the writer if all the blocks are in flight
+		void Add(const CpuI8080::State& _cpuState, const Memory::State& _memState, const uint64_t _frameNum);
+		// opens a finished capture for the queries. Fails while capturing
+		bool Open(const std::string& _path);
+		auto GetStats() const -> Stats;
+		auto GetPath() const -> std::string;
+
+		// the queries read the written blocks, they work while capturing.
+		// UI thread. Runs the query on the query thread, the previous one is canceled
+		void Find(const Query& _query);
+		// UI thread. Outputs the records and returns true once the query is done
+		bool GetFound(std::vector<Record>& _out);
+		bool IsFinding() const { return m_findingThread.joinable() && !m_found; }
+
+		// the blocking queries the query thread runs
+		// the records starting at the cycle
+		auto FindByCC(const uint64_t _cc, const size_t _len) -> std::vector<Record>;
+		// the records starting at the frame
+		auto FindByFrame(const uint64_t _frameNum, const size_t _len) -> std::vector<Record>;
+		// the executions of the addr starting at the cycle
+		auto FindByPC(const Addr _pc, const uint64_t _ccFrom, const size_t _len) -> std::vector<Record>;
+
+	private:
+		struct Block
+		{
+			std::array<Record, BLOCK_LEN> records;
+			size_t len = 0;
+		};
+
+		struct BlockIdx
+		{
+			BlockHeader header;
+			uint64_t offset = 0; // of the compressed data in the file
+		};
+
+		// writer thread
+		void Writing();
+		void WriteBlock(const Block& _block);
+		// query thread
+		void Finding(const Query _query);
+		// UI thread. Cancels the query and waits for the query thread
+		void StopFinding();
+		static void Encode(const Block& _block, std::vector<uint8_t>& _out);
+		static bool Decode(const BlockHeader& _header, const uint8_t* _dataP, std::vector<Record>& _out);
+
+		// the blocks matching _match, oldest first, until _func returns false
+		template <typename Match, typename Func>
+		void Search(const size_t _blockFirst, Match&& _match, Func&& _func);
+		// the first block whose _key is not less than _val,
+		// or the first block if a rewind or a load broke the order of the index
+		template <typename Key>
+		auto LowerBound(const uint64_t _val, Key&& _key) const -> size_t;
+
+		bool m_capturing = false;
+
+		// Hardware thread
+		std::vector<std::unique_ptr<Block>> m_blocks;
+		Block* m_blockP = nullptr; // being filled
+
+		// the threads exchange the blocks
+		SpscRing<Block*, BLOCKS_MAX> m_full; // to write
+		SpscRing<Block*, BLOCKS_MAX> m_free;
+		std::atomic_uint32_t m_wake = 0; // bumped on every full block and on the stop
+		std::atomic_bool m_stop = false;
+		std::atomic_bool m_failed = false;
+		std::thread m_writerThread;
+
+		// writer thread
+		std::ofstream m_file;
+		std::vector<uint8_t> m_raw;
+		std::vector<uint8_t> m_compressed;
+		uint64_t m_fileLen = 0;
+
+		// written by the writer thread, read by the queries
+		mutable std::mutex m_indexMutex;
+		std::string m_path;
+		uint64_t m_indexId = 0; // bumped when the index starts over, it stops the search of the old one
+		std::vector<BlockIdx> m_index;
+		bool m_monotonic = true; // the cycles and the frames of the index only grow
+		std::atomic_uint64_t m_records = 0;
+		std::atomic_uint64_t m_bytes = 0;
+		std::atomic_uint64_t m_rawBytes = 0;
+
+		// the query thread
+		std::thread m_findingThread;
+		std::atomic_bool m_findCancel = false;
+		std::atomic_bool m_found = false;
+		std::vector<Record> m_foundRecords; // owned by the query thread until m_found
+	};
+}
@@ -8,9 +8,9 @@
 #include "utils/str_utils.h"
 #include "utils/utils.h"
 
-dev::Watchpoint::Watchpoint(Data&& _data, const std::string& _comment)
+dev::Watchpoint::Watchpoint(Data&& _data, const std::string& _comment, Trigger&& _trigger)
 	:
-	data(std::move(_data)), comment(_comment)
+	data(std::move(_data)), comment(_comment), trigger(std::move(_trigger))
 {
 	//UpdateAddrMappingS();
 }
@@ -19,6 +19,7 @@ void dev::Watchpoint::Update(Watchpoint&& _bp)
 {
 	data = std::move(_bp.data);
 	comment = std::move(_bp.comment);
+	trigger = std::move(_bp.trigger);
 	//UpdateAddrMappingS();
 }
 
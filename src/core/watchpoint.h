@@ -9,6 +9,7 @@
 #include "utils/types.h"
 #include "core/cpu_i8080.h"
 #include "core/memory.h"
+#include "core/condition_expr.h"
 #include "utils/json_utils.h"
 
 namespace dev
@@ -73,7 +74,7 @@ namespace dev
 		};
 #pragma pack(pop)
 
-		Watchpoint(Data&& _data, const std::string& _comment = "");
+		Watchpoint(Data&& _data, const std::string& _comment = "", Trigger&& _trigger = {});
 
 		void Update(Watchpoint&& _bp);
 
@@ -96,11 +97,15 @@ namespace dev
 				{"type", static_cast<uint32_t>(data.type)},
 				{"len", data.len},
 				{"active", data.active},
-				{"comment", comment}
+				{"comment", comment},
+				{"expr", trigger.expr.GetExpr()},
+				{"ignore", trigger.ignoreCount},
+				{"action", static_cast<uint32_t>(trigger.action)}
 			};
 		};
 
 		Data data;
 		std::string comment;
+		Trigger trigger;
 	};
 }
\ No newline at end of file
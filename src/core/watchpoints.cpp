@@ -1,5 +1,6 @@
 
 #include <string>
+#include <algorithm>
 
 #include "core/watchpoints.h"
 #include "utils/str_utils.h"
@@ -9,6 +10,7 @@
 void dev::Watchpoints::Clear()
 {
 	m_wps.clear();
+	UpdateIndex();
 	m_updates++;
 }
 
@@ -18,13 +20,13 @@ void dev::Watchpoints::Add(Watchpoint&& _wp)
 	m_updates++;
 
 	auto wpI = m_wps.find(_wp.data.id);
-	if (wpI != m_wps.end())
-	{
+	if (wpI != m_wps.end()) {
 		wpI->second.Update(std::move(_wp));
-		return;
 	}
-	
-	m_wps.emplace(_wp.data.id, std::move(_wp));
+	else {
+		m_wps.emplace(_wp.data.id, std::move(_wp));
+	}
+	UpdateIndex();
 }
 
 void dev::Watchpoints::Add(const nlohmann::json& _wpJ)
@@ -32,16 +34,16 @@ void dev::Watchpoints::Add(const nlohmann::json& _wpJ)
 	m_updates++;
 
 	Watchpoint::Data wpData {_wpJ};
-	Watchpoint wp{ std::move(wpData), _wpJ["comment"] };
+	Watchpoint wp{ std::move(wpData), _wpJ["comment"], Trigger{ _wpJ } };
 
 	auto wpI = m_wps.find(wp.data.id);
-	if (wpI != m_wps.end())
-	{
+	if (wpI != m_wps.end()) {
 		wpI->second.Update(std::move(wp));
-		return;
 	}
-	
-	m_wps.emplace(wp.data.id, std::move(wp));
+	else {
+		m_wps.emplace(wp.data.id, std::move(wp));
+	}
+	UpdateIndex();
 }
 
 // Hardware thread
@@ -53,18 +55,60 @@ void dev::Watchpoints::Del(const dev::Id _id)
 	{
 		m_wps.erase(bpI);
 	}
+	UpdateIndex();
+}
+
+// Hardware thread
+// the page has active watchpoints
+void dev::Watchpoints::CheckPage(const size_t _page, const Watchpoint::Access _access,
+	const GlobalAddr _globalAddr, const uint8_t _value)
+{
+	for (uint32_t i = m_pageStarts[_page]; i < m_pageStarts[_page + 1]; i++)
+	{
+		auto wpP = m_pageWps[i];
+		if (wpP->Check(_access, _globalAddr, _value) &&
+			std::find(m_hitWps.begin(), m_hitWps.end(), wpP) == m_hitWps.end())
+		{
+			m_hitWps.push_back(wpP);
+		}
+	}
 }
 
 // Hardware thread
-void dev::Watchpoints::Check(const Watchpoint::Access _access, const GlobalAddr _globalAddr, const uint8_t _value)
+// rebuilds the page index. The map nodes are stable, so the index refers to them until the next change
+void dev::Watchpoints::UpdateIndex()
 {
-	auto wpI = std::find_if(m_wps.begin(), m_wps.end(),
-		[_access, _globalAddr, _value](WpMap::value_type& pair)
+	m_hitWps.clear();
+
+	// counts the watchpoints per page, then places them
+	std::vector<uint32_t> counts(PAGES, 0);
+	auto ForEachPage = [](const Watchpoint& _wp, auto _func)
+	{
+		if (!_wp.data.active || _wp.data.len == 0 || _wp.data.globalAddr >= Memory::MEMORY_GLOBAL_LEN) return;
+
+		size_t endAddr = dev::Min(size_t(_wp.data.globalAddr) + _wp.data.len, Memory::MEMORY_GLOBAL_LEN);
+		for (size_t page = _wp.data.globalAddr >> PAGE_BITS; page <= (endAddr - 1) >> PAGE_BITS; page++)
 		{
-			return pair.second.Check(_access, _globalAddr, _value);
+			_func(page);
+		}
+	};
+
+	for (const auto& [id, wp] : m_wps) {
+		ForEachPage(wp, [&](const size_t _page) { counts[_page]++; });
+	}
+
+	m_pageStarts[0] = 0;
+	for (size_t page = 0; page < PAGES; page++) {
+		m_pageStarts[page + 1] = m_pageStarts[page] + counts[page];
+	}
+
+	m_pageWps.assign(m_pageStarts[PAGES], nullptr);
+	for (auto& [id, wp] : m_wps)
+	{
+		ForEachPage(wp, [&](const size_t _page) {
+			m_pageWps[m_pageStarts[_page + 1] - counts[_page]--] = &wp;
 		});
-	
-	m_wpBreak |= wpI != m_wps.end();
+	}
 }
 
 // Hardware thread
@@ -81,11 +125,21 @@ auto dev::Watchpoints::GetUpdates()
 	return m_updates;
 }
 
-bool dev::Watchpoints::CheckBreak()
+// Hardware thread
+// called after the instruction's accesses were checked. Returns true to break
+bool dev::Watchpoints::CheckBreak(const ConditionExpr::Context& _ctx)
 {
-	if (!m_wpBreak) return false;
+	if (m_hitWps.empty()) return false;
 
-	m_wpBreak = false;
+	bool break_ = false;
+	for (auto wpP : m_hitWps)
+	{
+		auto hits = wpP->trigger.hits;
+		break_ |= wpP->trigger.Hit(_ctx, "Watchpoint", wpP->data.globalAddr);
+		// the hit counts are shown in the UI
+		if (wpP->trigger.hits != hits) m_updates++;
+	}
+	m_hitWps.clear();
 
 	// reset wps break status
 	for (auto& [id, watchpoint] : m_wps)
@@ -93,5 +147,5 @@ bool dev::Watchpoints::CheckBreak()
 		watchpoint.Reset();
 	}
 
-	return true;
+	return break_;
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "utils/types.h"
 #include "core/watchpoint.h"
@@ -15,17 +16,35 @@ public:
 		void Add(Watchpoint&& _bp);
 		void Add(const nlohmann::json& _wpJ);
 		void Del(const dev::Id _id);
-		void Check(const Watchpoint::Access _access, const GlobalAddr _globalAddr, const uint8_t _value);
+		// called for every memory access. The addrs outside the watched pages cost one lookup
+		inline void Check(const Watchpoint::Access _access, const GlobalAddr _globalAddr, const uint8_t _value)
+		{
+			if (m_pageWps.empty()) return;
+
+			size_t page = _globalAddr >> PAGE_BITS;
+			if (page >= PAGES || m_pageStarts[page] == m_pageStarts[page + 1]) return;
+
+			CheckPage(page, _access, _globalAddr, _value);
+		}
 		auto GetAll() -> const WpMap&;
 		auto GetUpdates() -> const uint32_t;
 		void Clear();
-		bool CheckBreak();
+		bool CheckBreak(const ConditionExpr::Context& _ctx);
 
 private:
+		// the index granularity
+		static constexpr size_t PAGE_BITS = 8;
+		static constexpr size_t PAGES = Memory::MEMORY_GLOBAL_LEN >> PAGE_BITS;
+
+		void CheckPage(const size_t _page, const Watchpoint::Access _access, const GlobalAddr _globalAddr, const uint8_t _value);
+		void UpdateIndex();
 
 		WpMap m_wps;
+		// the active watchpoints of the page are m_pageWps[m_pageStarts[page]] to m_pageWps[m_pageStarts[page + 1]]
+		std::vector<uint32_t> m_pageStarts = std::vector<uint32_t>(PAGES + 1, 0);
+		std::vector<Watchpoint*> m_pageWps;
 		uint32_t m_updates = 0; // counts number of updates
-		bool m_wpBreak = false;
+		std::vector<Watchpoint*> m_hitWps; // met their conditions during the instruction
 		std::string addrMappingS;
 	};
 }
\ No newline at end of file
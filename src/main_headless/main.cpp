@@ -0,0 +1,354 @@
+#include <format>
+#include <chrono>
+#include <string>
+#include <memory>
+#include <vector>
+#include <filesystem>
+#include <algorithm>
+#include <exception>
+#include <utility>
+
+#include "utils/args_parser.h"
+#include "utils/consts.h"
+#include "utils/utils.h"
+#include "utils/str_utils.h"
+#include "utils/json_utils.h"
+#include "utils/work_stealing_pool.h"
+#include "core/hardware.h"
+#include "core/debugger.h"
+#include "core/loader.h"
+#include "core/audio_sink.h"
+
+struct FarmResult
+{
+	std::string path;
+	bool loaded = false;
+	std::string error; // set when the job throws
+	uint64_t frames = 0;
+	double sec = 0;
+	uint64_t frameHash = 0;
+	uint64_t ramHash = 0;
+};
+
+// runs every rom/fdd/rec found in the dirs for the same amount of frames.
+// each job owns a hardware without the execution thread, so the jobs run in parallel on the pool workers
+static auto RunFarm(const std::string& _dirs, const int _frames, const int _threads,
+	const std::string& _pathBootData)
+-> int
+{
+	std::vector<FarmResult> results;
+	for (const auto& dir : dev::Split(_dirs, ','))
+	{
+		std::error_code ec;
+		for (const auto& entry : std::filesystem::recursive_directory_iterator(dir, ec))
+		{
+			if (!entry.is_regular_file()) continue;
+			auto path = entry.path().string();
+			auto ext = dev::StrToUpper(dev::GetExt(path));
+			if (ext != ".ROM" && ext != ".FDD" && ext != ".REC") continue;
+			results.push_back({ path });
+		}
+		if (ec) dev::Log("Failed to read the dir: {}", dir);
+	}
+	std::sort(results.begin(), results.end(),
+		[](const FarmResult& _a, const FarmResult& _b) { return _a.path < _b.path; });
+
+	dev::WorkStealingPool pool(_threads > 0 ? _threads : 0);
+	for (auto& result : results)
+	{
+		pool.Add([&result, _frames, &_pathBootData]()
+		{
+			// a throwing job would terminate the whole farm, it only fails its own instance
+			try
+			{
+				// no ramdisk file, the jobs must not share it
+				auto hardwareP = std::make_unique<dev::Hardware>(_pathBootData, "", true, false);
+				auto& hardware = *hardwareP;
+				// the debugger is only needed to deserialize the recordings
+				std::unique_ptr<dev::Debugger> debuggerP;
+				if (dev::StrToUpper(dev::GetExt(result.path)) == ".REC") {
+					debuggerP = std::make_unique<dev::Debugger>(hardware);
+				}
+
+				result.loaded = dev::LoadRomFddRec(hardware, result.path);
+				if (!result.loaded) return;
+
+				auto startTime = std::chrono::steady_clock::now();
+				auto resJ = *hardware.Request(dev::Hardware::Req::EXECUTE_UNTIL,
+					{ {"frames", _frames}, {"pc", -1}, {"cc", 0} });
+				std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+
+				result.frames = resJ["frames"];
+				result.sec = dev::Max(elapsed.count(), 1e-9);
+				auto frameP = hardware.GetFrame(true);
+				result.frameHash = dev::Hash64(reinterpret_cast<const uint8_t*>(frameP->data()), frameP->size() * sizeof(dev::ColorI));
+				auto ramP = hardware.GetRam();
+				result.ramHash = dev::Hash64(ramP->data(), ramP->size());
+			}
+			catch (const std::exception& _e) {
+				result.loaded = false;
+				result.error = _e.what();
+			}
+			catch (...) {
+				result.loaded = false;
+				result.error = "unknown exception";
+			}
+		});
+	}
+
+	auto startTime = std::chrono::steady_clock::now();
+	pool.Run();
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+
+	uint64_t framesTotal = 0;
+	for (const auto& result : results)
+	{
+		if (!result.loaded) {
+			if (result.error.empty()) dev::Log("{}: failed", result.path);
+			else dev::Log("{}: failed: {}", result.path, result.error);
+			continue;
+		}
+		framesTotal += result.frames;
+		dev::Log("{}: frames: {}, ms: {:.1f}, frames/sec: {:.1f}, framebuffer hash: {:016X}, ram hash: {:016X}",
+			result.path, result.frames, result.sec * 1000.0, result.frames / result.sec, result.frameHash, result.ramHash);
+	}
+
+	double sec = dev::Max(elapsed.count(), 1e-9);
+	dev::Log("jobs: {}, threads: {}, seconds: {:.3f}, frames/sec: {:.1f}",
+		results.size(), pool.GetWorkers(), sec, framesTotal / sec);
+
+	return (int)dev::ErrCode::NO_ERRORS;
+}
+
+// runs the file with the debugger detached, attached without features, with every feature alone, and with all of them.
+// prints the median emulation speed of every bench and its cost relative to the detached one
+static auto RunDebugBench(const std::string& _path, const int _frames, const std::string& _pathBootData)
+-> int
+{
+	struct Bench
+	{
+		const char* name;
+		bool attached;
+		uint32_t features;
+	};
+	const Bench benches[] = {
+		{ "detached", false, dev::Debugger::FEATURES_NONE },
+		{ "breakpoints only", true, dev::Debugger::FEATURES_NONE },
+		{ "counters", true, dev::Debugger::FEATURE_COUNTERS },
+		{ "last rw", true, dev::Debugger::FEATURE_LAST_RW },
+		{ "watchpoints", true, dev::Debugger::FEATURE_WATCHPOINTS },
+		{ "trace", true, dev::Debugger::FEATURE_TRACE },
+		{ "recorder", true, dev::Debugger::FEATURE_RECORDER },
+		{ "mem edits", true, dev::Debugger::FEATURE_MEM_EDITS },
+		{ "profiler", true, dev::Debugger::FEATURE_PROFILER },
+		{ "all", true, dev::Debugger::FEATURES_ALL },
+	};
+
+	// runs the bench once. Returns the seconds and the executed cpu cycles, or zero seconds on a load failure
+	auto Run = [&_path, _frames, &_pathBootData](const Bench& _bench) -> std::pair<double, uint64_t>
+	{
+		auto hardwareP = std::make_unique<dev::Hardware>(_pathBootData, "", true, false);
+		auto debuggerP = std::make_unique<dev::Debugger>(*hardwareP);
+		if (!dev::LoadRomFddRec(*hardwareP, _path)) return { 0.0, 0 };
+
+		hardwareP->Request(dev::Hardware::Req::DEBUG_RESET, { {"resetRecorder", true} });
+		hardwareP->Request(dev::Hardware::Req::DEBUG_SET_FEATURES, { {"features", _bench.features} });
+		hardwareP->Request(dev::Hardware::Req::DEBUG_ATTACH, { {"data", _bench.attached} });
+
+		auto startCC = hardwareP->RequestCC();
+		auto startTime = std::chrono::steady_clock::now();
+		auto resJ = *hardwareP->Request(dev::Hardware::Req::EXECUTE_UNTIL,
+			{ {"frames", _frames}, {"pc", -1}, {"cc", 0} });
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+
+		return { dev::Max(elapsed.count(), 1e-9), resJ["cc"].get<uint64_t>() - startCC };
+	};
+
+	// the first run warms up the caches and the cpu clock, it isn't counted
+	if (Run(benches[0]).first == 0) return (int)dev::ErrCode::UNSPECIFIED;
+
+	// the repeats are interleaved, so a drift of the host speed spreads over all the benches
+	constexpr int REPEATS = 5;
+	constexpr size_t BENCHES = sizeof(benches) / sizeof(benches[0]);
+	std::vector<double> secs[BENCHES];
+	uint64_t ccDone[BENCHES] = {};
+	for (int repeat = 0; repeat < REPEATS; repeat++)
+	{
+		for (size_t i = 0; i < BENCHES; i++)
+		{
+			auto [sec, cc] = Run(benches[i]);
+			if (sec == 0) return (int)dev::ErrCode::UNSPECIFIED;
+			secs[i].push_back(sec);
+			ccDone[i] = cc;
+		}
+	}
+
+	// the median is robust to the outliers
+	double medians[BENCHES];
+	for (size_t i = 0; i < BENCHES; i++)
+	{
+		std::sort(secs[i].begin(), secs[i].end());
+		medians[i] = secs[i][REPEATS / 2];
+	}
+
+	double baseSec = medians[0];
+	for (size_t i = 0; i < BENCHES; i++)
+	{
+		dev::Log("{}: median seconds of {} runs: {:.3f}, emulated MHz: {:.3f}, cost: {:+.1f}%",
+			benches[i].name, REPEATS, medians[i], ccDone[i] / medians[i] / 1000000.0, (medians[i] / baseSec - 1.0) * 100.0);
+	}
+
+	return (int)dev::ErrCode::NO_ERRORS;
+}
+
+// runs the rom/fdd/rec without the UI, the sound, and the realtime pacing.
+// prints the performance and the hashes of the final state to compare the runs
+int main(int argc, char** argv)
+{
+	dev::ArgsParser argsParser(argc, argv,
+		"The headless runner of the Vector06C emulator. It prints the emulation speed and the final framebuffer and ram hashes.");
+
+	auto settingsPath = argsParser.GetString("settingsPath",
+		"The path to the settings.", false, dev::GetExecutableDir() + "settings.json");
+
+	auto path = argsParser.GetString("path",
+		"The path to the rom/fdd/rec file.", false, "");
+
+	auto farmDirs = argsParser.GetString("farm",
+		"Comma separated dirs. Runs every rom/fdd/rec found in them in parallel instead of the path.", false, "");
+
+	auto threads = argsParser.GetInt("threads",
+		"The amount of the farm worker threads. 0 - the amount of the hardware threads.", false, 0);
+
+	auto frames = argsParser.GetInt("frames",
+		"The amount of frames to run. 0 - unlimited, requires pc or cc.", false, 3000);
+
+	auto pcS = argsParser.GetString("pc",
+		"Stops when the pc reaches this hex addr.", false, "");
+
+	auto ccS = argsParser.GetString("cc",
+		"Stops when the amount of the executed cpu cycles reaches this value.", false, "");
+
+	auto audioPath = argsParser.GetString("audioPath",
+		"Writes the audio to this .wav file. No audio is mixed if it is not set.", false, "");
+
+	auto loadStatePath = argsParser.GetString("loadState",
+		"Loads the save state after loading the file and continues from it.", false, "");
+
+	auto saveStatePath = argsParser.GetString("saveState",
+		"Saves the state to this file after the run.", false, "");
+
+	auto recordInputPath = argsParser.GetString("recordInput",
+		"Records the input log of the run to this .rec file. A .rec input log passed as the path is replayed.", false, "");
+
+	auto benchDebug = argsParser.GetInt("benchDebug",
+		"1 - measures the cost of every debugger feature running the path for the frames.", false, 0);
+
+	if (!argsParser.IsRequirementSatisfied()) return (int)dev::ErrCode::UNSPECIFIED;
+	if (path.empty() && farmDirs.empty()) {
+		dev::Log("Either the path or the farm is required");
+		return (int)dev::ErrCode::UNSPECIFIED;
+	}
+
+	int pc = pcS.empty() ? -1 : dev::StrHexToInt(pcS.c_str());
+	uint64_t cc = ccS.empty() ? 0 : std::stoull(ccS);
+	if (frames <= 0 && pc < 0 && cc == 0) {
+		dev::Log("At least one of the frames, pc, or cc conditions is required");
+		return (int)dev::ErrCode::UNSPECIFIED;
+	}
+
+	nlohmann::json settingsJ = nlohmann::json::object();
+	if (dev::IsFileExist(settingsPath)) {
+		settingsJ = dev::LoadJson(settingsPath);
+	}
+
+	std::string pathBootData = settingsJ.value("bootPath", "boot//boot.bin");
+	std::string ramDiskDataPath = settingsJ.value("ramDiskDataPath", "ramDisks.bin");
+	bool ramDiskClearAfterRestart = settingsJ.value("ramDiskClearAfterRestart", false);
+
+	if (!farmDirs.empty()) {
+		if (frames <= 0) {
+			dev::Log("The farm requires the frames");
+			return (int)dev::ErrCode::UNSPECIFIED;
+		}
+		return RunFarm(farmDirs, frames, threads, pathBootData);
+	}
+
+	if (benchDebug) {
+		if (path.empty() || frames <= 0) {
+			dev::Log("The debugger benchmark requires the path and the frames");
+			return (int)dev::ErrCode::UNSPECIFIED;
+		}
+		return RunDebugBench(path, frames, pathBootData);
+	}
+
+	// the hardware and the debugger are too large for the stack
+	auto hardwareP = std::make_unique<dev::Hardware>(pathBootData, ramDiskDataPath, ramDiskClearAfterRestart);
+	auto& hardware = *hardwareP;
+	auto debuggerP = std::make_unique<dev::Debugger>(hardware); // required to deserialize the recordings
+
+	if (!dev::LoadRomFddRec(hardware, path)) return (int)dev::ErrCode::UNSPECIFIED;
+
+	if (!loadStatePath.empty()) {
+		auto stateRes = dev::LoadFile(loadStatePath);
+		if (!stateRes || !hardware.RequestLoadState(*stateRes)) {
+			dev::Log("Failed to load the state: {}", loadStatePath);
+			return (int)dev::ErrCode::UNSPECIFIED;
+		}
+	}
+
+	std::unique_ptr<dev::WavAudioSink> audioSinkP;
+	if (!audioPath.empty()) {
+		audioSinkP = std::make_unique<dev::WavAudioSink>(audioPath, dev::Audio::OUTPUT_RATE);
+		if (!audioSinkP->IsInited()) return (int)dev::ErrCode::UNSPECIFIED;
+		hardware.AttachAudioSink(audioSinkP.get());
+	}
+
+	if (!recordInputPath.empty()) {
+		hardware.Request(dev::Hardware::Req::INPUT_LOG_RECORD);
+	}
+
+	auto startCC = hardware.RequestCC();
+	auto startTime = std::chrono::steady_clock::now();
+
+	auto resJ = *hardware.Request(dev::Hardware::Req::EXECUTE_UNTIL,
+		{ {"frames", frames > 0 ? frames : 0}, {"pc", pc}, {"cc", cc} });
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+	hardware.AttachAudioSink(nullptr);
+
+	uint64_t framesDone = resJ["frames"];
+	uint64_t ccDone = resJ["cc"].get<uint64_t>() - startCC;
+	double sec = dev::Max(elapsed.count(), 1e-9);
+
+	auto frameP = hardware.GetFrame(true);
+	auto frameHash = dev::Hash64(reinterpret_cast<const uint8_t*>(frameP->data()), frameP->size() * sizeof(dev::ColorI));
+	auto ramP = hardware.GetRam();
+	auto ramHash = dev::Hash64(ramP->data(), ramP->size());
+
+	dev::Log("frames: {}", framesDone);
+	dev::Log("cpu cycles: {}", ccDone);
+	dev::Log("pc: {:04X}{}", resJ["pc"].get<int>(), resJ["pcReached"].get<bool>() ? " (reached)" : "");
+	dev::Log("seconds: {:.3f}", sec);
+	dev::Log("frames/sec: {:.1f}", framesDone / sec);
+	dev::Log("emulated MHz: {:.3f}", ccDone / sec / 1000000.0);
+	dev::Log("framebuffer hash: {:016X}", frameHash);
+	dev::Log("ram hash: {:016X}", ramHash);
+
+	if (!saveStatePath.empty()) {
+		dev::SaveFile(saveStatePath, hardware.RequestSaveState(), true);
+	}
+
+	auto inputLogJ = *hardware.Request(dev::Hardware::Req::INPUT_LOG_GET_STATUS);
+	if (inputLogJ["divergedCC"].get<uint64_t>() != dev::InputLog::CC_NONE) {
+		dev::Log("input log replay diverged at cc: {}", inputLogJ["divergedCC"].get<uint64_t>());
+	}
+
+	if (!recordInputPath.empty()) {
+		auto logJ = *hardware.Request(dev::Hardware::Req::INPUT_LOG_STOP);
+		auto& data = logJ["data"].get_binary();
+		dev::SaveFile(recordInputPath, std::vector<uint8_t>(data.begin(), data.end()), true);
+	}
+
+	return (int)dev::ErrCode::NO_ERRORS;
+}
@@ -57,6 +57,7 @@ dev::DevectorApp::~DevectorApp()
 	SettingsUpdate("keyboardWindowVisible", m_keyboardWindowVisible);
 	SettingsUpdate("searchWindowVisible", m_searchWindowVisible);
 	SettingsUpdate("debugdataWindowVisible", m_debugdataWindowVisible);
+	SettingsUpdate("profilerWindowVisible", m_profilerWindowVisible);
 }
 
 void dev::DevectorApp::HardwareInit()
@@ -66,7 +67,9 @@ void dev::DevectorApp::HardwareInit()
 	m_ramDiskClearAfterRestart = GetSettingsBool("ramDiskClearAfterRestart", false);
 	m_ramDiskDataPath = GetSettingsString("ramDiskDataPath", "ramDisks.bin");
 
+	m_audioSinkP = std::make_unique < dev::SdlAudioSink>();
 	m_hardwareP = std::make_unique < dev::Hardware>(pathBootData, m_ramDiskDataPath, m_ramDiskClearAfterRestart);
+	m_hardwareP->AttachAudioSink(m_audioSinkP.get());
 	m_debuggerP = std::make_unique < dev::Debugger>(*m_hardwareP);
 }
 
@@ -87,6 +90,7 @@ void dev::DevectorApp::WindowsInit()
 	m_keyboardWindowP = std::make_unique<dev::KeyboardWindow>(*m_hardwareP, &m_dpiScale, m_glUtils, m_reqUI, m_pathImgKeyboard);
 	m_searchWindowP = std::make_unique<dev::SearchWindow>(*m_hardwareP, *m_debuggerP, &m_dpiScale, m_reqUI);
 	m_debugdataWindowP = std::make_unique<dev::DebugDataWindow>(*m_hardwareP, *m_debuggerP, &m_dpiScale, m_reqUI);
+	m_profilerWindowP = std::make_unique<dev::ProfilerWindow>(*m_hardwareP, *m_debuggerP, &m_dpiScale, m_reqUI);
 }
 
 void dev::DevectorApp::SettingsInit()
@@ -106,6 +110,7 @@ void dev::DevectorApp::SettingsInit()
 	m_keyboardWindowVisible = GetSettingsBool("keyboardWindowVisible", false);
 	m_searchWindowVisible = GetSettingsBool("searchWindowVisible", false);
 	m_debugdataWindowVisible = GetSettingsBool("debugdataWindowVisible", false);
+	m_profilerWindowVisible = GetSettingsBool("profilerWindowVisible", false);
 
 	m_pathImgKeyboard = GetSettingsString("pathImgKeyboard", "images//vector_keyboard.jpg");
 
@@ -177,6 +182,7 @@ void dev::DevectorApp::Update()
 	m_keyboardWindowP->Update(m_keyboardWindowVisible, isRunning);
 	m_searchWindowP->Update(m_searchWindowVisible, isRunning);
 	m_debugdataWindowP->Update(m_debugdataWindowVisible, isRunning);
+	m_profilerWindowP->Update(m_profilerWindowVisible, isRunning);
 
 	// context menues to edit the debug data
 	DrawEditLabelWindow(*m_hardwareP, m_debuggerP->GetDebugData(), m_reqUI);
@@ -273,6 +279,15 @@ void dev::DevectorApp::MainMenuUpdate()
 
 			ImGui::Separator();
 
+			if (ImGui::MenuItem("Record Input", nullptr, m_inputRecording)) { InputRecordingToggle(); }
+
+			ImGui::Separator();
+
+			if (ImGui::MenuItem("Quick Save")) { QuickSave(); }
+			if (ImGui::MenuItem("Quick Load", nullptr, false, !m_quickState.empty())) { QuickLoad(); }
+
+			ImGui::Separator();
+
 			if (ImGui::MenuItem("Quit", "Alt+F4")) { m_status = AppStatus::REQ_PREPARE_FOR_EXIT; }
 			ImGui::EndMenu();
 		}
@@ -290,6 +305,7 @@ void dev::DevectorApp::MainMenuUpdate()
 			ImGui::MenuItem(m_keyboardWindowP->m_name.c_str(), NULL, &m_keyboardWindowVisible);
 			ImGui::MenuItem(m_searchWindowP->m_name.c_str(), NULL, &m_searchWindowVisible);
 			ImGui::MenuItem(m_debugdataWindowP->m_name.c_str(), NULL, &m_debugdataWindowVisible);
+			ImGui::MenuItem(m_profilerWindowP->m_name.c_str(), NULL, &m_profilerWindowVisible);
 			ImGui::EndMenu();
 		}
 
@@ -705,16 +721,8 @@ void dev::DevectorApp::SaveFile()
 	
 		if (filename)
 		{
-			auto result = m_hardwareP->Request(Hardware::Req::DEBUG_RECORDER_SERIALIZE);
-			if (result)
-			{
-				nlohmann::json::binary_t binaryData = result->at("data").get<nlohmann::json::binary_t>();
-				std::vector<uint8_t> data(binaryData.begin(), binaryData.end());
-
-				std::string path = std::string(filename);
-
-				if (!data.empty()) dev::SaveFile(path, data, true);
-			}
+			auto result = m_hardwareP->Request(Hardware::Req::DEBUG_RECORDER_SAVE, { {"path", std::string(filename)} });
+			if (!result || !result->at("result")) dev::Log("Failed to save the recording: {}", filename);
 		}
 		break;
 	}
@@ -769,6 +777,42 @@ void dev::DevectorApp::ReqUIHandling()
 }
 
 
+void dev::DevectorApp::InputRecordingToggle()
+{
+	m_inputRecording = !m_inputRecording;
+	if (m_inputRecording) {
+		m_hardwareP->Request(Hardware::Req::INPUT_LOG_RECORD);
+		return;
+	}
+
+	auto result = m_hardwareP->Request(Hardware::Req::INPUT_LOG_STOP);
+	if (!result || !result->contains("data")) return;
+
+	const char* filters[] = { "*.rec" };
+	const char* filename = tinyfd_saveFileDialog(
+		"Save Input Recording", "file_name.rec", sizeof(filters) / sizeof(const char*), filters, nullptr);
+	if (!filename) return;
+
+	auto& data = result->at("data").get_binary();
+	dev::SaveFile(filename, std::vector<uint8_t>(data.begin(), data.end()), true);
+}
+
+void dev::DevectorApp::QuickSave()
+{
+	m_quickState = m_hardwareP->RequestSaveState();
+	Log("State saved: {} bytes", m_quickState.size());
+}
+
+void dev::DevectorApp::QuickLoad()
+{
+	if (!m_hardwareP->RequestLoadState(m_quickState)) {
+		Log("Failed to load the state");
+		return;
+	}
+	m_hardwareP->Request(Hardware::Req::DEBUG_RESET, { {"resetRecorder", true} }); // the recorder history doesn't match the loaded state
+	m_reqUI.type = ReqUI::Type::DISASM_UPDATE;
+}
+
 void dev::DevectorApp::LoadRom(const std::string& _path)
 {
 	auto result = dev::LoadFile(_path);
@@ -842,11 +886,25 @@ void dev::DevectorApp::LoadRecording(const std::string& _path)
 
 	m_hardwareP->Request(Hardware::Req::STOP);
 	m_hardwareP->Request(Hardware::Req::RESET);
-	m_hardwareP->Request(Hardware::Req::RESTART);
-
-	m_hardwareP->Request(Hardware::Req::DEBUG_RECORDER_DESERIALIZE, { {"data", nlohmann::json::binary(*result)} });
 
-	m_hardwareP->Request(Hardware::Req::DEBUG_RESET, { {"resetRecorder", false} }); // has to be called after Hardware loading Rom because it stores the last state of Hardware
+	if (InputLog::IsInputLog(*result))
+	{
+		auto resJ = m_hardwareP->Request(Hardware::Req::INPUT_LOG_PLAY, { {"data", nlohmann::json::binary(*result)} });
+		if (!resJ || !resJ->at("result")) {
+			dev::Log("Failed to replay the input log: {}", _path);
+			return;
+		}
+		m_hardwareP->Request(Hardware::Req::DEBUG_RESET, { {"resetRecorder", true} }); // the history starts with the replay
+	}
+	else {
+		m_hardwareP->Request(Hardware::Req::RESTART);
+		auto resJ = m_hardwareP->Request(Hardware::Req::DEBUG_RECORDER_LOAD, { {"path", _path} });
+		if (!resJ || !resJ->at("result")) {
+			dev::Log("Failed to load the recording: {}", _path);
+			return;
+		}
+		m_hardwareP->Request(Hardware::Req::DEBUG_RESET, { {"resetRecorder", false} }); // has to be called after Hardware loading Rom because it stores the last state of Hardware
+	}
 	m_debuggerP->GetDebugData().LoadDebugData(_path);
 	m_reqUI.type = ReqUI::Type::DISASM_UPDATE;
 
@@ -857,7 +915,24 @@ void dev::DevectorApp::LoadRecording(const std::string& _path)
 void dev::DevectorApp::DebugAttach()
 {
 	bool requiresDebugger = m_disasmWindowVisible || m_breakpointsWindowVisisble || m_watchpointsWindowVisible ||
-		m_hexViewerWindowVisible || m_traceLogWindowVisible || m_recorderWindowVisible;
+		m_hexViewerWindowVisible || m_traceLogWindowVisible || m_traceLogWindowP->IsCapturing() || m_recorderWindowVisible || m_memDisplayWindowVisible ||
+		m_profilerWindowVisible || m_displayWindowP->IsRasterOverlay();
+
+	// the per-instruction work only for the open windows
+	uint32_t debuggerFeatures = Debugger::FEATURE_WATCHPOINTS | Debugger::FEATURE_MEM_EDITS;
+	if (m_disasmWindowVisible) debuggerFeatures |= Debugger::FEATURE_COUNTERS;
+	if (m_memDisplayWindowVisible) debuggerFeatures |= Debugger::FEATURE_LAST_RW;
+	if (m_traceLogWindowVisible || m_traceLogWindowP->IsCapturing()) debuggerFeatures |= Debugger::FEATURE_TRACE;
+	// the recorder keeps the history while the debugger is attached, its window only shows it
+	if (requiresDebugger) debuggerFeatures |= Debugger::FEATURE_RECORDER;
+	if (m_profilerWindowVisible || m_displayWindowP->IsRasterOverlay()) debuggerFeatures |= Debugger::FEATURE_PROFILER;
+
+	if (debuggerFeatures != m_debuggerFeatures)
+	{
+		m_debuggerFeatures = debuggerFeatures;
+		m_hardwareP->Request(Hardware::Req::DEBUG_SET_FEATURES, { { "features", debuggerFeatures } });
+	}
+
 	if (requiresDebugger != m_debuggerAttached)
 	{
 		m_debuggerAttached = requiresDebugger;
@@ -18,12 +18,14 @@
 #include "ui/about_window.h"
 #include "ui/feedback_window.h"
 #include "ui/recorder_window.h"
+#include "ui/profiler_window.h"
 #include "ui/keyboard_window.h"
 #include "ui/search_window.h"
 #include "ui/debugdata_window.h"
 
 #include "core/hardware.h"
 #include "core/debugger.h"
+#include "core/audio_sdl.h"
 
 namespace dev
 {
@@ -90,6 +92,7 @@ namespace dev
 		};
 		LoadingRes m_loadingRes; // loading resource info
 
+		std::unique_ptr <dev::SdlAudioSink> m_audioSinkP; // has to outlive the Hardware
 		std::unique_ptr <dev::Hardware> m_hardwareP;
 		std::unique_ptr <dev::Debugger> m_debuggerP;
 		std::unique_ptr <dev::BreakpointsWindow>m_breakpointsWindowP;
@@ -106,6 +109,7 @@ namespace dev
 		std::unique_ptr <dev::KeyboardWindow> m_keyboardWindowP;
 		std::unique_ptr <dev::SearchWindow> m_searchWindowP;
 		std::unique_ptr <dev::DebugDataWindow> m_debugdataWindowP;
+		std::unique_ptr <dev::ProfilerWindow> m_profilerWindowP;
 
 		bool m_displayWindowVisible = false;
 		bool m_disasmWindowVisible = false;
@@ -121,6 +125,7 @@ namespace dev
 		bool m_keyboardWindowVisible = false;
 		bool m_searchWindowVisible = false;
 		bool m_debugdataWindowVisible = false;
+		bool m_profilerWindowVisible = false;
 
 		std::string m_pathImgKeyboard;
 
@@ -132,6 +137,10 @@ namespace dev
 		int m_rustLatSwitched = 0;
 
 		bool m_debuggerAttached = false;
+		uint32_t m_debuggerFeatures = Debugger::FEATURES_ALL;
+
+		std::vector<uint8_t> m_quickState; // the quick save slot
+		bool m_inputRecording = false; // unchecking it saves the input log to a .rec file
 
 		// path, file type, driveIdx, autoBoot
 		using RecentFile = std::tuple<FileType, std::string, int, bool>;
@@ -176,5 +185,8 @@ namespace dev
 		void DebugAttach();
 		void RestartOnLoadFdd();
 		void MountRecentFddImg();
+		void InputRecordingToggle();
+		void QuickSave();
+		void QuickLoad();
 	};
 }
\ No newline at end of file
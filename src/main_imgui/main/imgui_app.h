@@ -18,6 +18,7 @@
 #endif
 
 #include "utils/json_utils.h"
+#include "utils/tqueue.h"
 
 namespace dev {
 
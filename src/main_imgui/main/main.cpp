@@ -7,6 +7,40 @@
 #include "utils/json_utils.h"
 #include "utils/consts.h"
 #include "devector_app.h"
+#include "core/hardware.h"
+#include "core/debugger.h"
+#include "core/exporter.h"
+#include "core/loader.h"
+
+// runs the rom/fdd/rec without the UI and the realtime pacing, writes the video and the audio to files
+static int Export(const nlohmann::json& _settingsJ, const std::string& _path,
+    const std::string& _videoPath, const std::string& _audioPath,
+    const int _frames, const int _workers)
+{
+    std::string pathBootData = _settingsJ.value("bootPath", "boot//boot.bin");
+    std::string ramDiskDataPath = _settingsJ.value("ramDiskDataPath", "ramDisks.bin");
+    bool ramDiskClearAfterRestart = _settingsJ.value("ramDiskClearAfterRestart", false);
+
+    dev::Hardware hardware(pathBootData, ramDiskDataPath, ramDiskClearAfterRestart);
+    dev::Debugger debugger(hardware); // required to deserialize the recordings
+    dev::Exporter exporter(_videoPath, _audioPath, _workers);
+    if (!exporter.IsInited()) return (int)dev::ErrCode::UNSPECIFIED;
+
+    if (!dev::LoadRomFddRec(hardware, _path)) return (int)dev::ErrCode::UNSPECIFIED;
+
+    hardware.AttachExportFunc(std::bind(&dev::Exporter::Push, &exporter, std::placeholders::_1, std::placeholders::_2));
+
+    auto startTime = std::chrono::steady_clock::now();
+    uint64_t frames = hardware.Request(dev::Hardware::Req::EXPORT_FRAMES, { {"frames", _frames} })->at("frames");
+    exporter.Finish();
+    hardware.AttachExportFunc(nullptr);
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+    dev::Log("Export: {} frames done in {} sec, {}x realtime", 
+        frames, elapsed.count(), frames * dev::Exporter::FRAME_RATE_DEN / (dev::Exporter::FRAME_RATE_NUM * elapsed.count()));
+
+    return (int)dev::ErrCode::NO_ERRORS;
+}
 
 int main(int argc, char** argv)
 {
@@ -24,12 +58,27 @@ int main(int argc, char** argv)
         rom_fdd_recPath = "";
     }
 
+    auto exportVideoPath = argsParser.GetString("exportVideo",
+        "Headless export. The path to the video file: .rgba (raw RGBA stream), .y4m, or .png (PNG sequence).", false, "");
+
+    auto exportAudioPath = argsParser.GetString("exportAudio",
+        "Headless export. The path to the audio file: .wav (32-bit float, 50 KHz, mono) or .raw (raw float).", false, "");
+
+    auto exportFrames = argsParser.GetInt("exportFrames",
+        "Headless export. The amount of frames to export.", false, 0);
+
+    auto exportSeconds = argsParser.GetDouble("exportSeconds",
+        "Headless export. The emulated time to export in seconds. Used when exportFrames is not set.", false, 10.0);
+
+    auto exportThreads = argsParser.GetInt("exportThreads",
+        "Headless export. The amount of the frame encoding threads. 0 - auto.", false, 0);
+
     if (!argsParser.IsRequirementSatisfied())
     {
         dev::Log("---Settings parameters are missing");
     }
 
-    nlohmann::json settingsJ;
+    nlohmann::json settingsJ = nlohmann::json::object();
     if (dev::IsFileExist(settingsPath) == false)
     {
         dev::Log("The settings wasn't found. Created new default settings: {}", settingsPath);
@@ -38,6 +87,17 @@ int main(int argc, char** argv)
         settingsJ = dev::LoadJson(settingsPath);
     }
 
+    if (!exportVideoPath.empty() || !exportAudioPath.empty())
+    {
+        if (rom_fdd_recPath.empty()) {
+            dev::Log("Export: the path to the rom/fdd/rec file is required");
+            return (int)dev::ErrCode::UNSPECIFIED;
+        }
+        int frames = exportFrames > 0 ? exportFrames :
+            int(exportSeconds * dev::Exporter::FRAME_RATE_NUM / dev::Exporter::FRAME_RATE_DEN);
+        return Export(settingsJ, rom_fdd_recPath, exportVideoPath, exportAudioPath, frames, exportThreads);
+    }
+
     auto app = dev::DevectorApp(settingsPath, settingsJ, rom_fdd_recPath);
     if (!app.IsInited()) return (int)app.GetError();
     app.Run();
@@ -59,7 +59,7 @@ void dev::BreakpointsWindow::DrawTable()
 	bool showItemContextMenu = false;
 	static int editedBreakpointAddr = -1;
 	static ReqPopup reqPopup = ReqPopup::NONE;
-	const int COLUMNS_COUNT = 4;
+	const int COLUMNS_COUNT = 5;
 
 	const char* tableName = "##Breakpoints";
 	ImGui::PushStyleVar(ImGuiStyleVar_CellPadding, { 5.0f, 0.0f });
@@ -74,6 +74,7 @@ void dev::BreakpointsWindow::DrawTable()
 		ImGui::TableSetupColumn("##BPActive", ImGuiTableColumnFlags_WidthFixed, 25);
 		ImGui::TableSetupColumn("Addr", ImGuiTableColumnFlags_WidthFixed, 110);
 		ImGui::TableSetupColumn("Condition", ImGuiTableColumnFlags_WidthFixed, 180);
+		ImGui::TableSetupColumn("Hits", ImGuiTableColumnFlags_WidthFixed, 60);
 		ImGui::TableSetupColumn("Comment", ImGuiTableColumnFlags_WidthStretch);
 		
 		ImGui::TableNextRow(ImGuiTableRowFlags_Headers);
@@ -137,6 +138,10 @@ void dev::BreakpointsWindow::DrawTable()
 			DrawProperty(cond);
 			CheckIfItemClicked(rowMin, showItemContextMenu, addr, editedBreakpointAddr, reqPopup);
 
+			// Hits
+			DrawProperty(std::to_string(bp.trigger.hits));
+			CheckIfItemClicked(rowMin, showItemContextMenu, addr, editedBreakpointAddr, reqPopup);
+
 			// Comment
 			DrawProperty(bp.comment);
 			CheckIfItemClicked(rowMin, showItemContextMenu, addr, editedBreakpointAddr, reqPopup);
@@ -235,12 +240,18 @@ void dev::BreakpointsWindow::DrawPopup(ReqPopup& _reqPopup, const Breakpoints::B
 	static int selectedCond = 0;
 	static int val = 0;
 	static std::string comment = "";
+	static std::string expr = "";
+	static int ignoreCount = 0;
+	static int action = 0;
 	static ImVec2 buttonSize = { 65.0f, 25.0f };
 
 	// Init for a new BP
 	if (_reqPopup == ReqPopup::INIT_ADD) {
 		_reqPopup = ReqPopup::ADD;
 		comment = "";
+		expr = "";
+		ignoreCount = 0;
+		action = 0;
 		addrOld = 0xFF;
 		addr = 0xFF;
 	}
@@ -258,6 +269,9 @@ void dev::BreakpointsWindow::DrawPopup(ReqPopup& _reqPopup, const Breakpoints::B
 		selectedOp = static_cast<int>(bp.data.structured.operand);
 		selectedCond = static_cast<int>(bp.data.structured.cond);
 		comment = bp.comment;
+		expr = bp.trigger.expr.GetExpr();
+		ignoreCount = bp.trigger.ignoreCount;
+		action = static_cast<int>(bp.trigger.action);
 	}
 
 	if (ImGui::BeginPopup("##BpEdit"))
@@ -303,7 +317,29 @@ void dev::BreakpointsWindow::DrawPopup(ReqPopup& _reqPopup, const Breakpoints::B
 				"A hexademical value in the format FF",
 				ImGuiInputTextFlags_CharsHexadecimal | ImGuiInputTextFlags_AutoSelectAll);
 			if (selectedCond == 0) ImGui::EndDisabled();
-			
+
+			// Expression
+			DrawProperty2EditableS("Expression", "##BPContextExpr", &expr, "HL==0x8000 && [SP+2]>5",
+				"An extra condition, empty means always true\n"\
+				"A F B C D E H L PSW BC DE HL SP PC - CPU registers\n"\
+				"CC - CPU Cicles, frame - the frame number\n"\
+				"raster_line, raster_pixel - the beam position\n"\
+				"[addr] - a byte, w[addr] - a word in the RAM,\n"\
+				"the addr with SP reads the stack mapping\n"\
+				"Numbers: 10, 0xFF. Operators: ! ~ - * / % + - << >> < <= > >= == != & ^ | && ||",
+				0);
+
+			// Ignore
+			DrawProperty2EditableI("Ignore", "##BPContextIgnore", &ignoreCount,
+				"The number of the first hits that don't break",
+				ImGuiInputTextFlags_CharsDecimal | ImGuiInputTextFlags_AutoSelectAll);
+
+			// Action
+			DrawProperty2Combo("Action", "##BPContextAction", &action,
+				dev::triggerActionsS, IM_ARRAYSIZE(dev::triggerActionsS),
+				"Break - halts the execution\n"\
+				"Log - prints the registers to the log and continues");
+
 			// Comment
 			DrawProperty2EditableS("Comment", "##BPContextComment", &comment, "");
 
@@ -319,6 +355,9 @@ void dev::BreakpointsWindow::DrawPopup(ReqPopup& _reqPopup, const Breakpoints::B
 				UINT16_MAX : UINT8_MAX;
 			warningS = val < 0 || val > maxVal ?
 				"A value is out of range" : warningS;
+			warningS = ignoreCount < 0 ? "A negative ignore count" : warningS;
+			ConditionExpr exprCheck;
+			warningS = exprCheck.Compile(expr) ? warningS : exprCheck.GetError();
 
 			ImGui::TextColored(DASM_CLR_WARNING, warningS.c_str());
 
@@ -345,7 +384,10 @@ void dev::BreakpointsWindow::DrawPopup(ReqPopup& _reqPopup, const Breakpoints::B
 					{"data0", bpData.data0 },
 					{"data1", bpData.data1 },
 					{"data2", bpData.data2 },
-					{"comment", comment}
+					{"comment", comment},
+					{"expr", expr},
+					{"ignore", ignoreCount},
+					{"action", action}
 				});
 				m_reqUI.type = ReqUI::Type::DISASM_UPDATE;
 				ImGui::CloseCurrentPopup();
@@ -384,7 +426,7 @@ void dev::BreakpointsWindow::UpdateBreakpoints()
 		{
 			Breakpoint::Data bpData{ breakpointJ["data0"], breakpointJ["data1"], breakpointJ["data2"] };
 
-			Breakpoint bp{ std::move(bpData), breakpointJ["comment"] };
+			Breakpoint bp{ std::move(bpData), breakpointJ["comment"], Trigger{ breakpointJ } };
 			auto addr = bp.data.structured.addr;
 			m_breakpoints.emplace(addr, std::move(bp));
 		}
@@ -67,7 +67,7 @@ void dev::DebugDataWindow::Draw(const bool _isRunning)
 void dev::DebugDataWindow::UpdateData(const bool _isRunning)
 {
 	// check if the hardware updated its state
-	uint64_t cc = m_hardware.Request(Hardware::Req::GET_CC)->at("cc");
+	uint64_t cc = m_hardware.GetSnapshot().cpuState.cc;
 	auto ccDiff = cc - m_ccLast;
 	if (ccDiff == 0) return;
 	m_ccLast = cc;
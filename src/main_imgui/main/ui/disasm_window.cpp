@@ -288,7 +288,7 @@ void dev::DisasmWindow::DrawDisasm(const bool _isRunning)
 	if (!m_disasmPP || !*m_disasmPP) return;
 	auto& disasm = **m_disasmPP;
 
-	Addr regPC = m_hardware.Request(Hardware::Req::GET_REG_PC)->at("pc");
+	Addr regPC = m_hardware.GetSnapshot().cpuState.regs.pc.word;
 	int hoveredLineIdx = -1;
 	ImVec2 selectionMin = ImGui::GetCursorScreenPos();
 	ImVec2 selectionMax = ImVec2(selectionMin.x + ImGui::GetWindowWidth(), selectionMin.y);
@@ -433,17 +433,14 @@ void dev::DisasmWindow::UpdateData(const bool _isRunning)
 
 	if (_isRunning) return;
 
-	auto res = m_hardware.Request(Hardware::Req::GET_CC);
-	const auto& data = *res;
-
-	uint64_t cc = data["cc"];
+	uint64_t cc = m_hardware.GetSnapshot().cpuState.cc;
 	auto ccDiff = cc - m_ccLast;
 	m_ccLastRun = ccDiff == 0 ? m_ccLastRun : ccDiff;
 	m_ccLast = cc;
 	if (ccDiff == 0) return;
 
 	// update
-	Addr addr = m_hardware.Request(Hardware::Req::GET_REG_PC)->at("pc");
+	Addr addr = m_hardware.GetSnapshot().cpuState.regs.pc.word;
 
 	UpdateDisasm(addr);
 }
@@ -189,7 +189,8 @@ void dev::DisplayWindow::UpdateData(const bool _isRunning)
 {
 	//ReqHandling();
 
-	uint64_t cc = m_hardware.Request(Hardware::Req::GET_CC)->at("cc");
+	auto snapshot = m_hardware.GetSnapshot();
+	uint64_t cc = snapshot.cpuState.cc;
 	auto ccDiff = cc - m_ccLast;
 	m_ccLastRun = ccDiff == 0 ? m_ccLastRun : ccDiff;
 	m_ccLast = cc;
@@ -200,10 +201,8 @@ void dev::DisplayWindow::UpdateData(const bool _isRunning)
 	{
 		if (ccDiff) 
 		{
-			auto res = m_hardware.Request(Hardware::Req::GET_DISPLAY_DATA);
-			const auto& displayData = *res;
-			m_rasterPixel = displayData["rasterPixel"];
-			m_rasterLine = displayData["rasterLine"];
+			m_rasterPixel = snapshot.rasterPixel;
+			m_rasterLine = snapshot.rasterLine;
 		}
 		if (!m_displayIsHovered)
 		{
@@ -297,6 +296,7 @@ void dev::DisplayWindow::DrawDisplay()
 		auto framebufferTex = m_glUtils.GetFramebufferTexture(m_vramMatId);
 		ImGui::Image(framebufferTex, displaySize, borderMin, borderMax);
 		m_displayIsHovered = ImGui::IsItemHovered();
+		if (m_rasterOverlay) DrawRasterOverlay(borderMin, borderMax);
 		
 		if (ImGui::IsItemClicked(ImGuiMouseButton_Right))
 		{
@@ -313,6 +313,7 @@ void dev::DisplayWindow::DrawContextMenu()
 		{
 			ImGui::Combo("Border Type", (int*)(&m_borderType), m_borderTypeS);
 			ImGui::Combo("Display Size", (int*)(&m_displaySize), m_displaySizeS);
+			ImGui::Checkbox("Raster Profiler Overlay", &m_rasterOverlay);
 			ImGui::EndMenu();
 		}
 		if (ImGui::BeginMenu("Emulation Settings"))
@@ -334,6 +335,59 @@ void dev::DisplayWindow::DrawContextMenu()
 		ImGui::EndPopup();
 	}
 }
+// draws the beam positions the profiler regions ran at in the last frame over the display image
+void dev::DisplayWindow::DrawRasterOverlay(const ImVec2& _borderMin, const ImVec2& _borderMax)
+{
+	auto result = m_hardware.Request(Hardware::Req::DEBUG_PROFILER_GET_RASTER, { {"frames", 1} });
+	if (!result || result->at("frames").empty()) return;
+
+	std::vector<ImU32> colors;
+	for (const auto& regionJ : result->at("regions"))
+	{
+		uint32_t color = regionJ["color"];
+		colors.push_back(IM_COL32(color >> 24, (color >> 16) & 0xFF, (color >> 8) & 0xFF, color & 0xFF));
+	}
+
+	// maps the frame coordinates to the image rect
+	ImVec2 rectMin = ImGui::GetItemRectMin();
+	ImVec2 rectMax = ImGui::GetItemRectMax();
+	float scaleX = (rectMax.x - rectMin.x) / ((_borderMax.x - _borderMin.x) * Display::FRAME_W);
+	float scaleY = (rectMax.y - rectMin.y) / ((_borderMax.y - _borderMin.y) * Display::FRAME_H);
+	float offsetX = rectMin.x - _borderMin.x * Display::FRAME_W * scaleX;
+	float offsetY = rectMin.y - _borderMin.y * Display::FRAME_H * scaleY;
+
+	auto drawList = ImGui::GetWindowDrawList();
+	auto DrawRect = [&](const int _x0, const int _y0, const int _x1, const int _y1, const ImU32 _color) {
+		if (_x0 >= _x1 || _y0 >= _y1) return;
+		drawList->AddRectFilled(
+			{ offsetX + _x0 * scaleX, offsetY + _y0 * scaleY },
+			{ offsetX + _x1 * scaleX, offsetY + _y1 * scaleY }, _color);
+	};
+
+	drawList->PushClipRect(rectMin, rectMax, true);
+	for (const auto& spanJ : result->at("frames").back()["spans"])
+	{
+		int region = spanJ[0];
+		int start = spanJ[1];
+		int end = spanJ[2];
+		if (region >= colors.size()) continue;
+
+		// a span is the partial first line, the full lines, and the partial last line
+		int startLine = start / Display::FRAME_W;
+		int endLine = end / Display::FRAME_W;
+		ImU32 color = colors[region];
+		if (startLine == endLine)
+		{
+			DrawRect(start % Display::FRAME_W, startLine, end % Display::FRAME_W, startLine + 1, color);
+			continue;
+		}
+		DrawRect(start % Display::FRAME_W, startLine, Display::FRAME_W, startLine + 1, color);
+		DrawRect(0, startLine + 1, Display::FRAME_W, endLine, color);
+		DrawRect(0, endLine, end % Display::FRAME_W, endLine + 1, color);
+	}
+	drawList->PopClipRect();
+}
+
 /*
 void dev::DisplayWindow::ReqHandling()
 {
@@ -58,11 +58,13 @@ namespace dev
 		dev::Id m_vramMatId	= -1;		
 		bool m_isGLInited = false;
 		bool m_displayIsHovered = false;
+		bool m_rasterOverlay = false; // draws the regions of the raster profiler over the frame
 		const char* m_contextMenuName = "##displayCMenu";
 		ReqUI& m_reqUI;
 
 		void DrawDisplay();
 		void DrawContextMenu();
+		void DrawRasterOverlay(const ImVec2& _borderMin, const ImVec2& _borderMax);
 		void CreateTexture(const bool _vsync);
 		void UpdateData(const bool _isRunning);
 		bool Init();
@@ -73,6 +75,7 @@ namespace dev
 			const float* const _dpiScaleP, GLUtils& _glUtils, ReqUI& _reqUI);
 		void Update(bool& _visible, const bool _isRunning);
 		bool IsFocused() const;
+		bool IsRasterOverlay() const { return m_rasterOverlay; }
 	};
 
 };
\ No newline at end of file
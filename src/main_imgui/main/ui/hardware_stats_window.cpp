@@ -230,22 +230,22 @@ void dev::HardwareStatsWindow::UpdateData(const bool _isRunning)
 {
 	if (_isRunning) return;
 
-	auto res = m_hardware.Request(Hardware::Req::GET_REGS);
-	const auto& data = *res;
+	auto snapshot = m_hardware.GetSnapshot();
 
-	uint64_t cc = data["cc"];
+	uint64_t cc = snapshot.cpuState.cc;
 	auto ccDiff = cc - m_ccLast;
 	m_ccLastRun = ccDiff == 0 ? m_ccLastRun : ccDiff;
 	m_ccLast = cc;
 	if (ccDiff == 0) return;
 
 	// Regs
-	CpuI8080::AF regAF{ data["af"] };
-	Addr regBC{ data["bc"] };
-	Addr regDE{ data["de"] };
-	Addr regHL{ data["hl"] };
-	Addr regSP{ data["sp"] };
-	Addr regPC{ data["pc"] };
+	const auto& regs = snapshot.cpuState.regs;
+	CpuI8080::AF regAF = regs.psw;
+	Addr regBC = regs.bc.word;
+	Addr regDE = regs.de.word;
+	Addr regHL = regs.hl.word;
+	Addr regSP = regs.sp.word;
+	Addr regPC = regs.pc.word;
 
 	// Flags
 
@@ -284,107 +284,64 @@ void dev::HardwareStatsWindow::UpdateData(const bool _isRunning)
 	m_regPCColor = pcUpdated ? &CLR_NUM_UPDATED : &DASM_CLR_NUMBER;
 	m_cpuState.regs.pc.word = regPC;
 
-	dev::CpuI8080::Int ints{ data["ints"] };
-	m_cpuState.ints = ints;
+	m_cpuState.ints = snapshot.cpuState.ints;
 
 	// Stack
-	Addr dataAddrN10 = m_hardware.Request(Hardware::Req::GET_WORD_STACK, { { "addr", regSP - 10 } })->at("data");
-	Addr dataAddrN8 = m_hardware.Request(Hardware::Req::GET_WORD_STACK, { { "addr", regSP - 8 } })->at("data");
-	Addr dataAddrN6 = m_hardware.Request(Hardware::Req::GET_WORD_STACK, { { "addr", regSP - 6 } })->at("data");
-	Addr dataAddrN4 = m_hardware.Request(Hardware::Req::GET_WORD_STACK, { { "addr", regSP - 4 } })->at("data");
-	Addr dataAddrN2 = m_hardware.Request(Hardware::Req::GET_WORD_STACK, { { "addr", regSP - 2 } })->at("data");
-	Addr dataAddr0 = m_hardware.Request(Hardware::Req::GET_WORD_STACK, { { "addr", regSP } })->at("data");
-	Addr dataAddrP2 = m_hardware.Request(Hardware::Req::GET_WORD_STACK, { { "addr", regSP + 2} })->at("data");
-	Addr dataAddrP4 = m_hardware.Request(Hardware::Req::GET_WORD_STACK, { { "addr", regSP + 4 } })->at("data");
-	Addr dataAddrP6 = m_hardware.Request(Hardware::Req::GET_WORD_STACK, { { "addr", regSP + 6 } })->at("data");
-	Addr dataAddrP8 = m_hardware.Request(Hardware::Req::GET_WORD_STACK, { { "addr", regSP + 8 } })->at("data");
-	Addr dataAddrP10 = m_hardware.Request(Hardware::Req::GET_WORD_STACK, { { "addr", regSP + 10 } })->at("data");
-
-	m_dataAddrN10S = std::format("{:04X}", dataAddrN10);
-	m_dataAddrN8S = std::format("{:04X}", dataAddrN8);
-	m_dataAddrN6S = std::format("{:04X}", dataAddrN6);
-	m_dataAddrN4S = std::format("{:04X}", dataAddrN4);
-	m_dataAddrN2S = std::format("{:04X}", dataAddrN2);
-	m_dataAddr0S = std::format("{:04X}", dataAddr0);
-	m_dataAddrP2S = std::format("{:04X}", dataAddrP2);
-	m_dataAddrP4S = std::format("{:04X}", dataAddrP4);
-	m_dataAddrP6S = std::format("{:04X}", dataAddrP6);
-	m_dataAddrP8S = std::format("{:04X}", dataAddrP8);
-	m_dataAddrP10S = std::format("{:04X}", dataAddrP10);
+	m_dataAddrN10S = std::format("{:04X}", snapshot.stack[0]);
+	m_dataAddrN8S = std::format("{:04X}", snapshot.stack[1]);
+	m_dataAddrN6S = std::format("{:04X}", snapshot.stack[2]);
+	m_dataAddrN4S = std::format("{:04X}", snapshot.stack[3]);
+	m_dataAddrN2S = std::format("{:04X}", snapshot.stack[4]);
+	m_dataAddr0S = std::format("{:04X}", snapshot.stack[5]);
+	m_dataAddrP2S = std::format("{:04X}", snapshot.stack[6]);
+	m_dataAddrP4S = std::format("{:04X}", snapshot.stack[7]);
+	m_dataAddrP6S = std::format("{:04X}", snapshot.stack[8]);
+	m_dataAddrP8S = std::format("{:04X}", snapshot.stack[9]);
+	m_dataAddrP10S = std::format("{:04X}", snapshot.stack[10]);
 
 	// Hardware
-	res = m_hardware.Request(Hardware::Req::GET_DISPLAY_DATA);
-	const auto& displayDataJ = *res;
-	int rasterPixel = displayDataJ["rasterPixel"];
-	int rasterLine = displayDataJ["rasterLine"];
-	int frameNum = displayDataJ["frameNum"];
-	res = m_hardware.Request(Hardware::Req::GET_MEMORY_MAPPING);
-	Memory::Mapping mapping { res->at("mapping") };
-	int ramdiskIdx = res->at("ramdiskIdx");
+	int rasterPixel = snapshot.rasterPixel;
+	int rasterLine = snapshot.rasterLine;
+	const auto& mapping = snapshot.mapping;
 
 	// update Ram-disk
 	m_mappingRamModeS = mapping.RamModeToStr();
 	m_mappingPageRamS = std::to_string(mapping.pageRam);
 	m_mappingModeStackS = dev::BoolToStrC(mapping.modeStack, 2);
 	m_mappingPageStackS = std::to_string(mapping.pageStack);
-	m_ramdiskIdxS = std::to_string(ramdiskIdx + 1);
+	m_ramdiskIdxS = std::to_string(snapshot.ramdiskIdx + 1);
 
 	// update hardware
 	m_ccLastRunS = std::to_string(m_ccLastRun);
 	m_crtS = std::format("{}/{}", rasterPixel, rasterLine);
 	m_frameCCS = std::to_string((rasterPixel + rasterLine * Display::FRAME_W) / 4);
-	m_frameNumS = std::to_string(frameNum);
+	m_frameNumS = std::to_string(snapshot.frameNum);
 
-	res = m_hardware.Request(Hardware::Req::GET_IO_PALETTE);
-	const auto& paletteDataJ = *res;
-	m_palette.low = paletteDataJ["low"];
-	m_palette.hi = paletteDataJ["hi"];
+	m_palette = snapshot.palette;
 
 	// ports IN data
-	res = m_hardware.Request(Hardware::Req::GET_IO_PORTS_IN_DATA);
-	const auto& portsDataInJ = *res;
-	IO::PortsData portdataIn;
-	portdataIn.data0 = portsDataInJ["data0"];
-	portdataIn.data1 = portsDataInJ["data1"];
-	portdataIn.data2 = portsDataInJ["data2"];
-	portdataIn.data3 = portsDataInJ["data3"];
-	portdataIn.data4 = portsDataInJ["data4"];
-	portdataIn.data5 = portsDataInJ["data5"];
-	portdataIn.data6 = portsDataInJ["data6"];
-	portdataIn.data7 = portsDataInJ["data7"];
 	// check if updated, set the colors
 	for (int i = 0; i < 256; i++) 
 	{
-		bool updated = portdataIn.data[i] != m_portsInData.data[i];
+		bool updated = snapshot.portsInData.data[i] != m_portsInData.data[i];
 		m_portsInDataColor[i] = updated ? &CLR_NUM_UPDATED : &DASM_CLR_NUMBER;
 	}
-	m_portsInData = portdataIn;
+	m_portsInData = snapshot.portsInData;
 	
 	// ports OUT data
-	res = m_hardware.Request(Hardware::Req::GET_IO_PORTS_OUT_DATA);
-	const auto& portsDataOutJ = *res;
-	IO::PortsData portdataOut;
-	portdataOut.data0 = portsDataOutJ["data0"];
-	portdataOut.data1 = portsDataOutJ["data1"];
-	portdataOut.data2 = portsDataOutJ["data2"];
-	portdataOut.data3 = portsDataOutJ["data3"];
-	portdataOut.data4 = portsDataOutJ["data4"];
-	portdataOut.data5 = portsDataOutJ["data5"];
-	portdataOut.data6 = portsDataOutJ["data6"];
-	portdataOut.data7 = portsDataOutJ["data7"];
 	// check if updated, set the colors
 	for (int i = 0; i < 256; i++)
 	{
-		bool updated = portdataOut.data[i] != m_portsOutData.data[i];
+		bool updated = snapshot.portsOutData.data[i] != m_portsOutData.data[i];
 		m_portsOutDataColor[i] = updated ? &CLR_NUM_UPDATED : &DASM_CLR_NUMBER;
 	}
-	m_portsOutData = portdataOut;
+	m_portsOutData = snapshot.portsOutData;
 
 	// Vertical scroll
-	m_scrollVert = m_hardware.Request(Hardware::Req::GET_SCROLL_VERT)->at("scrollVert");
+	m_scrollVert = snapshot.scrollVert;
 
 	// IO
-	m_displayModeS = m_hardware.Request(Hardware::Req::GET_IO_DISPLAY_MODE)->at("data") ? "512" : "256";
+	m_displayModeS = snapshot.displayMode ? "512" : "256";
 }
 
 void dev::HardwareStatsWindow::UpdateDataRuntime()
@@ -393,26 +350,25 @@ void dev::HardwareStatsWindow::UpdateDataRuntime()
 	if (delay++ < 10) return;
 	delay = 0;
 
+	auto snapshot = m_hardware.GetSnapshot();
+
 	// FDC
 	static const std::string diskNames[] = { "Drive A", "Drive B", "Drive C", "Drive D" };
-	auto fdcInfo = *m_hardware.Request(Hardware::Req::GET_FDC_INFO);
-	m_fdcDrive = diskNames[fdcInfo["drive"].get<int>()];
-	m_fdcSide = std::to_string(fdcInfo["side"].get<int>());
-	m_fdcTrack = std::to_string(fdcInfo["track"].get<int>());
-	m_fdcPosition = std::to_string(fdcInfo["position"].get<int>());
-	m_fdcRwLen = std::to_string(fdcInfo["rwLen"].get<int>());
+	const auto& fdcInfo = snapshot.fdcInfo;
+	m_fdcDrive = diskNames[fdcInfo.drive];
+	m_fdcSide = std::to_string(fdcInfo.side);
+	m_fdcTrack = std::to_string(fdcInfo.track);
+	m_fdcPosition = std::to_string(fdcInfo.position);
+	m_fdcRwLen = std::to_string(fdcInfo.rwLen);
 	m_fdcStats = std::format("Side {}\nTrack {}\nPosition {}\n R/W Len {}",
 		m_fdcSide, m_fdcTrack, m_fdcPosition, m_fdcRwLen);
 
 	for (int driveIdx = 0; driveIdx < Fdc1793::DRIVES_MAX; driveIdx++)
 	{
-		auto fddInfo = *m_hardware.Request(
-			Hardware::Req::GET_FDD_INFO, { {"driveIdx", driveIdx} });
-		size_t reads = fddInfo["reads"];
-		size_t writes = fddInfo["writes"];
-		m_fddPaths[driveIdx] = fddInfo["path"];
+		const auto& fddInfo = snapshot.fddInfo[driveIdx];
+		m_fddPaths[driveIdx] = fddInfo.path;
 
-		m_fddStats[driveIdx] = fddInfo["mounted"] ? std::format("RW: {}/{}", reads, writes) : "dismounted";
+		m_fddStats[driveIdx] = fddInfo.mounted ? std::format("RW: {}/{}", fddInfo.reads, fddInfo.writes) : "dismounted";
 	}
 
 	// ruslat
@@ -480,7 +436,7 @@ void dev::HardwareStatsWindow::Init()
 void dev::HardwareStatsWindow::UpdateUpTime()
 {
 	// update the up time
-	uint64_t cc = m_hardware.Request(Hardware::Req::GET_CC)->at("cc");
+	uint64_t cc = m_hardware.GetSnapshot().cpuState.cc;
 	m_ccS = std::to_string(cc);
 	int sec = (int)(cc / CpuI8080::CLOCK);
 	int hours = sec / 3600;
@@ -28,15 +28,14 @@ void dev::HexViewerWindow::UpdateData(const bool _isRunning)
 	if (_isRunning) return;
 
 	// check if the hardware updated its state
-	uint64_t cc = m_hardware.Request(Hardware::Req::GET_CC)->at("cc");
+	uint64_t cc = m_hardware.GetSnapshot().cpuState.cc;
 	auto ccDiff = cc - m_ccLast;
 	if (ccDiff == 0) return;
 	m_ccLast = cc;
 
 	// update
-	auto memP = m_hardware.GetRam()->data();
 	auto pageOffset = m_memPageIdx * Memory::MEM_64K;
-	std::copy(memP + pageOffset, memP + pageOffset + Memory::MEMORY_MAIN_LEN, m_ram.begin());
+	m_hardware.RequestMemRangeGlobal(m_ram.data(), pageOffset, Memory::MEMORY_MAIN_LEN);
 	m_debugger.UpdateLastRW();
 }
 
@@ -88,9 +87,8 @@ void dev::HexViewerWindow::DrawHex(const bool _isRunning)
 	if (ImGui::SliderInt("##pageSelection", &m_memPageIdx, 0, static_cast<int>(Element::COUNT) - 1, elem_name, ImGuiSliderFlags_NoInput))
 	{
 		// update
-		auto memP = m_hardware.GetRam()->data();
 		auto pageOffset = m_memPageIdx * Memory::MEM_64K;
-		std::copy(memP + pageOffset, memP + pageOffset + Memory::MEMORY_MAIN_LEN, m_ram.begin());
+		m_hardware.RequestMemRangeGlobal(m_ram.data(), pageOffset, Memory::MEMORY_MAIN_LEN);
 	}
 
 	// select the highlight mode (RW/R/W)
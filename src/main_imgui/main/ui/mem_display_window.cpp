@@ -287,7 +287,7 @@ void dev::MemDisplayWindow::DrawDisplay()
 		{
 			ImGui::BeginTooltip();
 			GlobalAddr globalAddr = PixelPosToAddr(imgPixelPos, m_scale) + imageHoveredId * Memory::MEM_64K;
-			uint8_t val = m_hardware.Request(Hardware::Req::GET_BYTE_GLOBAL, { { "globalAddr", globalAddr } })->at("data");
+			uint8_t val = m_hardware.RequestByteGlobal(globalAddr);
 			ImGui::Text("0x%06X (0x%02X), %s", globalAddr, val, separatorsS[imageHoveredId]);
 			ImGui::EndTooltip();
 		}
@@ -300,7 +300,7 @@ void dev::MemDisplayWindow::DrawDisplay()
 void dev::MemDisplayWindow::UpdateData(const bool _isRunning)
 {
 	// check if the hardware updated its state
-	uint64_t cc = m_hardware.Request(Hardware::Req::GET_CC)->at("cc");
+	uint64_t cc = m_hardware.GetSnapshot().cpuState.cc;
 	auto ccDiff = cc - m_ccLast;
 	//if (ccDiff == 0) return;
 	m_ccLast = cc;
@@ -321,12 +321,34 @@ void dev::MemDisplayWindow::UpdateData(const bool _isRunning)
 		m_glUtils.UpdateMaterialParam(m_memViewMatIds[0], m_paramId_highlightIdxMax, m_highlightIdxMax);
 
 		// update vram texture
+		auto& lastRWRows = m_debugger.GetLastRWRows();
 		for (int i = 0; i < RAM_TEXTURES; i++)
 		{
 			m_glUtils.UpdateTexture(m_memViewTexIds[i], memP + i * Memory::MEM_64K);
-			m_glUtils.UpdateTexture(m_lastRWTexIds[i], (const uint8_t*)(memLastRWP) + i * Memory::MEM_64K * 4);
+
+			// upload only the rows the recent reads and writes changed
+			auto lastRWTexP = (const uint8_t*)(memLastRWP) + i * Memory::MEM_64K * 4;
+			if (m_lastRWUploadAll)
+			{
+				m_glUtils.UpdateTexture(m_lastRWTexIds[i], lastRWTexP);
+			}
+			else
+			{
+				int rowOffset = i * RAM_TEXTURE_H;
+				for (int row = 0; row < RAM_TEXTURE_H;)
+				{
+					if (!lastRWRows.test(rowOffset + row)) { row++; continue; }
+
+					int rowEnd = row + 1;
+					while (rowEnd < RAM_TEXTURE_H && lastRWRows.test(rowOffset + rowEnd)) rowEnd++;
+					m_glUtils.UpdateTextureRows(m_lastRWTexIds[i], lastRWTexP, row, rowEnd - row);
+					row = rowEnd;
+				}
+			}
 			m_glUtils.Draw(m_memViewMatIds[i]);
 		}
+		m_debugger.ClearLastRWRows();
+		m_lastRWUploadAll = false;
 	}
 }
 
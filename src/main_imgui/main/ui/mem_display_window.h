@@ -27,6 +27,7 @@ namespace dev
 		static constexpr int RAM_TEXTURES = Memory::MEMORY_GLOBAL_LEN / Memory::MEM_64K;
 		static constexpr int RAM_TEXTURE_W = 256;
 		static constexpr int RAM_TEXTURE_H = Memory::MEMORY_MAIN_LEN / 256;
+		static_assert(RAM_TEXTURE_W == 1 << Debugger::LAST_RW_ROW_BITS, "a texture row has to match a last rw row");
 
 		Hardware& m_hardware;
 		Debugger& m_debugger;
@@ -52,7 +53,7 @@ namespace dev
 		std::array<dev::Id, RAM_TEXTURES> m_memViewMatIds;
 		std::array<dev::Id, RAM_TEXTURES> m_memViewTexIds;
 		std::array<dev::Id, RAM_TEXTURES> m_lastRWTexIds;
-		Debugger::MemLastRW* m_lastRWIdxsP;
+		bool m_lastRWUploadAll = true; // the textures get the storage on the first upload
 		bool m_isGLInited = false;
 
 		void DrawDisplay();
@@ -0,0 +1,479 @@
+#include "ui/profiler_window.h"
+
+#include <format>
+#include <algorithm>
+#include "libtinyfiledialogs/tinyfiledialogs.h"
+#include "utils/utils.h"
+#include "utils/str_utils.h"
+
+dev::ProfilerWindow::ProfilerWindow(Hardware& _hardware, Debugger& _debugger,
+	const float* const _dpiScaleP, ReqUI& _reqUI)
+	:
+	BaseWindow("Profiler", DEFAULT_WINDOW_W, DEFAULT_WINDOW_H, _dpiScaleP),
+	m_hardware(_hardware), m_debugger(_debugger),
+	m_reqUI(_reqUI)
+{}
+
+void dev::ProfilerWindow::Update(bool& _visible, const bool _isRunning)
+{
+	BaseWindow::Update();
+
+	if (_visible && ImGui::Begin(m_name.c_str(), &_visible, ImGuiWindowFlags_NoCollapse))
+	{
+		UpdateData(_isRunning);
+		Draw(_isRunning);
+
+		ImGui::End();
+	}
+}
+
+void dev::ProfilerWindow::Draw(const bool _isRunning)
+{
+	ImGui::Text("Cycles: %llu, frames: %.1f, %d cycles per frame",
+		(unsigned long long)m_totalCC, double(m_totalCC) / FRAME_CC, int(FRAME_CC));
+
+	if (ImGui::Button("Reset"))
+	{
+		m_hardware.Request(Hardware::Req::DEBUG_PROFILER_RESET);
+		m_ccLast = -1;
+	}
+	ImGui::SameLine();
+	if (ImGui::Button("Export Flame Graph"))
+	{
+		ExportFlameGraph();
+	}
+	ImGui::SameLine();
+	dev::DrawHelpMarker("The cycles are attributed to the function executed. A function starts\n"
+						"with CALL, RST, or the interrupt, and ends with RET.\n"
+						"Inclusive - the cycles of the function and its callees\n"
+						"Exclusive - the cycles of the function itself\n\n"
+						"Double-click a function or a hot spot to locate it in the disasm\n"
+						"The flame graph export is the collapsed stack format of the flame graph tools");
+
+	if (ImGui::BeginTabBar("##ProfilerTabs"))
+	{
+		if (ImGui::BeginTabItem("Functions"))
+		{
+			DrawFuncs();
+			ImGui::EndTabItem();
+		}
+		if (ImGui::BeginTabItem("Hot Spots"))
+		{
+			DrawHotSpots();
+			ImGui::EndTabItem();
+		}
+		if (ImGui::BeginTabItem("Raster"))
+		{
+			DrawRaster();
+			ImGui::EndTabItem();
+		}
+		ImGui::EndTabBar();
+	}
+}
+
+void dev::ProfilerWindow::DrawFuncs()
+{
+	const int COLUMNS_COUNT = 6;
+	static ImGuiTableFlags flags =
+		ImGuiTableFlags_ScrollY | ImGuiTableFlags_RowBg |
+		ImGuiTableFlags_Resizable | ImGuiTableFlags_BordersOuter;
+
+	if (ImGui::BeginTable("##ProfilerFuncs", COLUMNS_COUNT, flags))
+	{
+		ImGui::TableSetupScrollFreeze(0, 1);
+		ImGui::TableSetupColumn("Function", ImGuiTableColumnFlags_WidthStretch);
+		ImGui::TableSetupColumn("Calls", ImGuiTableColumnFlags_WidthFixed, 70);
+		ImGui::TableSetupColumn("Inclusive", ImGuiTableColumnFlags_WidthFixed, 90);
+		ImGui::TableSetupColumn("%", ImGuiTableColumnFlags_WidthFixed, 45);
+		ImGui::TableSetupColumn("Exclusive", ImGuiTableColumnFlags_WidthFixed, 90);
+		ImGui::TableSetupColumn("% ", ImGuiTableColumnFlags_WidthFixed, 45);
+		ImGui::TableHeadersRow();
+
+		double totalCC = m_totalCC ? double(m_totalCC) : 1.0;
+
+		ImGuiListClipper clipper;
+		clipper.Begin(int(m_funcs.size()));
+		while (clipper.Step())
+		{
+			for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++)
+			{
+				const auto& func = m_funcs[i];
+				ImGui::TableNextRow();
+
+				ImGui::TableNextColumn();
+				ImGui::Selectable(std::format("{}##ProfilerFunc{}", func.name, i).c_str(), false,
+					ImGuiSelectableFlags_SpanAllColumns | ImGuiSelectableFlags_AllowDoubleClick);
+				if (func.func != Profiler::FUNC_ROOT &&
+					ImGui::IsItemHovered() && ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left))
+				{
+					m_reqUI.type = ReqUI::Type::DISASM_NAVIGATE_TO_ADDR;
+					m_reqUI.globalAddr = func.func;
+				}
+
+				ImGui::TableNextColumn();
+				ImGui::Text("%llu", (unsigned long long)func.calls);
+				ImGui::TableNextColumn();
+				ImGui::Text("%llu", (unsigned long long)func.inclusiveCC);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.1f", 100.0 * func.inclusiveCC / totalCC);
+				ImGui::TableNextColumn();
+				ImGui::Text("%llu", (unsigned long long)func.exclusiveCC);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.1f", 100.0 * func.exclusiveCC / totalCC);
+			}
+		}
+		ImGui::EndTable();
+	}
+}
+
+void dev::ProfilerWindow::DrawHotSpots()
+{
+	const int COLUMNS_COUNT = 3;
+	static ImGuiTableFlags flags =
+		ImGuiTableFlags_ScrollY | ImGuiTableFlags_RowBg |
+		ImGuiTableFlags_Resizable | ImGuiTableFlags_BordersOuter;
+
+	if (ImGui::BeginTable("##ProfilerHotSpots", COLUMNS_COUNT, flags))
+	{
+		ImGui::TableSetupScrollFreeze(0, 1);
+		ImGui::TableSetupColumn("Global Addr", ImGuiTableColumnFlags_WidthStretch);
+		ImGui::TableSetupColumn("Cycles", ImGuiTableColumnFlags_WidthFixed, 90);
+		ImGui::TableSetupColumn("%", ImGuiTableColumnFlags_WidthFixed, 45);
+		ImGui::TableHeadersRow();
+
+		double totalCC = m_totalCC ? double(m_totalCC) : 1.0;
+
+		for (int i = 0; i < m_hotSpots.size(); i++)
+		{
+			const auto& hotSpot = m_hotSpots[i];
+			ImGui::TableNextRow();
+
+			ImGui::TableNextColumn();
+			ImGui::Selectable(std::format("0x{:05X}##ProfilerHotSpot{}", hotSpot.globalAddr, i).c_str(), false,
+				ImGuiSelectableFlags_SpanAllColumns | ImGuiSelectableFlags_AllowDoubleClick);
+			// the disasm shows the main ram
+			if (hotSpot.globalAddr < Memory::MEM_64K &&
+				ImGui::IsItemHovered() && ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left))
+			{
+				m_reqUI.type = ReqUI::Type::DISASM_NAVIGATE_TO_ADDR;
+				m_reqUI.globalAddr = hotSpot.globalAddr;
+			}
+
+			ImGui::TableNextColumn();
+			ImGui::Text("%llu", (unsigned long long)hotSpot.cc);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.1f", 100.0 * hotSpot.cc / totalCC);
+		}
+		ImGui::EndTable();
+	}
+}
+
+void dev::ProfilerWindow::DrawRaster()
+{
+	DrawRegions();
+	DrawTimeline();
+	DrawRasterSpans();
+}
+
+void dev::ProfilerWindow::DrawRegions()
+{
+	dev::DrawSeparator2("Regions");
+
+	const int COLUMNS_COUNT = 4;
+	static ImGuiTableFlags flags = ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersOuter;
+
+	if (ImGui::BeginTable("##ProfilerRegions", COLUMNS_COUNT, flags))
+	{
+		ImGui::TableSetupColumn("Name", ImGuiTableColumnFlags_WidthStretch);
+		ImGui::TableSetupColumn("Type", ImGuiTableColumnFlags_WidthFixed, 70);
+		ImGui::TableSetupColumn("Addr", ImGuiTableColumnFlags_WidthFixed, 110);
+		ImGui::TableSetupColumn("##Del", ImGuiTableColumnFlags_WidthFixed, 50);
+		ImGui::TableHeadersRow();
+
+		const char* typesS[] = { "Interrupt", "Function", "Range" };
+		float sz = ImGui::GetTextLineHeight();
+		int delIdx = -1;
+
+		for (int i = 0; i < m_regions.size(); i++)
+		{
+			const auto& region = m_regions[i];
+			ImGui::TableNextRow();
+
+			ImGui::TableNextColumn();
+			ImVec2 pos = ImGui::GetCursorScreenPos();
+			ImGui::GetWindowDrawList()->AddRectFilled(pos, ImVec2(pos.x + sz, pos.y + sz), GetRegionColor(i));
+			ImGui::Dummy(ImVec2(sz, sz));
+			ImGui::SameLine();
+			ImGui::TextUnformatted(region.name.c_str());
+
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(typesS[static_cast<int>(region.type)]);
+
+			ImGui::TableNextColumn();
+			if (region.type == Profiler::RegionType::RANGE) ImGui::Text("0x%04X-0x%04X", region.addr, region.addrEnd);
+			else if (region.type == Profiler::RegionType::FUNC) ImGui::Text("0x%04X", region.addr);
+
+			ImGui::TableNextColumn();
+			if (i != Profiler::REGION_IRQ &&
+				ImGui::SmallButton(std::format("Del##ProfilerRegionDel{}", i).c_str()))
+			{
+				delIdx = i;
+			}
+		}
+		ImGui::EndTable();
+
+		if (delIdx >= 0)
+		{
+			m_hardware.Request(Hardware::Req::DEBUG_PROFILER_DEL_REGION, { {"idx", delIdx} });
+			m_ccLast = -1;
+		}
+	}
+
+	ImGui::PushItemWidth(90);
+	ImGui::Combo("##ProfilerRegionType", &m_regionType, " Function\0 Range\0\0");
+	ImGui::SameLine();
+	ImGui::InputTextWithHint("##ProfilerRegionAddr", "addr or label", m_regionAddrS, IM_ARRAYSIZE(m_regionAddrS));
+	if (m_regionType == 1)
+	{
+		ImGui::SameLine();
+		ImGui::InputTextWithHint("##ProfilerRegionAddrEnd", "end addr", m_regionAddrEndS, IM_ARRAYSIZE(m_regionAddrEndS));
+	}
+	ImGui::SameLine();
+	ImGui::InputTextWithHint("##ProfilerRegionName", "name", m_regionNameS, IM_ARRAYSIZE(m_regionNameS));
+	ImGui::PopItemWidth();
+	ImGui::SameLine();
+	ImGui::ColorEdit4("##ProfilerRegionColor", m_regionColor, ImGuiColorEditFlags_NoInputs);
+	ImGui::SameLine();
+	if (ImGui::Button("Add")) AddRegion();
+	ImGui::SameLine();
+	dev::DrawHelpMarker("A function region spans from the call of the function to its return,\n"
+						"a range region spans while the pc is in the range including its end.\n"
+						"The addresses are hexadecimal or labels.\n"
+						"The interrupt region is the interrupt handler. It is always present.\n\n"
+						"The timeline shows the last frames left to right, the raster lines top to bottom.\n"
+						"A red frame is an overrun: the main loop didn't reach HLT before the next interrupt.\n"
+						"The display window draws the regions of the last frame over the image\n"
+						"if the Raster Profiler Overlay is checked in its context menu");
+}
+
+void dev::ProfilerWindow::AddRegion()
+{
+	int addr = ParseAddr(m_regionAddrS);
+	int addrEnd = m_regionType == 1 ? ParseAddr(m_regionAddrEndS) : addr;
+	if (addr < 0 || addrEnd < addr)
+	{
+		dev::Log("Profiler: invalid region address: {} {}", m_regionAddrS, m_regionAddrEndS);
+		return;
+	}
+
+	auto ColorByte = [](const float _val) { return uint32_t(std::clamp(_val, 0.0f, 1.0f) * 255.0f + 0.5f); };
+	uint32_t color = ColorByte(m_regionColor[0]) << 24 | ColorByte(m_regionColor[1]) << 16 |
+		ColorByte(m_regionColor[2]) << 8 | ColorByte(m_regionColor[3]);
+	std::string name = m_regionNameS[0] ? m_regionNameS : m_regionAddrS;
+	auto type = m_regionType == 1 ? Profiler::RegionType::RANGE : Profiler::RegionType::FUNC;
+
+	auto result = m_hardware.Request(Hardware::Req::DEBUG_PROFILER_ADD_REGION, {
+		{"type", type}, {"addr", addr}, {"addrEnd", addrEnd}, {"color", color}, {"name", name} });
+	if (!result || !result->at("result")) {
+		dev::Log("Profiler: can't add more than {} regions", Profiler::REGIONS_MAX);
+	}
+	m_ccLast = -1;
+}
+
+auto dev::ProfilerWindow::ParseAddr(const char* _addrS) const
+-> int
+{
+	DebugData::FilteredElements labels;
+	m_debugger.GetDebugData().GetFilteredLabels(labels, _addrS);
+	for (const auto& [name, globalAddr, addrS] : labels)
+	{
+		if (name == _addrS) return globalAddr;
+	}
+
+	char* end;
+	long addr = strtol(_addrS, &end, 16);
+	if (end == _addrS || *end != '\0' || addr < 0 || addr > 0xFFFF) return -1;
+	return static_cast<int>(addr);
+}
+
+auto dev::ProfilerWindow::GetRegionColor(const size_t _region) const
+-> ImU32
+{
+	if (_region >= m_regions.size()) return IM_COL32(128, 128, 128, 128);
+	uint32_t color = m_regions[_region].color;
+	return IM_COL32(color >> 24, (color >> 16) & 0xFF, (color >> 8) & 0xFF, color & 0xFF);
+}
+
+// the frames left to right, the raster lines top to bottom
+void dev::ProfilerWindow::DrawTimeline()
+{
+	dev::DrawSeparator2("Timeline");
+
+	float w = ImGui::GetContentRegionAvail().x;
+	float h = TIMELINE_H * (*m_dpiScaleP);
+	ImVec2 pos = ImGui::GetCursorScreenPos();
+	auto drawList = ImGui::GetWindowDrawList();
+	drawList->AddRectFilled(pos, ImVec2(pos.x + w, pos.y + h), IM_COL32(30, 30, 30, 255));
+
+	float frameW = w / Profiler::RASTER_FRAMES_MAX;
+	float lineH = h / Display::FRAME_H;
+	// the latest frame is on the right
+	float x0 = pos.x + (Profiler::RASTER_FRAMES_MAX - m_rasterFrames.size()) * frameW;
+
+	for (int i = 0; i < m_rasterFrames.size(); i++)
+	{
+		const auto& frame = m_rasterFrames[i];
+		float x = x0 + i * frameW;
+
+		for (const auto& span : frame.spans)
+		{
+			float y0 = pos.y + (span.start / Display::FRAME_W) * lineH;
+			float y1 = pos.y + std::min(span.end / Display::FRAME_W + 1, uint32_t(Display::FRAME_H)) * lineH;
+			drawList->AddRectFilled(ImVec2(x, y0), ImVec2(x + frameW - 1, y1), GetRegionColor(span.region));
+		}
+		if (frame.overrun)
+		{
+			drawList->AddRect(ImVec2(x, pos.y), ImVec2(x + frameW - 1, pos.y + h), IM_COL32(255, 40, 40, 255));
+		}
+	}
+
+	ImGui::InvisibleButton("##ProfilerTimeline", ImVec2(w, h));
+	if (ImGui::IsItemHovered() && !m_rasterFrames.empty())
+	{
+		int i = int((ImGui::GetMousePos().x - x0) / frameW);
+		if (i >= 0 && i < m_rasterFrames.size())
+		{
+			const auto& frame = m_rasterFrames[i];
+			uint64_t irqCC = 0;
+			for (const auto& span : frame.spans) {
+				if (span.region == Profiler::REGION_IRQ) irqCC += span.cc;
+			}
+			ImGui::BeginTooltip();
+			ImGui::Text("Frame: %llu%s", (unsigned long long)frame.frameNum, frame.overrun ? ", overrun" : "");
+			ImGui::Text("Interrupt: %llu cycles, %.1f%%", (unsigned long long)irqCC, 100.0 * irqCC / FRAME_CC);
+			ImGui::EndTooltip();
+		}
+	}
+}
+
+// the spans of the last frame
+void dev::ProfilerWindow::DrawRasterSpans()
+{
+	if (m_rasterFrames.empty()) return;
+	const auto& frame = m_rasterFrames.back();
+	dev::DrawSeparator2(std::format("Frame {}{}", frame.frameNum, frame.overrun ? ", overrun" : "").c_str());
+
+	const int COLUMNS_COUNT = 5;
+	static ImGuiTableFlags flags =
+		ImGuiTableFlags_ScrollY | ImGuiTableFlags_RowBg |
+		ImGuiTableFlags_Resizable | ImGuiTableFlags_BordersOuter;
+
+	if (ImGui::BeginTable("##ProfilerSpans", COLUMNS_COUNT, flags))
+	{
+		ImGui::TableSetupScrollFreeze(0, 1);
+		ImGui::TableSetupColumn("Region", ImGuiTableColumnFlags_WidthStretch);
+		ImGui::TableSetupColumn("Start", ImGuiTableColumnFlags_WidthFixed, 70);
+		ImGui::TableSetupColumn("End", ImGuiTableColumnFlags_WidthFixed, 70);
+		ImGui::TableSetupColumn("Cycles", ImGuiTableColumnFlags_WidthFixed, 70);
+		ImGui::TableSetupColumn("%", ImGuiTableColumnFlags_WidthFixed, 45);
+		ImGui::TableHeadersRow();
+
+		for (const auto& span : frame.spans)
+		{
+			ImGui::TableNextRow();
+
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(span.region < m_regions.size() ? m_regions[span.region].name.c_str() : "");
+			// line:pixel
+			ImGui::TableNextColumn();
+			ImGui::Text("%d:%d", span.start / Display::FRAME_W, span.start % Display::FRAME_W);
+			ImGui::TableNextColumn();
+			ImGui::Text("%d:%d", span.end / Display::FRAME_W, span.end % Display::FRAME_W);
+			ImGui::TableNextColumn();
+			ImGui::Text("%llu", (unsigned long long)span.cc);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.1f", 100.0 * span.cc / FRAME_CC);
+		}
+		ImGui::EndTable();
+	}
+}
+
+void dev::ProfilerWindow::ExportFlameGraph()
+{
+	const char* filters[] = { "*.txt", "*.folded" };
+	const char* filename = tinyfd_saveFileDialog(
+		"Export Flame Graph", "profile.folded", sizeof(filters) / sizeof(const char*), filters, nullptr);
+	if (!filename) return;
+
+	auto result = m_hardware.Request(Hardware::Req::DEBUG_PROFILER_GET_STACKS);
+	if (!result) return;
+
+	std::vector<Profiler::Stack> stacks;
+	for (const auto& stackJ : result->at("stacks"))
+	{
+		stacks.push_back({ stackJ["funcs"].get<std::vector<uint32_t>>(), stackJ["cc"] });
+	}
+
+	auto text = Profiler::GetCollapsedStacks(m_debugger.GetDebugData(), stacks);
+	if (!dev::SaveFile(filename, std::vector<uint8_t>(text.begin(), text.end()), true)) {
+		dev::Log("Failed to export the flame graph: {}", filename);
+	}
+}
+
+void dev::ProfilerWindow::UpdateData(const bool _isRunning)
+{
+	// check if the hardware updated its state
+	uint64_t cc = m_hardware.GetSnapshot().cpuState.cc;
+	auto ccDiff = cc - m_ccLast;
+	if (ccDiff == 0) return;
+
+	// the stats take a while to collect, so they are refreshed periodically while running
+	double time = ImGui::GetTime();
+	if (_isRunning && m_ccLast >= 0 && time - m_updateTime < UPDATE_DELAY) return;
+	m_updateTime = time;
+	m_ccLast = cc;
+
+	// update
+	auto result = m_hardware.Request(Hardware::Req::DEBUG_PROFILER_GET, { {"hotSpots", HOT_SPOTS_MAX} });
+	if (!result) return;
+	auto& statsJ = *result;
+
+	m_totalCC = statsJ["totalCC"];
+
+	const auto& debugData = m_debugger.GetDebugData();
+	m_funcs.clear();
+	for (const auto& funcJ : statsJ["funcs"])
+	{
+		uint32_t func = funcJ["func"];
+		m_funcs.push_back({ func, Profiler::GetFuncName(debugData, func),
+			funcJ["calls"], funcJ["inclusiveCC"], funcJ["exclusiveCC"] });
+	}
+
+	m_hotSpots.clear();
+	for (const auto& hotSpotJ : statsJ["hotSpots"])
+	{
+		m_hotSpots.push_back({ hotSpotJ["globalAddr"], hotSpotJ["cc"] });
+	}
+
+	auto rasterResult = m_hardware.Request(Hardware::Req::DEBUG_PROFILER_GET_RASTER,
+		{ {"frames", Profiler::RASTER_FRAMES_MAX} });
+	if (!rasterResult) return;
+
+	m_regions.clear();
+	for (const auto& regionJ : rasterResult->at("regions"))
+	{
+		m_regions.push_back({ regionJ["type"], regionJ["addr"], regionJ["addrEnd"],
+			regionJ["color"], regionJ["name"] });
+	}
+
+	m_rasterFrames.clear();
+	for (const auto& frameJ : rasterResult->at("frames"))
+	{
+		RasterFrame frame{ frameJ["frameNum"], frameJ["overrun"] };
+		for (const auto& spanJ : frameJ["spans"])
+		{
+			frame.spans.push_back({ spanJ[0], spanJ[1], spanJ[2], spanJ[3] });
+		}
+		m_rasterFrames.push_back(std::move(frame));
+	}
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "utils/imgui_utils.h"
+#include "ui/base_window.h"
+#include "core/hardware.h"
+#include "core/debugger.h"
+
+namespace dev
+{
+	class ProfilerWindow : public BaseWindow
+	{
+		static constexpr int DEFAULT_WINDOW_W = 600;
+		static constexpr int DEFAULT_WINDOW_H = 400;
+		static constexpr uint64_t FRAME_CC = 59904; // cpu cycles per frame
+		static constexpr int HOT_SPOTS_MAX = 32;
+		static constexpr double UPDATE_DELAY = 0.5; // sec. the stats are requested not more often while running
+		static constexpr int TIMELINE_H = 160;
+
+		struct Func
+		{
+			uint32_t func;
+			std::string name;
+			uint64_t calls;
+			uint64_t inclusiveCC;
+			uint64_t exclusiveCC;
+		};
+
+		struct HotSpot
+		{
+			GlobalAddr globalAddr;
+			uint64_t cc;
+		};
+
+		struct RasterFrame
+		{
+			uint64_t frameNum;
+			bool overrun;
+			std::vector<Profiler::Span> spans;
+		};
+
+		Hardware& m_hardware;
+		Debugger& m_debugger;
+		ReqUI& m_reqUI;
+
+		int64_t m_ccLast = -1; // to force the first stats update
+		double m_updateTime = 0;
+		uint64_t m_totalCC = 0;
+		std::vector<Func> m_funcs;
+		std::vector<HotSpot> m_hotSpots;
+		std::vector<Profiler::Region> m_regions;
+		std::vector<RasterFrame> m_rasterFrames;
+
+		// the region to add
+		int m_regionType = 0; // 0 - a function, 1 - a pc range
+		char m_regionAddrS[64] = "";
+		char m_regionAddrEndS[64] = "";
+		char m_regionNameS[64] = "";
+		float m_regionColor[4] = { 0.2f, 0.8f, 0.2f, 0.5f };
+
+		void UpdateData(const bool _isRunning);
+		void Draw(const bool _isRunning);
+		void DrawFuncs();
+		void DrawHotSpots();
+		void DrawRaster();
+		void DrawRegions();
+		void DrawTimeline();
+		void DrawRasterSpans();
+		void AddRegion();
+		// a hexadecimal addr or a label. Returns -1 if it is neither
+		auto ParseAddr(const char* _addrS) const -> int;
+		auto GetRegionColor(const size_t _region) const -> ImU32;
+		void ExportFlameGraph();
+
+	public:
+		ProfilerWindow(Hardware& _hardware, Debugger& _debugger,
+			const float* const _dpiScaleP, ReqUI& _reqUI);
+		void Update(bool& _visible, const bool _isRunning);
+	};
+};
@@ -29,6 +29,20 @@ void dev::RecorderWindow::Draw(const bool _isRunning)
 {
 
 	ImGui::Text("State current / recorded: %d / %d", m_stateCurrent, m_stateRecorded);
+	ImGui::Text("Memory used / budget: %.1f / %.1f MB, %zu bytes per frame", 
+		m_memUsed / (1024.0 * 1024.0), m_memBudget / (1024.0 * 1024.0), m_bytesPerFrame);
+
+	if (ImGui::Checkbox("Spill to disk", &m_spillEnabled))
+	{
+		m_hardware.Request(Hardware::Req::DEBUG_RECORDER_SET_SPILL, { {"enabled", m_spillEnabled} });
+		m_ccLast = -1; // the history can change
+	}
+	ImGui::SameLine();
+	ImGui::Text("%.1f MB", m_spillSize / (1024.0 * 1024.0));
+	ImGui::SameLine();
+	dev::DrawHelpMarker("The frames that don't fit the memory budget are moved to a temporary file\n"
+						"instead of being dropped, so the history covers hours of emulation.\n"
+						"Disabling it discards the moved frames");
 
 	ImGui::Separator();
 
@@ -56,17 +70,9 @@ void dev::RecorderWindow::Draw(const bool _isRunning)
 
 	// Frame slider
 	dev::PushStyleCompact(0.5f);
-	int stateCurrentOld = m_stateCurrent;
 	if (ImGui::SliderInt("##recTimeline", &m_stateCurrent, 1, m_stateRecorded, "%d", ImGuiSliderFlags_AlwaysClamp))
 	{
-		int diff = m_stateCurrent - stateCurrentOld;
-		if (diff < 0) {
-			m_hardware.Request(Hardware::Req::DEBUG_RECORDER_PLAY_REVERSE, { {"frames", abs(diff)} });
-		}
-		else {
-			m_hardware.Request(Hardware::Req::DEBUG_RECORDER_PLAY_FORWARD, { {"frames", abs(diff)} });
-		}
-
+		m_hardware.Request(Hardware::Req::DEBUG_RECORDER_SEEK_TO_FRAME, { {"frame", m_stateCurrent} });
 		m_stateCurrent = m_hardware.Request(Hardware::Req::DEBUG_RECORDER_GET_STATE_CURRENT)->at("states");
 	}
 
@@ -90,7 +96,7 @@ void dev::RecorderWindow::Draw(const bool _isRunning)
 void dev::RecorderWindow::UpdateData(const bool _isRunning)
 {
 	// check if the hardware updated its state
-	uint64_t cc = m_hardware.Request(Hardware::Req::GET_CC)->at("cc");
+	uint64_t cc = m_hardware.GetSnapshot().cpuState.cc;
 	auto ccDiff = cc - m_ccLast;
 	if (ccDiff == 0) return;
 	m_ccLast = cc;
@@ -98,4 +104,11 @@ void dev::RecorderWindow::UpdateData(const bool _isRunning)
 	// update
 	m_stateRecorded = m_hardware.Request(Hardware::Req::DEBUG_RECORDER_GET_STATE_RECORDED)->at("states");
 	m_stateCurrent = m_hardware.Request(Hardware::Req::DEBUG_RECORDER_GET_STATE_CURRENT)->at("states");
+
+	auto memStats = *m_hardware.Request(Hardware::Req::DEBUG_RECORDER_GET_MEM_STATS);
+	m_memUsed = memStats["memUsed"];
+	m_memBudget = memStats["memBudget"];
+	m_bytesPerFrame = memStats["bytesPerFrame"];
+	m_spillSize = memStats["spillSize"];
+	m_spillEnabled = memStats["spillEnabled"];
 }
\ No newline at end of file
@@ -18,6 +18,11 @@ namespace dev
 		int64_t m_ccLast = -1; // to force the first stats update
 		int m_stateRecorded = 0;
 		int m_stateCurrent = 0;
+		size_t m_memUsed = 0;
+		size_t m_memBudget = 0;
+		size_t m_bytesPerFrame = 0;
+		size_t m_spillSize = 0;
+		bool m_spillEnabled = false;
 
 		void UpdateData(const bool _isRunning);
 
@@ -55,11 +55,11 @@ void dev::SearchWindow::Draw(const bool _isRunning)
 		m_searchResults.clear();
 
 		if (m_searchEnabled){
-			const auto& memP = *m_hardware.GetRam();
+			UpdateMem();
 
 			for (int addr = m_searchStartAddr; addr <= m_searchEndAddr; addr++)
 			{
-				if (memP[addr] == m_searchVal)
+				if (m_mem[addr - m_searchStartAddr] == m_searchVal)
 				{
 					m_searchResults.push_back(addr);
 				}
@@ -71,7 +71,7 @@ void dev::SearchWindow::Draw(const bool _isRunning)
 
 	if (ImGui::Button("Update Search"))
 	{
-		const auto& memP = *m_hardware.GetRam();
+		UpdateMem();
 
 		auto m_searchResultsIt = m_searchResults.begin();
 
@@ -79,7 +79,7 @@ void dev::SearchWindow::Draw(const bool _isRunning)
 		{
 			auto addr = *m_searchResultsIt;
 
-			if (memP[addr] != m_searchVal)
+			if (m_mem[addr - m_searchStartAddr] != m_searchVal)
 			{
 				m_searchResultsIt = m_searchResults.erase(m_searchResultsIt);
 			}
@@ -120,10 +120,17 @@ void dev::SearchWindow::Draw(const bool _isRunning)
 void dev::SearchWindow::UpdateData(const bool _isRunning)
 {
 	// check if the hardware updated its state
-	uint64_t cc = m_hardware.Request(Hardware::Req::GET_CC)->at("cc");
+	uint64_t cc = m_hardware.GetSnapshot().cpuState.cc;
 	auto ccDiff = cc - m_ccLast;
 	if (ccDiff == 0) return;
 	m_ccLast = cc;
 
 	// update
-}
\ No newline at end of file
+}
+
+// copies the search range in one request
+void dev::SearchWindow::UpdateMem()
+{
+	m_mem.resize(dev::Max(0, m_searchEndAddr - m_searchStartAddr + 1));
+	m_hardware.RequestMemRangeGlobal(m_mem.data(), m_searchStartAddr, m_mem.size());
+}
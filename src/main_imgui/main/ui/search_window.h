@@ -23,8 +23,10 @@ namespace dev
 		int m_searchVal = 0x0;
 
 		std::vector<GlobalAddr> m_searchResults;
+		std::vector<uint8_t> m_mem; // a copy of the search range
 
 		void UpdateData(const bool _isRunning);
+		void UpdateMem();
 
 	public:
 		SearchWindow(Hardware& _hardware, Debugger& _debugger, 
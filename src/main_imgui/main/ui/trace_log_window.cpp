@@ -1,5 +1,12 @@
 #include "ui/trace_log_window.h"
 
+#include <format>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include "libtinyfiledialogs/tinyfiledialogs.h"
+#include "utils/str_utils.h"
+
 dev::TraceLogWindow::TraceLogWindow(Hardware& _hardware, Debugger& _debugger,
 		const float* const _dpiScaleP, 
 		ReqUI& _reqUI)
@@ -23,6 +30,8 @@ void dev::TraceLogWindow::Update(bool& _visible, const bool _isRunning)
 	if (_visible && ImGui::Begin(m_name.c_str(), &_visible, ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_HorizontalScrollbar))
 	{
 		UpdateData(_isRunning);
+		DrawCapture(_isRunning);
+		DrawBranches(_isRunning);
 		DrawLog(_isRunning);
 
 		ImGui::End();
@@ -31,16 +40,33 @@ void dev::TraceLogWindow::Update(bool& _visible, const bool _isRunning)
 
 void dev::TraceLogWindow::UpdateData(const bool _isRunning)
 {
+	auto statsJ = m_hardware.Request(Hardware::Req::DEBUG_TRACE_CAPTURE_GET_STATS);
+	if (statsJ)
+	{
+		m_captureStats = { statsJ->at("capturing"), statsJ->at("records"), statsJ->at("blocks"),
+			statsJ->at("bytes"), statsJ->at("rawBytes") };
+		m_capturePath = statsJ->at("path");
+	}
+	m_debugger.GetTraceCapture().GetFound(m_captureRecords);
+
 	if (_isRunning) return;
 
 	// check if the hardware updated its state
-	uint64_t cc = m_hardware.Request(Hardware::Req::GET_CC)->at("cc");
+	uint64_t cc = m_hardware.GetSnapshot().cpuState.cc;
 	auto ccDiff = cc - m_ccLast;
 	if (ccDiff == 0) return;
 	m_ccLast = cc;
 
 	m_traceLogP = m_debugger.GetTraceLog().GetDisasm(TraceLog::TRACE_LOG_SIZE, m_disasmFilter);
 	m_disasmLinesLen = m_debugger.GetTraceLog().GetDisasmLen();
+
+	auto branchesJ = m_hardware.Request(Hardware::Req::GET_BRANCHES);
+	if (!branchesJ) return;
+	m_branches.clear();
+	for (const auto& b : branchesJ->at("branches"))
+	{
+		m_branches.push_back({ b[0], b[1], b[2], b[3], b[4], b[5] });
+	}
 }
 
 void dev::TraceLogWindow::DrawDisasmAddr(const bool _isRunning, const Disasm::Line& _line,
@@ -89,6 +115,218 @@ void dev::TraceLogWindow::DrawDisasmCode(const bool _isRunning, const Disasm::Li
 	//}
 }
 
+void dev::TraceLogWindow::DrawCapture(const bool _isRunning)
+{
+	if (!ImGui::CollapsingHeader("Capture")) return;
+
+	if (!m_captureStats.capturing)
+	{
+		if (ImGui::Button("Start Capture"))
+		{
+			const char* filters[] = { "*.dvtc" };
+			const char* filename = tinyfd_saveFileDialog(
+				"Capture Trace", "trace.dvtc", sizeof(filters) / sizeof(const char*), filters, nullptr);
+			if (filename) {
+				m_hardware.Request(Hardware::Req::DEBUG_TRACE_CAPTURE_START, { {"path", filename} });
+				m_captureRecords.clear();
+			}
+		}
+		ImGui::SameLine();
+		if (ImGui::Button("Open Capture"))
+		{
+			const char* filters[] = { "*.dvtc" };
+			const char* filename = tinyfd_openFileDialog(
+				"Open Trace Capture", "", sizeof(filters) / sizeof(const char*), filters, nullptr, 0);
+			if (filename) {
+				m_hardware.Request(Hardware::Req::DEBUG_TRACE_CAPTURE_OPEN, { {"path", filename} });
+				m_captureRecords.clear();
+			}
+		}
+	}
+	else if (ImGui::Button("Stop Capture"))
+	{
+		m_hardware.Request(Hardware::Req::DEBUG_TRACE_CAPTURE_STOP);
+	}
+	ImGui::SameLine();
+	dev::DrawHelpMarker("The capture streams every executed instruction and the registers after it\n"
+						"to the file, delta encoded and compressed. It continues when the window is closed.\n"
+						"The emulation slows down if the disk can't keep up.\n"
+						"Find lists the executions of an address, or the instructions starting at\n"
+						"a cycle or a frame. The address is hexadecimal or a label,\n"
+						"the cycle and the frame are decimal. Next continues the search after the last result");
+
+	ImGui::Text("%s%s, instructions: %llu, file: %.1f MB, %.2f bytes per instruction",
+		m_captureStats.capturing ? "Capturing: " : "", m_capturePath.c_str(),
+		(unsigned long long)m_captureStats.records, m_captureStats.bytes / (1024.0 * 1024.0),
+		m_captureStats.records ? double(m_captureStats.bytes) / m_captureStats.records : 0.0);
+
+	ImGui::PushItemWidth(80);
+	ImGui::Combo("##TLCaptureFindBy", &m_captureFindBy, " Addr\0 Cycle\0 Frame\0\0");
+	ImGui::SameLine();
+	bool find = ImGui::InputTextWithHint("##TLCaptureFind", "0x100", m_captureFindS, IM_ARRAYSIZE(m_captureFindS),
+		ImGuiInputTextFlags_EnterReturnsTrue);
+	ImGui::PopItemWidth();
+	ImGui::SameLine();
+	find |= ImGui::Button("Find");
+	if (find) CaptureFind(false);
+	ImGui::SameLine();
+	bool finding = m_debugger.GetTraceCapture().IsFinding();
+	ImGui::BeginDisabled(m_captureRecords.empty() || finding);
+	if (ImGui::Button("Next")) CaptureFind(true);
+	ImGui::EndDisabled();
+	if (finding) {
+		ImGui::SameLine();
+		ImGui::Text("Searching...");
+	}
+
+	DrawCaptureRecords();
+}
+
+void dev::TraceLogWindow::CaptureFind(const bool _next)
+{
+	uint64_t val = 0;
+	if (m_captureFindBy != 0) {
+		val = std::strtoull(m_captureFindS, nullptr, 10);
+	}
+	else {
+		// a label or a hexadecimal addr
+		DebugData::FilteredElements labels;
+		m_debugger.GetDebugData().GetFilteredLabels(labels, m_captureFindS);
+		auto labelI = std::find_if(labels.begin(), labels.end(),
+			[&](const auto& _label) { return std::get<0>(_label) == m_captureFindS; });
+		val = labelI != labels.end() ? std::get<1>(*labelI) : std::strtoull(m_captureFindS, nullptr, 16);
+	}
+
+	uint64_t ccFrom = 0;
+	if (_next && !m_captureRecords.empty())
+	{
+		// the cycle and frame searches continue by the cycle
+		ccFrom = m_captureRecords.back().cc + 1;
+		if (m_captureFindBy != 0) {
+			m_captureFindBy = 1;
+			val = ccFrom;
+			snprintf(m_captureFindS, sizeof(m_captureFindS), "%llu", (unsigned long long)val);
+		}
+	}
+
+	// the query thread decodes the blocks, UpdateData picks up the records
+	m_debugger.GetTraceCapture().Find({ TraceCapture::Query::By(m_captureFindBy), val, ccFrom, CAPTURE_FIND_LEN });
+}
+
+void dev::TraceLogWindow::DrawCaptureRecords()
+{
+	const int COLUMNS_COUNT = 5;
+	static ImGuiTableFlags flags =
+		ImGuiTableFlags_ScrollY | ImGuiTableFlags_RowBg |
+		ImGuiTableFlags_Resizable | ImGuiTableFlags_BordersOuter;
+
+	if (ImGui::BeginTable("##TLCaptureRecords", COLUMNS_COUNT, flags, ImVec2(0, CAPTURE_TABLE_H * (*m_dpiScaleP))))
+	{
+		ImGui::TableSetupScrollFreeze(0, 1);
+		ImGui::TableSetupColumn("Cycle", ImGuiTableColumnFlags_WidthFixed, 90);
+		ImGui::TableSetupColumn("Frame", ImGuiTableColumnFlags_WidthFixed, 50);
+		ImGui::TableSetupColumn("Addr", ImGuiTableColumnFlags_WidthFixed, ADDR_W);
+		ImGui::TableSetupColumn("Command", ImGuiTableColumnFlags_WidthFixed, CODE_W);
+		ImGui::TableSetupColumn("PSW  BC   DE   HL   SP");
+		ImGui::TableHeadersRow();
+
+		Disasm::Line line;
+		ImGuiListClipper clipper;
+		clipper.Begin(int(m_captureRecords.size()));
+		while (clipper.Step())
+		{
+			for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++)
+			{
+				const auto& record = m_captureRecords[i];
+				ImGui::TableNextRow();
+
+				ImGui::TableNextColumn();
+				ImGui::Text("%llu", (unsigned long long)record.cc);
+				ImGui::TableNextColumn();
+				ImGui::Text("%llu", (unsigned long long)record.frameNum);
+
+				ImGui::TableNextColumn();
+				ImGui::Selectable(std::format("0x{:04X}##TLCaptureAddr{}", record.globalAddr, i).c_str(), false,
+					ImGuiSelectableFlags_AllowDoubleClick);
+				if (record.globalAddr < Memory::MEM_64K &&
+					ImGui::IsItemHovered() && ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left))
+				{
+					m_reqUI.type = ReqUI::Type::DISASM_NAVIGATE_TO_ADDR;
+					m_reqUI.globalAddr = record.globalAddr;
+				}
+
+				ImGui::TableNextColumn();
+				TraceLog::Item item{ static_cast<int32_t>(record.globalAddr), record.opcode, record.imm };
+				m_debugger.GetTraceLog().AddCode(item, line);
+				dev::DrawCodeLine(false, line, false);
+
+				ImGui::TableNextColumn();
+				ImGui::Text("%04X %04X %04X %04X %04X", record.psw, record.bc, record.de, record.hl, record.sp);
+			}
+		}
+		ImGui::EndTable();
+	}
+}
+
+void dev::TraceLogWindow::DrawBranches(const bool _isRunning)
+{
+	if (!ImGui::CollapsingHeader("Branches")) return;
+	if (_isRunning)
+	{
+		ImGui::Text("Stop the emulation to see the last branches");
+		return;
+	}
+
+	const int COLUMNS_COUNT = 5;
+	static ImGuiTableFlags flags =
+		ImGuiTableFlags_ScrollY | ImGuiTableFlags_RowBg |
+		ImGuiTableFlags_Resizable | ImGuiTableFlags_BordersOuter;
+
+	if (ImGui::BeginTable("##TLBranches", COLUMNS_COUNT, flags, ImVec2(0, CAPTURE_TABLE_H * (*m_dpiScaleP))))
+	{
+		ImGui::TableSetupScrollFreeze(0, 1);
+		ImGui::TableSetupColumn("Cycle", ImGuiTableColumnFlags_WidthFixed, 90);
+		ImGui::TableSetupColumn("From", ImGuiTableColumnFlags_WidthFixed, ADDR_W);
+		ImGui::TableSetupColumn("To", ImGuiTableColumnFlags_WidthFixed, ADDR_W);
+		ImGui::TableSetupColumn("Command", ImGuiTableColumnFlags_WidthFixed, 70);
+		ImGui::TableSetupColumn("Repeats");
+		ImGui::TableHeadersRow();
+
+		// the latest first
+		ImGuiListClipper clipper;
+		clipper.Begin(int(m_branches.size()));
+		while (clipper.Step())
+		{
+			for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++)
+			{
+				const auto& branch = m_branches[m_branches.size() - 1 - i];
+				ImGui::TableNextRow();
+
+				ImGui::TableNextColumn();
+				ImGui::Text("%llu", (unsigned long long)branch.cc);
+
+				for (Addr addr : { branch.from, branch.to })
+				{
+					ImGui::TableNextColumn();
+					ImGui::Selectable(std::format("0x{:04X}##TLBranchAddr{}_{}", addr, i, ImGui::TableGetColumnIndex()).c_str(),
+						false, ImGuiSelectableFlags_AllowDoubleClick);
+					if (ImGui::IsItemHovered() && ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left))
+					{
+						m_reqUI.type = ReqUI::Type::DISASM_NAVIGATE_TO_ADDR;
+						m_reqUI.globalAddr = addr;
+					}
+				}
+
+				ImGui::TableNextColumn();
+				ImGui::Text("%s", branch.irq ? "interrupt" : dev::GetMnemonic(branch.opcode)[0]);
+				ImGui::TableNextColumn();
+				if (branch.repeats > 1) ImGui::Text("%u", branch.repeats);
+			}
+		}
+		ImGui::EndTable();
+	}
+}
+
 const char* filterNames[] = { "c*", "+ call", "+ j*", "+ jmp", "+ r*", "+ ret", "+ pchl", "+ rst", "all" };
 
 void dev::TraceLogWindow::DrawLog(const bool _isRunning)
@@ -177,7 +415,7 @@ void dev::TraceLogWindow::DrawLog(const bool _isRunning)
 		}
 		ImGui::EndTable();
 	}
-	Addr regPC = m_hardware.Request(Hardware::Req::GET_REG_PC)->at("pc");
+	Addr regPC = m_hardware.GetSnapshot().cpuState.regs.pc.word;
 	DrawContextMenu(regPC, m_contextMenu);
 
 	ImGui::PopStyleVar(2);
@@ -20,6 +20,8 @@ namespace dev
 		static constexpr float CODE_W = 200.0f;
 		
 		static constexpr int MAX_DISASM_LABELS = 4;
+		static constexpr size_t CAPTURE_FIND_LEN = 1000; // the records per query
+		static constexpr int CAPTURE_TABLE_H = 200;
 
 		struct ContextMenu {
 			enum class Status { NONE = 0, INIT_CONTEXT_MENU, INIT_COMMENT_EDIT, INIT_LABEL_EDIT, INIT_CONST_EDIT };
@@ -66,8 +68,21 @@ namespace dev
 		size_t m_disasmLinesLen = 0;
 		bool m_visible = false;
 
+		// the trace capture
+		TraceCapture::Stats m_captureStats;
+		std::string m_capturePath;
+		int m_captureFindBy = 0; // 0 - pc, 1 - cycle, 2 - frame
+		char m_captureFindS[64] = "";
+		std::vector<TraceCapture::Record> m_captureRecords;
+		// the last branches, updated on a stop
+		std::vector<BranchRing::Branch> m_branches;
+
 		void UpdateData(const bool _isRunning);
 		void DrawLog(const bool _isRunning);
+		void DrawCapture(const bool _isRunning);
+		void DrawCaptureRecords();
+		void CaptureFind(const bool _next);
+		void DrawBranches(const bool _isRunning);
 		void DrawContextMenu(const Addr _regPC, ContextMenu& _contextMenu);
 		void DrawDisasmCode(const bool _isRunning, const Disasm::Line& _line,
 			ReqUI& _reqUI, ContextMenu& _contextMenu, AddrHighlight& _addrHighlight);
@@ -78,5 +93,7 @@ namespace dev
 		TraceLogWindow(Hardware& _hardware, Debugger& _debugger,
 				const float* const _dpiScaleP, ReqUI& _reqUI);
 		void Update(bool& _visible, const bool _isRunning);
+		// the capture continues when the window is closed
+		bool IsCapturing() const { return m_captureStats.capturing; }
 	};
 };
\ No newline at end of file
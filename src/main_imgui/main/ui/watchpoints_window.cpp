@@ -57,7 +57,7 @@ void dev::WatchpointsWindow::DrawTable()
 	bool showItemContextMenu = false;
 	static int editedWatchpointId = -1;
 	static ReqPopup reqPopup = ReqPopup::NONE;
-	const int COLUMNS_COUNT = 5;
+	const int COLUMNS_COUNT = 6;
 
 	const char* tableName = "##Watchpoints";
 	ImGui::PushStyleVar(ImGuiStyleVar_CellPadding, { 5.0f, 0.0f });
@@ -73,6 +73,7 @@ void dev::WatchpointsWindow::DrawTable()
 		ImGui::TableSetupColumn("GlobalAddr", ImGuiTableColumnFlags_WidthFixed, 110);
 		ImGui::TableSetupColumn("Access", ImGuiTableColumnFlags_WidthFixed, 50);
 		ImGui::TableSetupColumn("Condition", ImGuiTableColumnFlags_WidthFixed, 110);
+		ImGui::TableSetupColumn("Hits", ImGuiTableColumnFlags_WidthFixed, 60);
 		ImGui::TableSetupColumn("Comment", ImGuiTableColumnFlags_WidthStretch);
 
 		ImGui::TableNextRow(ImGuiTableRowFlags_Headers);
@@ -110,8 +111,7 @@ void dev::WatchpointsWindow::DrawTable()
 			if (isActive != wp.data.active)
 			{
 				wp.data.active = isActive;
-				m_hardware.Request(Hardware::Req::DEBUG_WATCHPOINT_ADD,
-					{ {"data0", wp.data.data0}, {"data1", wp.data.data1}, {"comment", wp.comment} });
+				SetWatchpoint(wp);
 
 				m_reqUI.type = ReqUI::Type::HEX_HIGHLIGHT_ON;
 				m_reqUI.globalAddr = globalAddr;
@@ -148,9 +148,15 @@ void dev::WatchpointsWindow::DrawTable()
 				}
 			}
 			condS = std::format("{} l:{}", condS, wp.data.len);
+			auto triggerS = wp.trigger.GetS();
+			if (!triggerS.empty()) condS += " " + triggerS;
 			DrawProperty(condS);
 			CheckIfItemClicked(rowMin, showItemContextMenu, id, editedWatchpointId, reqPopup);
 
+			// Hits
+			DrawProperty(std::to_string(wp.trigger.hits));
+			CheckIfItemClicked(rowMin, showItemContextMenu, id, editedWatchpointId, reqPopup);
+
 
 			// Comment
 			DrawProperty(wp.GetComment());
@@ -184,8 +190,7 @@ void dev::WatchpointsWindow::DrawTable()
 				for (auto& [id, wp] : m_watchpoints) 
 				{
 					wp.data.active = false;
-					m_hardware.Request(Hardware::Req::DEBUG_WATCHPOINT_ADD,
-						{ {"data0", wp.data.data0}, {"data1", wp.data.data1}, {"comment", wp.comment} });
+					SetWatchpoint(wp);
 				}
 			}
 			else if (ImGui::MenuItem("Delete All")) {
@@ -206,8 +211,7 @@ void dev::WatchpointsWindow::DrawTable()
 				if (ImGui::MenuItem(wp.data.active ? "Disable" : "Enable"))
 				{
 					wp.data.active = !wp.data.active;
-					m_hardware.Request(Hardware::Req::DEBUG_WATCHPOINT_ADD,
-						{ {"data0", wp.data.data0}, {"data1", wp.data.data1}, {"comment", wp.comment} });
+					SetWatchpoint(wp);
 
 					m_reqUI.type = ReqUI::Type::HEX_HIGHLIGHT_ON;
 					m_reqUI.globalAddr = wp.data.globalAddr;
@@ -250,12 +254,18 @@ void dev::WatchpointsWindow::DrawPopup(ReqPopup& _reqPopup, const Watchpoints::W
 	static int type = static_cast<int>(Watchpoint::Type::LEN);
 	static int len = 1;
 	static std::string comment = "";
+	static std::string expr = "";
+	static int ignoreCount = 0;
+	static int action = 0;
 	static ImVec2 buttonSize = { 65.0f, 25.0f };
 
 	// Init for a new WP
 	if (_reqPopup == ReqPopup::INIT_ADD) {
 		_reqPopup = ReqPopup::ADD;
 		comment = "";
+		expr = "";
+		ignoreCount = 0;
+		action = 0;
 		globalAddr = 0xFF;
 		len = 1;
 	}
@@ -275,6 +285,9 @@ void dev::WatchpointsWindow::DrawPopup(ReqPopup& _reqPopup, const Watchpoints::W
 		val = wp.data.value;
 		len = wp.data.len;
 		comment = wp.GetComment();
+		expr = wp.trigger.expr.GetExpr();
+		ignoreCount = wp.trigger.ignoreCount;
+		action = static_cast<int>(wp.trigger.action);
 	}
 
 	if (ImGui::BeginPopup("##WpEdit"))
@@ -327,6 +340,23 @@ void dev::WatchpointsWindow::DrawPopup(ReqPopup& _reqPopup, const Watchpoints::W
 				ImGuiInputTextFlags_CharsHexadecimal | ImGuiInputTextFlags_AutoSelectAll);
 			if (type == static_cast<int>(Watchpoint::Type::WORD)) ImGui::EndDisabled();
 
+			// Expression
+			DrawProperty2EditableS("Expression", "##WpContextExpr", &expr, "HL==0x8000 && frame%2==0",
+				"An extra condition checked after the access, empty means always true.\n"\
+				"It uses the same operands and operators as the breakpoint expression",
+				0);
+
+			// Ignore
+			DrawProperty2EditableI("Ignore", "##WpContextIgnore", &ignoreCount,
+				"The number of the first hits that don't break",
+				ImGuiInputTextFlags_CharsDecimal | ImGuiInputTextFlags_AutoSelectAll);
+
+			// Action
+			DrawProperty2Combo("Action", "##WpContextAction", &action,
+				dev::triggerActionsS, IM_ARRAYSIZE(dev::triggerActionsS),
+				"Break - halts the execution\n"\
+				"Log - prints the registers to the log and continues");
+
 			// Comment
 			DrawProperty2EditableS("Comment", "##WpContextComment", &comment, "");
 
@@ -346,6 +376,13 @@ void dev::WatchpointsWindow::DrawPopup(ReqPopup& _reqPopup, const Watchpoints::W
 			if (val > 0xFFFF || (type != static_cast<int>(Watchpoint::Type::WORD) && val > 0xFF)) {
 				warningS = "Too large value";
 			}
+			if (ignoreCount < 0) {
+				warningS = "A negative ignore count";
+			}
+			ConditionExpr exprCheck;
+			if (!exprCheck.Compile(expr)) {
+				warningS = exprCheck.GetError();
+			}
 			
 			ImGui::TextColored(DASM_CLR_WARNING, warningS.c_str());
 
@@ -365,7 +402,8 @@ void dev::WatchpointsWindow::DrawPopup(ReqPopup& _reqPopup, const Watchpoints::W
 					(GlobalAddr)len, isActive };
 
 				m_hardware.Request(Hardware::Req::DEBUG_WATCHPOINT_ADD,
-					{ {"data0", wpData.data0}, {"data1", wpData.data1}, {"comment", comment} });
+					{ {"data0", wpData.data0}, {"data1", wpData.data1}, {"comment", comment},
+					{"expr", expr}, {"ignore", ignoreCount}, {"action", action} });
 
 				m_reqUI.type = ReqUI::Type::HEX_HIGHLIGHT_ON;
 				m_reqUI.globalAddr = globalAddr;
@@ -401,10 +439,18 @@ void dev::WatchpointsWindow::UpdateWatchpoints()
 		{
 			Watchpoint::Data wpData{ watchpointJ["data0"], watchpointJ["data1"] };
 
-			Watchpoint wp{ std::move(wpData), watchpointJ["comment"] };
+			Watchpoint wp{ std::move(wpData), watchpointJ["comment"], Trigger{ watchpointJ } };
 			auto id = wp.data.id;
 			m_watchpoints.emplace(id, std::move(wp));
 		}
 	}
 
+}
+
+void dev::WatchpointsWindow::SetWatchpoint(const Watchpoint& _wp)
+{
+	m_hardware.Request(Hardware::Req::DEBUG_WATCHPOINT_ADD, {
+		{"data0", _wp.data.data0}, {"data1", _wp.data.data1}, {"comment", _wp.comment},
+		{"expr", _wp.trigger.expr.GetExpr()}, {"ignore", _wp.trigger.ignoreCount},
+		{"action", static_cast<uint32_t>(_wp.trigger.action)}, {"hits", _wp.trigger.hits} });
 }
\ No newline at end of file
@@ -23,6 +23,8 @@ namespace dev
 		void CheckIfItemClicked(const ImVec2& _rowMin, bool& _showItemContextMenu,
 			const int _id, int& _editedWatchpointId, ReqPopup& _reqPopup);
 		void UpdateWatchpoints();
+		// sends the changed watchpoint to the hardware keeping its trigger and hits
+		void SetWatchpoint(const Watchpoint& _wp);
 
 	public:
 		WatchpointsWindow(Hardware& _hardware,
@@ -11,7 +11,9 @@ dev::HAL::HAL(System::String^ _pathBootData, System::String^ _pathRamDiskData,
 	auto pathBootData = msclr::interop::marshal_as<std::wstring>(_pathBootData);
 	auto pathRamDiskData = msclr::interop::marshal_as<std::wstring>(_pathRamDiskData);
 
+	m_audioSinkP = new SdlAudioSink();
 	m_hardwareP = new Hardware(pathBootData, pathRamDiskData, _ramDiskClearAfterRestart);
+	m_hardwareP->AttachAudioSink(m_audioSinkP);
 	m_debuggerP = new Debugger(*m_hardwareP);
 	m_winGlUtilsP = new WinGlUtils();
 }
@@ -34,6 +36,7 @@ dev::HAL::!HAL()
 {
 	delete m_debuggerP; m_debuggerP = nullptr;
 	delete m_hardwareP; m_hardwareP = nullptr;
+	delete m_audioSinkP; m_audioSinkP = nullptr;
 	delete m_winGlUtilsP; m_winGlUtilsP = nullptr;
 }
 
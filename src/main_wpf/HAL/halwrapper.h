@@ -13,6 +13,7 @@
 
 #include "core/hardware.h"
 #include "core/debugger.h"
+#include "core/audio_sdl.h"
 
 #include "win_gl_utils.h"
 
@@ -23,6 +24,7 @@ namespace dev
     {
         Hardware* m_hardwareP;
         Debugger* m_debuggerP;
+        SdlAudioSink* m_audioSinkP; // has to outlive the Hardware
         WinGlUtils* m_winGlUtilsP;
 
     public:
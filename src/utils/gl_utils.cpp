@@ -227,6 +227,34 @@ void dev::GLUtils::UpdateTexture(const Id _texureId, const uint8_t* _memP)
 	glTexImage2D(GL_TEXTURE_2D, 0, texture.internalFormat, texture.w, texture.h, 0, texture.internalFormat, texture.type, _memP);
 }
 
+void dev::GLUtils::UpdateTextureRows(const Id _texureId, const uint8_t* _memP, const GLint _y, const GLsizei _h)
+{
+	if (_texureId == INVALID_ID) return;
+
+	auto it = m_textures.find(_texureId);
+	if (it == m_textures.end()) return;
+
+	auto& texture = it->second;
+	if (_y < 0 || _h <= 0 || _y + _h > texture.h) return;
+
+	int pixelSize = 1;
+	switch (texture.format)
+	{
+	case Texture::Format::RGB: pixelSize = 3; break;
+	case Texture::Format::RGBA: pixelSize = 4; break;
+	case Texture::Format::R8: pixelSize = 1; break;
+	case Texture::Format::R32: pixelSize = 4; break;
+	}
+
+	glBindTexture(GL_TEXTURE_2D, texture.id);
+
+#if defined(GL_UNPACK_ROW_LENGTH) && !defined(__EMSCRIPTEN__)
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+#endif
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, _y, texture.w, _h, texture.internalFormat, texture.type,
+		_memP + size_t(_y) * texture.w * pixelSize);
+}
+
 auto dev::GLUtils::GetFramebufferTexture(const Id _materialId) const
 -> Id
 {
@@ -103,6 +103,9 @@ namespace dev
 			-> ErrCode;
 		
 		void UpdateTexture(const Id _texureId, const uint8_t* _memP);
+		// uploads only the rows [_y, _y + _h). _memP points to the whole texture data.
+		// The texture has to be uploaded entirely once before
+		void UpdateTextureRows(const Id _texureId, const uint8_t* _memP, const GLint _y, const GLsizei _h);
 		auto GetFramebufferTexture(const Id _materialId) const -> Id;
 		auto GetMaterial(const Id _matId) -> Material*;
 		auto GetVtxArrayObj() const -> Id { return vtxArrayObj; };
@@ -0,0 +1,138 @@
+#include <cstring>
+#include <algorithm>
+
+#include "utils/lz.h"
+
+static constexpr size_t MIN_MATCH = 4;
+static constexpr size_t MAX_OFFSET = 0xFFFF;
+static constexpr int HASH_BITS = 14;
+static constexpr size_t LEN_MASK = 15; // the token nibble, the extra len bytes follow if it's full
+
+static inline auto Read32(const uint8_t* _p)
+-> uint32_t
+{
+	uint32_t val;
+	memcpy(&val, _p, sizeof(val));
+	return val;
+}
+
+static inline auto Hash(const uint32_t _val)
+-> uint32_t
+{
+	return (_val * 2654435761u) >> (32 - HASH_BITS);
+}
+
+static void WriteLen(std::vector<uint8_t>& _out, size_t _len)
+{
+	for (; _len >= 255; _len -= 255) _out.push_back(255);
+	_out.push_back(static_cast<uint8_t>(_len));
+}
+
+static bool ReadLen(const uint8_t* _srcP, const size_t _len, size_t& _idx, size_t& _outLen)
+{
+	uint8_t val;
+	do {
+		if (_idx >= _len) return false;
+		val = _srcP[_idx++];
+		_outLen += val;
+	} while (val == 255);
+	return true;
+}
+
+// _matchLen = 0 for the last sequence
+static void WriteSequence(std::vector<uint8_t>& _out, const uint8_t* _literalsP, const size_t _literalsLen,
+	const size_t _offset, const size_t _matchLen)
+{
+	size_t matchCode = _matchLen ? _matchLen - MIN_MATCH : 0;
+	_out.push_back(static_cast<uint8_t>(std::min(_literalsLen, LEN_MASK) << 4 | std::min(matchCode, LEN_MASK)));
+	if (_literalsLen >= LEN_MASK) WriteLen(_out, _literalsLen - LEN_MASK);
+	_out.insert(_out.end(), _literalsP, _literalsP + _literalsLen);
+
+	if (!_matchLen) return;
+
+	_out.push_back(static_cast<uint8_t>(_offset));
+	_out.push_back(static_cast<uint8_t>(_offset >> 8));
+	if (matchCode >= LEN_MASK) WriteLen(_out, matchCode - LEN_MASK);
+}
+
+void dev::LzCompress(const uint8_t* _srcP, const size_t _len, std::vector<uint8_t>& _out)
+{
+	std::vector<uint32_t> table(1 << HASH_BITS, 0); // the last position of a hashed 4-byte sequence
+	size_t idx = 0;
+	size_t anchor = 0; // the start of the pending literals
+
+	if (_len >= MIN_MATCH)
+	{
+		size_t limit = _len - MIN_MATCH;
+		while (idx <= limit)
+		{
+			uint32_t seq = Read32(_srcP + idx);
+			uint32_t& entry = table[Hash(seq)];
+			size_t ref = entry;
+			entry = static_cast<uint32_t>(idx);
+
+			if (ref >= idx || idx - ref > MAX_OFFSET || Read32(_srcP + ref) != seq) {
+				idx++;
+				continue;
+			}
+
+			size_t matchLen = MIN_MATCH;
+			while (idx + matchLen < _len && _srcP[ref + matchLen] == _srcP[idx + matchLen]) matchLen++;
+
+			WriteSequence(_out, _srcP + anchor, idx - anchor, idx - ref, matchLen);
+			idx += matchLen;
+			anchor = idx;
+		}
+	}
+
+	WriteSequence(_out, _srcP + anchor, _len - anchor, 0, 0);
+}
+
+bool dev::LzDecompress(const uint8_t* _srcP, const size_t _len, uint8_t* _dstP, const size_t _dstLen)
+{
+	size_t idx = 0;
+	size_t outIdx = 0;
+
+	while (idx < _len)
+	{
+		uint8_t token = _srcP[idx++];
+
+		size_t literalsLen = token >> 4;
+		if (literalsLen == LEN_MASK && !ReadLen(_srcP, _len, idx, literalsLen)) return false;
+		if (literalsLen > _len - idx || literalsLen > _dstLen - outIdx) return false;
+
+		memcpy(_dstP + outIdx, _srcP + idx, literalsLen);
+		idx += literalsLen;
+		outIdx += literalsLen;
+
+		if (idx == _len) break; // the last sequence
+
+		if (_len - idx < 2) return false;
+		size_t offset = _srcP[idx] | _srcP[idx + 1] << 8;
+		idx += 2;
+		if (offset == 0 || offset > outIdx) return false;
+
+		size_t matchLen = token & LEN_MASK;
+		if (matchLen == LEN_MASK && !ReadLen(_srcP, _len, idx, matchLen)) return false;
+		matchLen += MIN_MATCH;
+		if (matchLen > _dstLen - outIdx) return false;
+
+		uint8_t* matchP = _dstP + outIdx - offset;
+		if (offset >= matchLen) {
+			memcpy(_dstP + outIdx, matchP, matchLen);
+		}
+		else {
+			// overlapped, repeats the last offset bytes.
+			// the copied part is a whole number of the periods, so it doubles the chunk every step
+			for (size_t copied = 0; copied < matchLen;)
+			{
+				size_t chunk = std::min(copied + offset, matchLen - copied);
+				memcpy(_dstP + outIdx + copied, matchP, chunk);
+				copied += chunk;
+			}
+		}
+		outIdx += matchLen;
+	}
+
+	return outIdx == _dstLen;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dev
+{
+	// a fast byte-oriented LZ77 codec in the LZ4 block layout.
+	// a sequence is a token (literals len << 4 | match len - 4), the extra len bytes,
+	// the literals, and a 16-bit little-endian match offset. The last sequence has only the literals.
+	// It's tuned for the speed over the ratio: the memory dumps and the frame buffers are mostly runs
+
+	// appends the compressed _src to _out
+	void LzCompress(const uint8_t* _srcP, const size_t _len, std::vector<uint8_t>& _out);
+
+	// decompresses exactly _dstLen bytes. Returns false if the data is corrupted
+	bool LzDecompress(const uint8_t* _srcP, const size_t _len, uint8_t* _dstP, const size_t _dstLen);
+}
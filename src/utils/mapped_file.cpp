@@ -0,0 +1,154 @@
+#include "utils/mapped_file.h"
+#include "utils/utils.h"
+
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <unistd.h>
+#endif
+
+dev::MappedFile::~MappedFile()
+{
+	Close();
+}
+
+#ifdef _WIN32
+
+bool dev::MappedFile::Open(const std::string& _path)
+{
+	Close();
+	HANDLE file = ::CreateFileA(_path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr,
+		CREATE_ALWAYS, FILE_ATTRIBUTE_TEMPORARY, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		dev::Log("MappedFile: can't open {}", _path);
+		return false;
+	}
+	m_file = file;
+
+	if (!Map(CAPACITY_MIN))
+	{
+		Close();
+		return false;
+	}
+	return true;
+}
+
+bool dev::MappedFile::Map(const size_t _capacity)
+{
+	// the mapping object sets the file size
+	HANDLE mapping = ::CreateFileMappingA(m_file, nullptr, PAGE_READWRITE,
+		DWORD(uint64_t(_capacity) >> 32), DWORD(_capacity), nullptr);
+	if (!mapping) return false;
+
+	void* dataP = ::MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, _capacity);
+	if (!dataP)
+	{
+		::CloseHandle(mapping);
+		return false;
+	}
+
+	m_mapping = mapping;
+	m_dataP = static_cast<uint8_t*>(dataP);
+	m_capacity = _capacity;
+	return true;
+}
+
+void dev::MappedFile::Unmap()
+{
+	if (m_dataP) ::UnmapViewOfFile(m_dataP);
+	if (m_mapping) ::CloseHandle(m_mapping);
+	m_dataP = nullptr;
+	m_mapping = nullptr;
+}
+
+bool dev::MappedFile::Close(const size_t _len)
+{
+	Unmap();
+	m_capacity = 0;
+	if (!m_file) return true;
+
+	LARGE_INTEGER len;
+	len.QuadPart = _len;
+	bool truncated = ::SetFilePointerEx(m_file, len, nullptr, FILE_BEGIN) &&
+		::SetEndOfFile(m_file);
+	::CloseHandle(m_file);
+	m_file = nullptr;
+
+	if (!truncated) dev::Log("MappedFile: can't truncate the file to {} bytes", _len);
+	return truncated;
+}
+
+#else
+
+bool dev::MappedFile::Open(const std::string& _path)
+{
+	Close();
+	m_file = ::open(_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (m_file < 0)
+	{
+		dev::Log("MappedFile: can't open {}", _path);
+		return false;
+	}
+
+	if (!Map(CAPACITY_MIN))
+	{
+		Close();
+		return false;
+	}
+	return true;
+}
+
+bool dev::MappedFile::Map(const size_t _capacity)
+{
+	if (::ftruncate(m_file, _capacity) != 0) return false;
+
+	void* dataP = ::mmap(nullptr, _capacity, PROT_READ | PROT_WRITE, MAP_SHARED, m_file, 0);
+	if (dataP == MAP_FAILED) return false;
+
+	m_dataP = static_cast<uint8_t*>(dataP);
+	m_capacity = _capacity;
+	return true;
+}
+
+void dev::MappedFile::Unmap()
+{
+	if (m_dataP) ::munmap(m_dataP, m_capacity);
+	m_dataP = nullptr;
+}
+
+bool dev::MappedFile::Close(const size_t _len)
+{
+	Unmap();
+	m_capacity = 0;
+	if (m_file < 0) return true;
+
+	bool truncated = ::ftruncate(m_file, _len) == 0;
+	::close(m_file);
+	m_file = -1;
+
+	if (!truncated) dev::Log("MappedFile: can't truncate the file to {} bytes", _len);
+	return truncated;
+}
+
+#endif
+
+bool dev::MappedFile::Reserve(const size_t _len)
+{
+	if (!IsOpen()) return false;
+	if (_len <= m_capacity) return true;
+
+	size_t capacity = m_capacity;
+	while (capacity < _len) capacity *= 2;
+
+	size_t oldCapacity = m_capacity;
+	Unmap();
+	if (Map(capacity)) return true;
+
+	dev::Log("MappedFile: can't grow the file to {} bytes", capacity);
+	// the old size was mapped before, so it maps again
+	if (!Map(oldCapacity)) Close();
+	return false;
+}
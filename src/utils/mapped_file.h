@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace dev
+{
+	// a read-write file mapped into the memory. The OS pages its content in and out on demand,
+	// so a large file costs the address space, not the ram.
+	// Resizing remaps the file, the pointers to its data are invalidated
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+		~MappedFile();
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		// creates or truncates the file
+		bool Open(const std::string& _path);
+		// unmaps the file and truncates it to _len bytes. Returns false if the truncation fails
+		bool Close(const size_t _len = 0);
+		bool IsOpen() const { return m_dataP != nullptr; }
+		// grows the file to hold at least _len bytes. The capacity doubles to keep the remaps rare
+		bool Reserve(const size_t _len);
+		auto GetData() const -> uint8_t* { return m_dataP; }
+		auto GetCapacity() const -> size_t { return m_capacity; }
+
+	private:
+		bool Map(const size_t _capacity);
+		void Unmap();
+
+		static constexpr size_t CAPACITY_MIN = 64 * 1024 * 1024;
+
+		uint8_t* m_dataP = nullptr;
+		size_t m_capacity = 0;
+#ifdef _WIN32
+		void* m_file = nullptr;
+		void* m_mapping = nullptr;
+#else
+		int m_file = -1;
+#endif
+	};
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace dev {
+
+	// single writer, many readers sequence lock.
+	// the writer never waits, a reader retries if the writer updated the data while it was copying it.
+	// T has to be trivially copyable
+	template <typename T>
+	class SeqLock
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "SeqLock data has to be trivially copyable");
+
+		alignas(64) std::atomic_uint32_t m_seq = 0; // odd while the writer updates the data
+		T m_data;
+
+	public:
+		SeqLock() = default;
+		SeqLock(const SeqLock&) = delete;            // disable copying
+		SeqLock& operator=(const SeqLock&) = delete; // disable assignment
+
+		// writer thread
+		void store(const T& _data)
+		{
+			auto seq = m_seq.load(std::memory_order_relaxed);
+			m_seq.store(seq + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+
+			std::memcpy(&m_data, &_data, sizeof(T));
+
+			m_seq.store(seq + 2, std::memory_order_release);
+		}
+
+		// any thread
+		auto load() const -> T
+		{
+			T out;
+			uint32_t seqStart, seqEnd;
+			do {
+				seqStart = m_seq.load(std::memory_order_acquire);
+				std::memcpy(&out, &m_data, sizeof(T));
+				std::atomic_thread_fence(std::memory_order_acquire);
+				seqEnd = m_seq.load(std::memory_order_relaxed);
+			} while (seqStart != seqEnd || (seqStart & 1));
+
+			return out;
+		}
+
+		// any thread. changes every time the data is stored
+		inline auto version() const -> uint32_t { return m_seq.load(std::memory_order_acquire); }
+	};
+}
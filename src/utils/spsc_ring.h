@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace dev {
+
+	// lock-free single producer single consumer ring buffer.
+	// _capacity has to be a power of two
+	template <typename T, size_t _capacity>
+	class SpscRing
+	{
+		static_assert((_capacity & (_capacity - 1)) == 0, "SpscRing capacity has to be a power of two");
+		static constexpr size_t MASK = _capacity - 1;
+
+		std::array<T, _capacity> m_items;
+		alignas(64) std::atomic_size_t m_head = 0; // the next item to pop. written by the consumer
+		alignas(64) std::atomic_size_t m_tail = 0; // the next item to push. written by the producer
+
+	public:
+		SpscRing() = default;
+		SpscRing(const SpscRing&) = delete;            // disable copying
+		SpscRing& operator=(const SpscRing&) = delete; // disable assignment
+
+		// producer thread. returns false if the ring is full
+		bool push(T&& _item)
+		{
+			auto tail = m_tail.load(std::memory_order_relaxed);
+			if (tail - m_head.load(std::memory_order_acquire) == _capacity) return false;
+
+			m_items[tail & MASK] = std::move(_item);
+			m_tail.store(tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		// consumer thread. returns false if the ring is empty
+		bool pop(T& _item)
+		{
+			auto head = m_head.load(std::memory_order_relaxed);
+			if (head == m_tail.load(std::memory_order_acquire)) return false;
+
+			_item = std::move(m_items[head & MASK]);
+			m_head.store(head + 1, std::memory_order_release);
+			return true;
+		}
+
+		inline bool empty() const
+		{
+			return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+		}
+	};
+}
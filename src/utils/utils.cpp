@@ -172,8 +172,30 @@ auto dev::GetExecutableDir()
     ssize_t len = readlink("/proc/self/exe", buffer, sizeof(buffer)-1);
     if (len != -1) {
         buffer[len] = '\0';
-        path = dev::string(buffer);
+        path = buffer;
     }
 #endif
 	return dev::GetDir(path) + "/";
-}
\ No newline at end of file
+}
+
+void dev::WriteWavHeader(std::ostream& _stream, const uint64_t _samples, const int _rate)
+{
+	constexpr uint16_t channels = 1;
+	constexpr uint16_t bitsPerSample = 32;
+	constexpr uint16_t formatIeeeFloat = 3;
+	constexpr uint16_t blockAlign = channels * bitsPerSample / 8;
+	uint32_t byteRate = _rate * blockAlign;
+	uint32_t dataLen = static_cast<uint32_t>(_samples * blockAlign);
+	uint32_t riffLen = 36 + dataLen;
+
+	auto write = [&_stream](const auto _val) { _stream.write(reinterpret_cast<const char*>(&_val), sizeof(_val)); };
+
+	_stream.seekp(0);
+	_stream.write("RIFF", 4); write(riffLen);
+	_stream.write("WAVE", 4);
+	_stream.write("fmt ", 4); write(uint32_t(16));
+	write(formatIeeeFloat); write(channels); write(uint32_t(_rate));
+	write(byteRate); write(blockAlign); write(bitsPerSample);
+	_stream.write("data", 4); write(dataLen);
+	_stream.seekp(0, std::ios::end);
+}
@@ -63,7 +63,7 @@ constexpr bool is_defined<T, decltype(typeid(T), void())> = true;
 	//
 	//--------------------------------------------------------------
 
-	static std::mutex logMutex;
+	inline std::mutex logMutex; // shared by all translation units
 	// Local time
 	template <typename... Args>
 	constexpr void Log(const std::string& _fmt, Args&&... args)
@@ -158,6 +158,16 @@ constexpr bool is_defined<T, decltype(typeid(T), void())> = true;
 		return (a > 0) ? a : -a;
 	}
 
+	// FNV-1a. _hash continues the hash of the previous data
+	inline auto Hash64(const uint8_t* _data, const size_t _len, uint64_t _hash = 0xcbf29ce484222325ull)
+		-> uint64_t
+	{
+		for (size_t i = 0; i < _len; i++) {
+			_hash = (_hash ^ _data[i]) * 0x100000001b3ull;
+		}
+		return _hash;
+	}
+
 	//--------------------------------------------------------------
 	//
 	// FILES
@@ -193,4 +203,8 @@ constexpr bool is_defined<T, decltype(typeid(T), void())> = true;
 		-> std::tuple<std::string, std::string, std::string>;
 
 	auto GetExecutableDir() -> std::string;
+
+	// writes the header of a 32-bit float mono WAV file at the start of the stream
+	// and returns to its end
+	void WriteWavHeader(std::ostream& _stream, const uint64_t _samples, const int _rate);
 }
\ No newline at end of file
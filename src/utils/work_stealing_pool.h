@@ -0,0 +1,98 @@
+#pragma once
+
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dev {
+
+	// runs a fixed batch of jobs on a set of workers.
+	// every worker owns a deque, pops its jobs from the back and steals from the front of the others.
+	// the jobs are dealt round-robin before the start, new jobs can't be added while it runs
+	// the jobs must catch their exceptions, the one escaping a worker terminates the process
+	class WorkStealingPool
+	{
+	public:
+		using Job = std::function<void()>;
+
+	private:
+		struct Queue
+		{
+			std::mutex mutex;
+			std::deque<Job> jobs;
+		};
+
+		std::vector<Queue> m_queues;
+		size_t m_added = 0;
+
+		bool Pop(const size_t _workerIdx, Job& _job)
+		{
+			auto& queue = m_queues[_workerIdx];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (queue.jobs.empty()) return false;
+
+			_job = std::move(queue.jobs.back());
+			queue.jobs.pop_back();
+			return true;
+		}
+
+		bool Steal(const size_t _workerIdx, Job& _job)
+		{
+			for (size_t i = 1; i < m_queues.size(); i++)
+			{
+				auto& queue = m_queues[(_workerIdx + i) % m_queues.size()];
+				std::lock_guard<std::mutex> lock(queue.mutex);
+				if (queue.jobs.empty()) continue;
+
+				_job = std::move(queue.jobs.front());
+				queue.jobs.pop_front();
+				return true;
+			}
+			return false;
+		}
+
+		void Worker(const size_t _workerIdx)
+		{
+			Job job;
+			while (Pop(_workerIdx, job) || Steal(_workerIdx, job))
+			{
+				job();
+			}
+		}
+
+	public:
+		// 0 workers = the amount of the hardware threads
+		WorkStealingPool(size_t _workers = 0)
+			: m_queues(_workers ? _workers : std::max(1u, std::thread::hardware_concurrency()))
+		{}
+
+		WorkStealingPool(const WorkStealingPool&) = delete;            // disable copying
+		WorkStealingPool& operator=(const WorkStealingPool&) = delete; // disable assignment
+
+		inline auto GetWorkers() const -> size_t { return m_queues.size(); }
+
+		void Add(Job&& _job)
+		{
+			auto& queue = m_queues[m_added++ % m_queues.size()];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			queue.jobs.push_back(std::move(_job));
+		}
+
+		// blocks until all the jobs are done
+		void Run()
+		{
+			std::vector<std::thread> threads;
+			for (size_t i = 1; i < m_queues.size(); i++)
+			{
+				threads.emplace_back(&WorkStealingPool::Worker, this, i);
+			}
+			Worker(0);
+
+			for (auto& thread : threads) thread.join();
+			m_added = 0;
+		}
+	};
+}